@@ -1,8 +1,10 @@
 #include "main/model.h"
 #include "main/rayTracer.h"
 #include "main/resultsCalculation.h"
+#include "main/sceneCache.h"
 #include "main/sceneManager.h"
 #include "main/simulator.h"
+#include "main/traceRecorder.h"
 #include "obj/generators.h"
 
 #include <algorithm>
@@ -28,25 +30,40 @@ float kDefaultModelSize = 1.0;
 // ARGS MUST CONTAIN:
 // #1 raport path
 // #2 model path
+// ARGS MAY CONTAIN:
+// #3 scene cache folder, models are loaded through SceneCache when given
+// #4 timeline path, Chrome trace-event timeline of the run is saved there
 int main(int argc, char *argv[]) {
   std::vector<std::string> args(&argv[0], &argv[0 + argc]);
   std::string_view raportPath = args[1];
   std::string_view modelPath = args[2];
+  std::unique_ptr<timeline::TraceRecorder> traceRecorder;
+  if (args.size() > 4) {
+    traceRecorder = std::make_unique<timeline::TraceRecorder>();
+  }
 
   std::cout << "starting validation for: " << modelPath << std::endl;
-  std::unique_ptr<Model> model = Model::NewLoadFromObjectFile(modelPath);
+  std::unique_ptr<Model> model;
+  if (args.size() > 3) {
+    SceneCache sceneCache(args[3]);
+    model = sceneCache.loadModel(modelPath);
+  } else {
+    model = Model::NewLoadFromObjectFile(modelPath);
+  }
 
   trackers::FakePositionTracker positionTracker;
   trackers::FakeCollectorsTracker collectorsTracker;
 
   collectionRules::NonLinearEnergyCollection energyCollectionRules;
-  BasicSimulationProperties basicProperties(frequencies, sourcePower,
-                                            numOfCollectors, numOfRaysSquared);
+  // Rays are not tracked, so every ray can be traced once for all frequencies.
+  BasicSimulationProperties basicProperties(
+      frequencies, sourcePower, numOfCollectors, numOfRaysSquared,
+      /*maxTracking=*/12, /*numOfThreads=*/1, /*multiFrequencyTracing=*/true);
   SimulationProperties properties(&energyCollectionRules, basicProperties);
   SceneManager manager(model.get(), properties, &positionTracker,
                        &collectorsTracker);
 
-  std::unordered_map<float, Collectors> mapOfCollectors = manager.run();
+  EnergyTensor energies = manager.run();
 
   WaveObjectFactory waveFactory(kSampleRate);
 
@@ -61,7 +78,7 @@ int main(int argc, char *argv[]) {
 
   for (ResultInterface *result : acousticParameters) {
     std::map<float, float> resultPerFrequency =
-        result->getResults(mapOfCollectors);
+        result->getResults(energies);
     resultTracker.registerResult(result->getName(), resultPerFrequency);
   }
 
@@ -70,4 +87,7 @@ int main(int argc, char *argv[]) {
   // make another interface for it;
   // resultTracker.compareDataToReference();
   resultTracker.saveRaport(raportPath.data());
+  if (traceRecorder) {
+    traceRecorder->save(args[4]);
+  }
 }
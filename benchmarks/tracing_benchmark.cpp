@@ -0,0 +1,256 @@
+#include "core/constants.h"
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "main/boundingVolumeHierarchy.h"
+#include "main/collectorsIndex.h"
+#include "main/mappedFile.h"
+#include "main/model.h"
+#include "main/rayTracer.h"
+#include "main/resultsCalculation.h"
+#include "main/sceneManager.h"
+#include "main/simulator.h"
+#include "main/trackers.h"
+#include "obj/generators.h"
+#include "obj/objects.h"
+#include "obj/triangleMesh.h"
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+// Benchmarks of the hot paths of the simulation. Rays per second and ray-
+// triangle tests per ray are reported as counters, so results saved with
+// --benchmark_format=json can be compared between releases.
+// ARGS MAY CONTAIN (after benchmark flags):
+// #1 folder with .obj models traced by RayTrace/* and loaded by ObjLoading/*,
+//    validationDiffusors by default.
+
+using benchmark::Counter;
+using core::Ray;
+using core::RayHitData;
+using core::Vec3;
+
+namespace {
+
+const float kFrequency = 1000;
+const float kSourcePower = 500;
+const int kNumOfCollectors = 37;
+// Rays are reused in cycles, so memory of every benchmark stays the same for
+// any number of iterations.
+const int kNumOfRays = 4096;
+
+void setRaysPerSecond(benchmark::State &state, double raysPerIteration = 1) {
+  state.counters["rays/s"] =
+      Counter(state.iterations() * raysPerIteration, Counter::kIsRate);
+}
+
+// Rays that start on the sphere of |radius| around the origin and point
+// towards random points of the square with |size| on XY surface.
+std::vector<Ray> raysTowardsCenter(float radius, float size) {
+  std::mt19937 generator(/*seed=*/2137);
+  std::normal_distribution<float> normal;
+  std::uniform_real_distribution<float> target(-size, size);
+  std::vector<Ray> rays;
+  rays.reserve(kNumOfRays);
+  while (rays.size() < kNumOfRays) {
+    Vec3 origin =
+        Vec3(normal(generator), normal(generator), std::abs(normal(generator)))
+            .normalize() *
+        radius;
+    rays.push_back(
+        Ray(origin, Vec3(target(generator), target(generator), 0) - origin));
+  }
+  return rays;
+}
+
+void BM_TriangleHitObject(benchmark::State &state) {
+  objects::TriangleObj triangle(Vec3(-1, -1, 0), Vec3(1, -1, 0), Vec3(0, 1, 0));
+  std::vector<Ray> rays = raysTowardsCenter(/*radius=*/4, /*size=*/1.5);
+  RayHitData hitData;
+  size_t rayIndex = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        triangle.hitObject(rays[rayIndex++ % kNumOfRays], kFrequency, &hitData));
+  }
+  setRaysPerSecond(state);
+}
+BENCHMARK(BM_TriangleHitObject);
+
+void BM_SphereHitObject(benchmark::State &state) {
+  objects::Sphere sphere(Vec3(0, 0, 0.5), /*rad=*/0.5);
+  std::vector<Ray> rays = raysTowardsCenter(/*radius=*/4, /*size=*/1);
+  RayHitData hitData;
+  size_t rayIndex = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        sphere.hitObject(rays[rayIndex++ % kNumOfRays], kFrequency, &hitData));
+  }
+  setRaysPerSecond(state);
+}
+BENCHMARK(BM_SphereHitObject);
+
+// Traces rays of the point speaker used in the simulation against the model
+// at |objPath|.
+void BM_RayTrace(benchmark::State &state, const std::string &objPath) {
+  std::unique_ptr<Model> model = Model::NewLoadFromObjectFile(objPath);
+  RayTracer rayTracer(model.get());
+  generators::PointSpeakerRayFactory rayFactory(
+      /*numOfRaysAlongEachAxis=*/64, kSourcePower, model.get());
+
+  RayHitData hitData;
+  int rayIndex = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rayTracer.rayTrace(
+        rayFactory.getRay(rayIndex++ % rayFactory.numOfRays()), kFrequency,
+        &hitData));
+  }
+  setRaysPerSecond(state);
+
+  // Hierarchy is built the same way as in RayTracer, so it makes the same
+  // tests. They are counted outside of the measured loop.
+  BoundingVolumeHierarchy hierarchy(
+      std::make_shared<objects::TriangleMesh>(model->triangles()));
+  int numOfTriangleTests = 0;
+  for (rayIndex = 0; rayIndex < rayFactory.numOfRays(); ++rayIndex) {
+    RayHitData countedHitData;
+    benchmark::DoNotOptimize(hierarchy.closestHit(rayFactory.getRay(rayIndex),
+                                                  kFrequency, &countedHitData,
+                                                  &numOfTriangleTests));
+  }
+  state.counters["triangleTests/ray"] =
+      static_cast<double>(numOfTriangleTests) / rayFactory.numOfRays();
+  state.counters["triangles"] = model->triangles().size();
+}
+
+// Loads the model from the .obj file content already read into memory, so
+// only parsing and triangle creation are measured.
+void BM_ObjLoading(benchmark::State &state, const std::string &objPath) {
+  MappedFile objFile(objPath);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        Model::NewFromObjFileContent(objFile.content(), state.range(0)));
+  }
+  state.SetBytesProcessed(state.iterations() * objFile.size());
+}
+
+template <typename Rule> void BM_CollectEnergy(benchmark::State &state) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1.0);
+  Collectors collectors = buildCollectors(model.get(), kNumOfCollectors);
+  CollectorsIndex collectorsIndex(collectors);
+  Rule rule;
+
+  // Rays go from the model to the sphere on which collectors are placed,
+  // where most of them reach some collector.
+  float radius = getSphereWallRadius(*model);
+  std::vector<RayHitData> hits;
+  for (const Ray &ray : raysTowardsCenter(radius, /*size=*/1)) {
+    hits.push_back(RayHitData(
+        /*t=*/radius, -ray.direction(),
+        Ray(Vec3::kZero, ray.origin(), /*energy=*/1), kFrequency,
+        /*accumulatedTime=*/radius / constants::kSoundSpeed));
+  }
+
+  size_t hitIndex = 0;
+  for (auto _ : state) {
+    RayHitData hitData = hits[hitIndex++ % kNumOfRays];
+    rule.collectEnergy(collectors, collectorsIndex, &hitData);
+  }
+  setRaysPerSecond(state);
+}
+BENCHMARK_TEMPLATE(BM_CollectEnergy, collectionRules::LinearEnergyCollection);
+BENCHMARK_TEMPLATE(BM_CollectEnergy,
+                   collectionRules::LinearEnergyCollectionWithPhaseImpact);
+BENCHMARK_TEMPLATE(BM_CollectEnergy, collectionRules::NonLinearEnergyCollection);
+
+void BM_WaveObjectTotalPressure(benchmark::State &state) {
+  std::mt19937 generator(/*seed=*/2137);
+  std::exponential_distribution<float> energy;
+  std::vector<float> data(state.range(0));
+  std::generate(data.begin(), data.end(), [&] { return energy(generator); });
+  WaveObject wave(objects::kDefaultSampleRate, data);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(wave.getTotalPressure());
+  }
+  state.SetItemsProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_WaveObjectTotalPressure)->Arg(objects::kDefaultSampleRate);
+
+// Sound pressure levels of every collector at every frequency, as computed
+// for the diffusion coefficient, with number of bins given as the argument.
+void BM_SoundPressureLevels(benchmark::State &state) {
+  std::mt19937 generator(/*seed=*/2137);
+  std::exponential_distribution<float> energy;
+  const std::vector<float> frequencies = {500, 1000, 2000, 4000};
+  EnergyTensor energies(frequencies, kNumOfCollectors, state.range(0),
+                        objects::kDefaultSampleRate);
+  for (size_t frequency = 0; frequency < frequencies.size(); ++frequency) {
+    for (int collector = 0; collector < kNumOfCollectors; ++collector) {
+      for (int64_t bin = 0; bin < state.range(0); ++bin) {
+        energies.at(frequency, collector, bin) = energy(generator);
+      }
+    }
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(calculateSoundPressureLevels(energies));
+  }
+  state.SetItemsProcessed(state.iterations() * frequencies.size() *
+                          kNumOfCollectors * state.range(0));
+}
+BENCHMARK(BM_SoundPressureLevels)->Arg(objects::kDefaultSampleRate / 10);
+
+// Whole simulation of the reference model, as run by validation, with
+// |numOfRaysSquared| given as the benchmark argument.
+void BM_SceneManagerRun(benchmark::State &state) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1.0);
+  trackers::FakePositionTracker positionTracker;
+  trackers::FakeCollectorsTracker collectorsTracker;
+  collectionRules::NonLinearEnergyCollection energyCollectionRules;
+  const int numOfRaysSquared = state.range(0);
+  BasicSimulationProperties basicProperties(
+      {500, 1000, 2000, 4000}, kSourcePower, kNumOfCollectors,
+      numOfRaysSquared, /*maxTracking=*/12, /*numOfThreads=*/1,
+      /*multiFrequencyTracing=*/true);
+  SimulationProperties properties(&energyCollectionRules, basicProperties);
+
+  for (auto _ : state) {
+    SceneManager manager(model.get(), properties, &positionTracker,
+                         &collectorsTracker);
+    benchmark::DoNotOptimize(manager.run());
+  }
+  setRaysPerSecond(state, numOfRaysSquared * numOfRaysSquared);
+}
+BENCHMARK(BM_SceneManagerRun)->Arg(100)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  std::string modelsFolder = argc > 1 ? argv[1] : "validationDiffusors";
+
+  std::vector<std::filesystem::path> objPaths;
+  if (std::filesystem::is_directory(modelsFolder)) {
+    for (const auto &entry : std::filesystem::directory_iterator(modelsFolder)) {
+      if (entry.path().extension() == ".obj") {
+        objPaths.push_back(entry.path());
+      }
+    }
+  }
+  std::sort(objPaths.begin(), objPaths.end());
+  for (const std::filesystem::path &objPath : objPaths) {
+    benchmark::RegisterBenchmark(
+        ("BM_RayTrace/" + objPath.stem().string()).c_str(), BM_RayTrace,
+        objPath.string());
+    benchmark::RegisterBenchmark(
+        ("BM_ObjLoading/" + objPath.stem().string()).c_str(), BM_ObjLoading,
+        objPath.string())
+        ->Arg(1)
+        ->Arg(4);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
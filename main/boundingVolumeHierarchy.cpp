@@ -0,0 +1,390 @@
+#include "main/boundingVolumeHierarchy.h"
+
+#include "main/instrumentation.h"
+
+#include <sstream>
+#include <utility>
+
+namespace {
+// Number of buckets along each axis in which triangle centroids are binned
+// when searching for the cheapest split.
+const int kNumOfBins = 12;
+// Nodes with that many triangles or less are never split.
+const int kMinTrianglesToSplit = 4;
+// When Surface Area Heuristic says that splitting node is not worth it, node
+// is still split if it holds more triangles than that.
+const int kMaxTrianglesInLeaf = 16;
+// Cost of traversing one node relative to the cost of one triangle test.
+const float kTraversalCost = 1.0f;
+// Limits depth of the tree so traversal stack never overflows.
+const int kMaxDepth = 60;
+const int kStackSize = 2 * kMaxDepth;
+// Substitutes 1 / 0 for axis that ray direction is parallel to, which
+// prevents 0 * inf = NaN in slab test.
+const float kInfiniteInverse = 1e30f;
+
+float coordinate(const core::Vec3 &vec, int axis) {
+  return axis == 0 ? vec.x() : (axis == 1 ? vec.y() : vec.z());
+}
+
+} // namespace
+
+AxisAlignedBox::AxisAlignedBox() {
+  for (int axis = 0; axis < 3; ++axis) {
+    min[axis] = std::numeric_limits<float>::max();
+    max[axis] = std::numeric_limits<float>::lowest();
+  }
+}
+
+void AxisAlignedBox::grow(const core::Vec3 &point) {
+  for (int axis = 0; axis < 3; ++axis) {
+    min[axis] = std::min(min[axis], coordinate(point, axis));
+    max[axis] = std::max(max[axis], coordinate(point, axis));
+  }
+}
+
+void AxisAlignedBox::grow(const AxisAlignedBox &other) {
+  for (int axis = 0; axis < 3; ++axis) {
+    min[axis] = std::min(min[axis], other.min[axis]);
+    max[axis] = std::max(max[axis], other.max[axis]);
+  }
+}
+
+void AxisAlignedBox::pad(float margin) {
+  for (int axis = 0; axis < 3; ++axis) {
+    min[axis] -= margin;
+    max[axis] += margin;
+  }
+}
+
+bool AxisAlignedBox::empty() const { return min[0] > max[0]; }
+
+float AxisAlignedBox::surfaceArea() const {
+  if (empty()) {
+    return 0;
+  }
+  float dx = max[0] - min[0];
+  float dy = max[1] - min[1];
+  float dz = max[2] - min[2];
+  return 2 * (dx * dy + dy * dz + dz * dx);
+}
+
+core::Vec3 AxisAlignedBox::center() const {
+  return core::Vec3((min[0] + max[0]) / 2, (min[1] + max[1]) / 2,
+                    (min[2] + max[2]) / 2);
+}
+
+// Slab test: https://tavianator.com/2011/ray_box.html
+bool AxisAlignedBox::hitBox(const float origin[3],
+                            const float inverseDirection[3], float maxTime,
+                            float *entryTime) const {
+  float timeNear = std::numeric_limits<float>::lowest();
+  float timeFar = std::numeric_limits<float>::max();
+  for (int axis = 0; axis < 3; ++axis) {
+    float time0 = (min[axis] - origin[axis]) * inverseDirection[axis];
+    float time1 = (max[axis] - origin[axis]) * inverseDirection[axis];
+    timeNear = std::max(timeNear, std::min(time0, time1));
+    timeFar = std::min(timeFar, std::max(time0, time1));
+  }
+  *entryTime = timeNear;
+  return timeFar >= std::max(timeNear, 0.0f) && timeNear <= maxTime;
+}
+
+void AxisAlignedBox::printItself(std::ostream &os) const noexcept {
+  os << "Axis Aligned Box from: (" << min[0] << ", " << min[1] << ", "
+     << min[2] << ") to: (" << max[0] << ", " << max[1] << ", " << max[2]
+     << ")";
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(
+    std::shared_ptr<const objects::TriangleMesh> mesh)
+    : mesh_(std::move(mesh)) {
+
+  std::vector<AxisAlignedBox> triangleBounds;
+  std::vector<core::Vec3> centroids;
+  triangleBounds.reserve(mesh_->size());
+  centroids.reserve(mesh_->size());
+  triangleIndices_.reserve(mesh_->size());
+
+  for (size_t index = 0; index < mesh_->size(); ++index) {
+    AxisAlignedBox bounds;
+    bounds.grow(mesh_->point1(index));
+    bounds.grow(mesh_->point2(index));
+    bounds.grow(mesh_->point3(index));
+    // Hits slightly outside of the triangle are accepted by
+    // TriangleMesh::intersect(), so box has to cover them too.
+    bounds.pad(constants::kAccuracy +
+               objects::kBarycentricAccuracy * mesh_->longestEdge(index));
+    triangleBounds.push_back(bounds);
+    centroids.push_back(
+        (mesh_->point1(index) + mesh_->point2(index) + mesh_->point3(index)) /
+        3);
+    triangleIndices_.push_back(index);
+  }
+
+  // Binary tree has at most 2 * N - 1 nodes.
+  nodes_.reserve(std::max<size_t>(1, 2 * mesh_->size()));
+  nodes_.push_back(Node{AxisAlignedBox(), 0, 0});
+  buildNode(/*nodeIndex=*/0, /*begin=*/0, mesh_->size(), triangleBounds,
+            centroids, /*depth=*/0);
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(
+    std::shared_ptr<const objects::TriangleMesh> mesh, std::vector<Node> nodes,
+    std::vector<int> triangleIndices)
+    : nodes_(std::move(nodes)), triangleIndices_(std::move(triangleIndices)),
+      mesh_(std::move(mesh)) {
+  std::stringstream errorStream;
+  errorStream << "Error in: " << *this << "\n";
+
+  std::vector<int> sortedIndices = triangleIndices_;
+  std::sort(sortedIndices.begin(), sortedIndices.end());
+  for (size_t index = 0; index < sortedIndices.size(); ++index) {
+    if (sortedIndices[index] != static_cast<int>(index)) {
+      errorStream << "Triangle indices are not permutation of mesh triangles!";
+      throw std::invalid_argument(errorStream.str());
+    }
+  }
+  if (nodes_.empty() || sortedIndices.size() != mesh_->size()) {
+    errorStream << "Hierarchy doesn't match the mesh!";
+    throw std::invalid_argument(errorStream.str());
+  }
+
+  // Children are always stored after their parent, so walking from the root
+  // visits every node at most once and finds depth of the tree.
+  std::vector<std::pair<int, int>> nodesToCheck = {{0, 0}};
+  while (!nodesToCheck.empty()) {
+    auto [nodeIndex, depth] = nodesToCheck.back();
+    nodesToCheck.pop_back();
+    const Node &node = nodes_[nodeIndex];
+    bool valid = depth <= kMaxDepth && node.firstIndex >= 0;
+    if (valid && node.numOfTriangles > 0) {
+      valid = node.firstIndex + node.numOfTriangles <=
+              static_cast<int>(triangleIndices_.size());
+    } else if (valid) {
+      valid = node.numOfTriangles == 0 && node.firstIndex > nodeIndex &&
+              node.firstIndex + 1 < static_cast<int>(nodes_.size());
+      nodesToCheck.push_back({node.firstIndex, depth + 1});
+      nodesToCheck.push_back({node.firstIndex + 1, depth + 1});
+    }
+    if (!valid) {
+      errorStream << "Invalid node at index: " << nodeIndex;
+      throw std::invalid_argument(errorStream.str());
+    }
+  }
+}
+
+void BoundingVolumeHierarchy::buildNode(
+    int nodeIndex, int begin, int end,
+    const std::vector<AxisAlignedBox> &triangleBounds,
+    const std::vector<core::Vec3> &centroids, int depth) {
+
+  AxisAlignedBox bounds, centroidBounds;
+  for (int index = begin; index < end; ++index) {
+    bounds.grow(triangleBounds[triangleIndices_[index]]);
+    centroidBounds.grow(centroids[triangleIndices_[index]]);
+  }
+  nodes_[nodeIndex].bounds = bounds;
+  nodes_[nodeIndex].firstIndex = begin;
+  nodes_[nodeIndex].numOfTriangles = end - begin;
+
+  const int numOfTriangles = end - begin;
+  if (numOfTriangles <= kMinTrianglesToSplit || depth >= kMaxDepth) {
+    return;
+  }
+
+  // Binned SAH: centroids are binned along each axis and every border
+  // between bins is evaluated as a candidate split plane.
+  // https://www.sci.utah.edu/~wald/Publications/2007/ParallelBVHBuild/fastbuild.pdf
+  struct Bin {
+    AxisAlignedBox bounds;
+    int numOfTriangles = 0;
+  };
+
+  float bestCost = std::numeric_limits<float>::max();
+  int bestAxis = -1, bestSplit = -1;
+  for (int axis = 0; axis < 3; ++axis) {
+    float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+    if (extent <= 0) {
+      continue;
+    }
+    Bin bins[kNumOfBins];
+    for (int index = begin; index < end; ++index) {
+      int triangle = triangleIndices_[index];
+      int bin = std::min(
+          kNumOfBins - 1,
+          static_cast<int>((coordinate(centroids[triangle], axis) -
+                            centroidBounds.min[axis]) /
+                           extent * kNumOfBins));
+      bins[bin].bounds.grow(triangleBounds[triangle]);
+      ++bins[bin].numOfTriangles;
+    }
+
+    // Sweeps from the right to acquire costs of every right side first.
+    float rightCosts[kNumOfBins];
+    AxisAlignedBox rightBounds;
+    int rightCount = 0;
+    for (int bin = kNumOfBins - 1; bin > 0; --bin) {
+      rightBounds.grow(bins[bin].bounds);
+      rightCount += bins[bin].numOfTriangles;
+      rightCosts[bin] = rightCount * rightBounds.surfaceArea();
+    }
+
+    AxisAlignedBox leftBounds;
+    int leftCount = 0;
+    for (int split = 1; split < kNumOfBins; ++split) {
+      leftBounds.grow(bins[split - 1].bounds);
+      leftCount += bins[split - 1].numOfTriangles;
+      if (leftCount == 0 || leftCount == numOfTriangles) {
+        continue;
+      }
+      float cost = leftCount * leftBounds.surfaceArea() + rightCosts[split];
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestAxis = axis;
+        bestSplit = split;
+      }
+    }
+  }
+
+  // Every centroid is at the same position, so there is no way to split them.
+  if (bestAxis == -1) {
+    return;
+  }
+
+  float splitCost = kTraversalCost + bestCost / bounds.surfaceArea();
+  if (splitCost >= numOfTriangles && numOfTriangles <= kMaxTrianglesInLeaf) {
+    return;
+  }
+
+  const float axisMin = centroidBounds.min[bestAxis];
+  const float extent = centroidBounds.max[bestAxis] - axisMin;
+  auto middle = std::partition(
+      triangleIndices_.begin() + begin, triangleIndices_.begin() + end,
+      [&](int triangle) {
+        int bin = std::min(
+            kNumOfBins - 1,
+            static_cast<int>((coordinate(centroids[triangle], bestAxis) -
+                              axisMin) /
+                             extent * kNumOfBins));
+        return bin < bestSplit;
+      });
+  int middleIndex = middle - triangleIndices_.begin();
+
+  int leftChild = nodes_.size();
+  nodes_.push_back(Node{AxisAlignedBox(), 0, 0});
+  nodes_.push_back(Node{AxisAlignedBox(), 0, 0});
+  nodes_[nodeIndex].firstIndex = leftChild;
+  nodes_[nodeIndex].numOfTriangles = 0;
+
+  buildNode(leftChild, begin, middleIndex, triangleBounds, centroids,
+            depth + 1);
+  buildNode(leftChild + 1, middleIndex, end, triangleBounds, centroids,
+            depth + 1);
+}
+
+bool BoundingVolumeHierarchy::closestHit(const core::Ray &ray,
+                                         float frequency,
+                                         core::RayHitData *hitData,
+                                         int *numOfTriangleTests) const {
+  if (mesh_->empty()) {
+    return false;
+  }
+
+  const float origin[3] = {ray.origin().x(), ray.origin().y(),
+                           ray.origin().z()};
+  const float direction[3] = {ray.direction().x(), ray.direction().y(),
+                              ray.direction().z()};
+  float inverseDirection[3];
+  for (int axis = 0; axis < 3; ++axis) {
+    inverseDirection[axis] =
+        direction[axis] != 0
+            ? 1.0f / direction[axis]
+            : std::copysign(kInfiniteInverse, direction[axis]);
+  }
+
+  int closestTriangle = -1;
+  float closestTime = std::numeric_limits<float>::max();
+  int numOfTests = 0;
+
+  // Nodes waiting for traversal along with the time at which ray enters them.
+  int stack[kStackSize];
+  float stackEntryTimes[kStackSize];
+  int stackSize = 0;
+
+  float rootEntry;
+  if (nodes_[0].bounds.hitBox(origin, inverseDirection, closestTime,
+                              &rootEntry)) {
+    stack[stackSize] = 0;
+    stackEntryTimes[stackSize++] = rootEntry;
+  }
+
+  while (stackSize > 0) {
+    --stackSize;
+    // Closer hit could be found since node was pushed on the stack.
+    if (stackEntryTimes[stackSize] > closestTime) {
+      continue;
+    }
+    const Node &node = nodes_[stack[stackSize]];
+
+    if (node.numOfTriangles > 0) {
+      numOfTests += node.numOfTriangles;
+      for (int index = node.firstIndex;
+           index < node.firstIndex + node.numOfTriangles; ++index) {
+        int triangle = triangleIndices_[index];
+        float time;
+        if (!mesh_->intersect(triangle, origin, direction, &time)) {
+          continue;
+        }
+        if (time < closestTime ||
+            (time == closestTime && triangle < closestTriangle)) {
+          closestTime = time;
+          closestTriangle = triangle;
+        }
+      }
+      continue;
+    }
+
+    // Closer child is pushed last, so it is visited first and farther one
+    // can be skipped when closer hit is found.
+    int nearChild = node.firstIndex, farChild = node.firstIndex + 1;
+    float nearEntry, farEntry;
+    bool hitNear = nodes_[nearChild].bounds.hitBox(
+        origin, inverseDirection, closestTime, &nearEntry);
+    bool hitFar = nodes_[farChild].bounds.hitBox(
+        origin, inverseDirection, closestTime, &farEntry);
+    if (hitNear && hitFar && farEntry < nearEntry) {
+      std::swap(nearChild, farChild);
+      std::swap(nearEntry, farEntry);
+    } else if (!hitNear) {
+      std::swap(nearChild, farChild);
+      std::swap(nearEntry, farEntry);
+      std::swap(hitNear, hitFar);
+    }
+    if (hitFar) {
+      stack[stackSize] = farChild;
+      stackEntryTimes[stackSize++] = farEntry;
+    }
+    if (hitNear) {
+      stack[stackSize] = nearChild;
+      stackEntryTimes[stackSize++] = nearEntry;
+    }
+  }
+
+  INSTRUMENT_COUNT(TRIANGLE_TESTS, numOfTests);
+  if (numOfTriangleTests != nullptr) {
+    *numOfTriangleTests += numOfTests;
+  }
+  if (closestTriangle == -1) {
+    return false;
+  }
+  *hitData = core::RayHitData(closestTime, mesh_->normal(closestTriangle), ray,
+                              frequency);
+  return true;
+}
+
+void BoundingVolumeHierarchy::printItself(std::ostream &os) const noexcept {
+  os << "Bounding Volume Hierarchy\n"
+     << "Triangles: " << mesh_->size() << "\n"
+     << "Nodes: " << nodes_.size();
+}
@@ -0,0 +1,95 @@
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include "core/classUtlilities.h"
+#include "core/constants.h"
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "obj/triangleMesh.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Axis aligned box used as bounding volume by BoundingVolumeHierarchy nodes.
+// Default constructed box is empty, so growing it by any point results in box
+// that contains only that point.
+struct AxisAlignedBox : public Printable {
+  AxisAlignedBox();
+
+  void grow(const core::Vec3 &point);
+  void grow(const AxisAlignedBox &other);
+  // Extends box by |margin| in every direction.
+  void pad(float margin);
+
+  bool empty() const;
+  float surfaceArea() const;
+  core::Vec3 center() const;
+
+  // Returns true if ray with |origin| and |inverseDirection| (1 / direction
+  // per axis) crosses the box before |maxTime|. |entryTime| is set to the time
+  // at which ray enters the box.
+  bool hitBox(const float origin[3], const float inverseDirection[3],
+              float maxTime, float *entryTime) const;
+
+  void printItself(std::ostream &os) const noexcept override;
+
+  float min[3], max[3];
+};
+
+// Bounding Volume Hierarchy over the triangles of the mesh built with
+// Surface Area Heuristic (SAH). Once built, it finds closest triangle hit by
+// the ray in O(log(triangles)) instead of testing every triangle.
+class BoundingVolumeHierarchy : public Printable {
+public:
+  // Leaf nodes hold |numOfTriangles| > 0 triangles, starting at
+  // |firstIndex| in triangleIndices(). Interior nodes have
+  // |numOfTriangles| == 0 and their children are stored next to each other
+  // at |firstIndex| and |firstIndex| + 1 in nodes().
+  struct Node {
+    AxisAlignedBox bounds;
+    int firstIndex;
+    int numOfTriangles;
+  };
+
+  explicit BoundingVolumeHierarchy(
+      std::shared_ptr<const objects::TriangleMesh> mesh);
+  // Creates hierarchy from |nodes| and |triangleIndices| of the hierarchy
+  // built earlier for the same |mesh|, e.g. read from the scene cache.
+  // Throws std::invalid_argument if they don't form valid hierarchy over the
+  // triangles of |mesh|.
+  BoundingVolumeHierarchy(std::shared_ptr<const objects::TriangleMesh> mesh,
+                          std::vector<Node> nodes,
+                          std::vector<int> triangleIndices);
+
+  // Returns true if |ray| hits any triangle. |hitData| is modified to hold
+  // information about the closest hit. Semantics are the same as testing
+  // every triangle in order: when two triangles are hit at the same time, the
+  // one with lower index in the mesh wins. When there is no hit, |hitData|
+  // is left untouched. When |numOfTriangleTests| is given, number of
+  // ray-triangle tests made during the search is added to it.
+  [[nodiscard]] bool closestHit(const core::Ray &ray, float frequency,
+                                core::RayHitData *hitData,
+                                int *numOfTriangleTests = nullptr) const;
+
+  const std::vector<Node> &nodes() const { return nodes_; }
+  const std::vector<int> &triangleIndices() const { return triangleIndices_; }
+  const std::shared_ptr<const objects::TriangleMesh> &mesh() const {
+    return mesh_;
+  }
+  size_t numOfNodes() const { return nodes_.size(); }
+  size_t numOfTriangles() const { return mesh_->size(); }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  void buildNode(int nodeIndex, int begin, int end,
+                 const std::vector<AxisAlignedBox> &triangleBounds,
+                 const std::vector<core::Vec3> &centroids, int depth);
+
+  std::vector<Node> nodes_;
+  std::vector<int> triangleIndices_;
+  std::shared_ptr<const objects::TriangleMesh> mesh_;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "main/collectorsIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Collector is accepted by isVecInside() when computed distance is equal to
+// its radius, so its box is slightly bigger to cover floating point errors.
+const float kRelativeMargin = 1e-4;
+
+const std::vector<int> kNoCandidates;
+
+AxisAlignedBox collectorBox(const objects::EnergyCollector &collector) {
+  AxisAlignedBox box;
+  box.grow(collector.getOrigin());
+  box.pad(collector.getRadius() * (1 + kRelativeMargin) +
+          constants::kAccuracy);
+  return box;
+}
+
+} // namespace
+
+CollectorsIndex::CollectorsIndex(const Collectors &collectors)
+    : cellSize_(1), numOfCells_{1, 1, 1},
+      numOfCollectors_(collectors.size()) {
+  if (collectors.empty()) {
+    return;
+  }
+
+  float sumOfDiameters = 0;
+  for (const auto &collector : collectors) {
+    bounds_.grow(collectorBox(*collector));
+    sumOfDiameters += 2 * collector->getRadius();
+  }
+
+  // Cell of the size of an average collector keeps only few collectors in
+  // each cell.
+  float longestSide = 0;
+  for (int axis = 0; axis < 3; ++axis) {
+    longestSide = std::max(longestSide, bounds_.max[axis] - bounds_.min[axis]);
+  }
+  cellSize_ = std::max({sumOfDiameters / collectors.size(),
+                        longestSide / kMaxCellsPerAxis, constants::kAccuracy});
+  for (int axis = 0; axis < 3; ++axis) {
+    numOfCells_[axis] = std::clamp(
+        static_cast<int>(
+            std::ceil((bounds_.max[axis] - bounds_.min[axis]) / cellSize_)),
+        1, kMaxCellsPerAxis);
+  }
+  cells_.resize(numOfCells_[0] * numOfCells_[1] * numOfCells_[2]);
+
+  for (size_t index = 0; index < collectors.size(); ++index) {
+    AxisAlignedBox box = collectorBox(*collectors[index]);
+    int first[3], last[3];
+    for (int axis = 0; axis < 3; ++axis) {
+      first[axis] = cellCoordinate(box.min[axis], axis);
+      last[axis] = cellCoordinate(box.max[axis], axis);
+    }
+    for (int x = first[0]; x <= last[0]; ++x) {
+      for (int y = first[1]; y <= last[1]; ++y) {
+        for (int z = first[2]; z <= last[2]; ++z) {
+          cells_[(x * numOfCells_[1] + y) * numOfCells_[2] + z].push_back(
+              index);
+        }
+      }
+    }
+  }
+}
+
+const std::vector<int> &
+CollectorsIndex::candidates(const core::Vec3 &point) const {
+  const float position[3] = {point.x(), point.y(), point.z()};
+  for (int axis = 0; axis < 3; ++axis) {
+    if (!(position[axis] >= bounds_.min[axis] &&
+          position[axis] <= bounds_.max[axis])) {
+      return kNoCandidates;
+    }
+  }
+  int x = cellCoordinate(position[0], 0);
+  int y = cellCoordinate(position[1], 1);
+  int z = cellCoordinate(position[2], 2);
+  return cells_[(x * numOfCells_[1] + y) * numOfCells_[2] + z];
+}
+
+int CollectorsIndex::cellCoordinate(float position, int axis) const {
+  int cell = static_cast<int>((position - bounds_.min[axis]) / cellSize_);
+  return std::clamp(cell, 0, numOfCells_[axis] - 1);
+}
+
+void CollectorsIndex::printItself(std::ostream &os) const noexcept {
+  os << "Collectors Index of " << numOfCollectors_ << " collectors, "
+     << numOfCells_[0] << "x" << numOfCells_[1] << "x" << numOfCells_[2]
+     << " cells of size " << cellSize_;
+}
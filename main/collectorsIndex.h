@@ -0,0 +1,44 @@
+#ifndef COLLECTORS_INDEX_H
+#define COLLECTORS_INDEX_H
+
+#include "core/classUtlilities.h"
+#include "core/vec3.h"
+#include "main/boundingVolumeHierarchy.h"
+#include "obj/objects.h"
+
+#include <memory>
+#include <vector>
+
+using Collectors = std::vector<std::unique_ptr<objects::EnergyCollector>>;
+
+// Uniform grid over the bounding boxes of energy collectors. Each cell of the
+// grid keeps indices of collectors whose box overlaps the cell, so finding
+// collectors that may contain a point costs the same for any number of
+// collectors. Index stores only geometry of collectors, so it can be used
+// with every set of collectors with the same origins and radii, for example
+// copies made for different frequencies or threads.
+class CollectorsIndex : public Printable {
+public:
+  explicit CollectorsIndex(const Collectors &collectors);
+
+  // Returns indices of collectors that may contain |point|, in ascending
+  // order. Every collector that contains |point| is returned.
+  const std::vector<int> &candidates(const core::Vec3 &point) const;
+
+  size_t numOfCollectors() const { return numOfCollectors_; }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  // Limits memory of the grid for collectors much smaller than whole array.
+  static const int kMaxCellsPerAxis = 64;
+
+  int cellCoordinate(float position, int axis) const;
+
+  AxisAlignedBox bounds_;
+  float cellSize_;
+  int numOfCells_[3];
+  std::vector<std::vector<int>> cells_;
+  size_t numOfCollectors_;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "main/exitBatch.h"
+
+#include "core/constants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+ExitBatch::ExitBatch(float sphereWallRadius)
+    : sphereWall_(sphereWallRadius),
+      radiusSquared_(sphereWallRadius * sphereWallRadius), size_(0) {
+  // Unused slots are computed as well, so they must hold valid numbers.
+  for (std::array<float, kCapacity> *array :
+       {&originX_, &originY_, &originZ_, &directionX_, &directionY_,
+        &directionZ_, &times_}) {
+    array->fill(0);
+  }
+  hits_.fill(0);
+}
+
+int ExitBatch::add(const core::Ray &ray) {
+  if (full()) {
+    std::stringstream errorStream;
+    errorStream << "ExitBatch can buffer at most " << kCapacity << " rays!";
+    throw std::logic_error(errorStream.str());
+  }
+  const int slot = size_++;
+  rays_[slot] = ray;
+  originX_[slot] = ray.origin().x();
+  originY_[slot] = ray.origin().y();
+  originZ_[slot] = ray.origin().z();
+  directionX_[slot] = ray.direction().x();
+  directionY_[slot] = ray.direction().y();
+  directionZ_[slot] = ray.direction().z();
+  return slot;
+}
+
+void ExitBatch::computeExits() {
+  // The same operations, in the same order, as in Sphere::hitObject() for the
+  // sphere centered at the origin of the coordinate system.
+  for (int slot = 0; slot < kCapacity; ++slot) {
+    const float beta =
+        2 * (originX_[slot] * directionX_[slot] +
+             originY_[slot] * directionY_[slot] +
+             originZ_[slot] * directionZ_[slot]);
+    const float gamma = (originX_[slot] * originX_[slot] +
+                         originY_[slot] * originY_[slot] +
+                         originZ_[slot] * originZ_[slot]) -
+                        radiusSquared_;
+    const float discriminant = beta * beta - 4 * gamma;
+    const float root = std::sqrt(std::max(discriminant, 0.0f));
+    const float timeLow = (-beta - root) / 2;
+    const float timeHigh = (-beta + root) / 2;
+
+    hits_[slot] = discriminant >= 0 && timeHigh > constants::kAccuracy &&
+                  std::abs(timeLow) >= constants::kAccuracy;
+    times_[slot] = timeLow > 0 ? timeLow : timeHigh;
+  }
+}
+
+bool ExitBatch::exit(int slot, float frequency,
+                     core::RayHitData *hitData) const {
+  if (!hits_[slot]) {
+    return false;
+  }
+  const core::Ray &ray = rays_[slot];
+  *hitData = core::RayHitData(times_[slot],
+                              sphereWall_.normal(ray.at(times_[slot])), ray,
+                              frequency, hitData->accumulatedTime);
+  return true;
+}
+
+void ExitBatch::printItself(std::ostream &os) const noexcept {
+  os << "Exit Batch with " << size_ << " of " << kCapacity
+     << " rays, sphere wall: " << sphereWall_;
+}
@@ -0,0 +1,48 @@
+#ifndef EXIT_BATCH_H
+#define EXIT_BATCH_H
+
+#include "core/classUtlilities.h"
+#include "core/ray.h"
+#include "obj/objects.h"
+
+#include <array>
+
+// Rays that left the model, buffered as structure of arrays, so exits of all
+// of them through the sphere wall are computed by one branchless loop of
+// fixed length, which the compiler can vectorize. Exits are computed with
+// exactly the same floating point operations as in SphereWall::hitObject(),
+// so hits are the same as from tracing every ray separately.
+class ExitBatch : public Printable {
+public:
+  static constexpr int kCapacity = 16;
+
+  explicit ExitBatch(float sphereWallRadius);
+
+  // Buffers |ray| and returns its slot in the batch. Batch cannot be full.
+  int add(const core::Ray &ray);
+  // Computes exits of every buffered ray through the sphere wall.
+  void computeExits();
+  // Returns true if the ray at |slot| hits the sphere wall, its hit at
+  // |frequency| is then written to |hitData|, the same as by
+  // SphereWall::hitObject(). Valid only after computeExits().
+  bool exit(int slot, float frequency, core::RayHitData *hitData) const;
+  void clear() { size_ = 0; }
+
+  int size() const { return size_; }
+  bool full() const { return size_ == kCapacity; }
+  bool empty() const { return size_ == 0; }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  objects::SphereWall sphereWall_;
+  float radiusSquared_;
+  int size_;
+  std::array<core::Ray, kCapacity> rays_;
+  alignas(64) std::array<float, kCapacity> originX_, originY_, originZ_;
+  alignas(64) std::array<float, kCapacity> directionX_, directionY_,
+      directionZ_;
+  alignas(64) std::array<float, kCapacity> times_;
+  alignas(64) std::array<int, kCapacity> hits_;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "main/incrementalSimulator.h"
+
+#include "main/collectorsIndex.h"
+#include "main/traceRecorder.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// Returns copy of |collectors| without collected energy.
+Collectors copyLayout(const Collectors &collectors) {
+  Collectors copy;
+  copy.reserve(collectors.size());
+  for (const auto &collector : collectors) {
+    copy.push_back(std::make_unique<objects::EnergyCollector>(
+        collector->getOrigin(), collector->getRadius(),
+        collector->getEnergy().sampleRate(),
+        collector->getEnergy().timeWindow()));
+  }
+  return copy;
+}
+
+bool sameVertices(const objects::TriangleObj &left,
+                  const objects::TriangleObj &right) {
+  auto same = [](const core::Vec3 &first, const core::Vec3 &second) {
+    return first.x() == second.x() && first.y() == second.y() &&
+           first.z() == second.z();
+  };
+  return same(left.point1(), right.point1()) &&
+         same(left.point2(), right.point2()) &&
+         same(left.point3(), right.point3());
+}
+
+AxisAlignedBox triangleBounds(const objects::TriangleObj &triangle) {
+  AxisAlignedBox bounds;
+  bounds.grow(triangle.point1());
+  bounds.grow(triangle.point2());
+  bounds.grow(triangle.point3());
+  // Rays that graze the triangle are traced again as well.
+  bounds.pad(constants::kAccuracy);
+  return bounds;
+}
+
+} // namespace
+
+IncrementalSimulator::IncrementalSimulator(
+    ModelInterface *model, generators::RayFactory *source,
+    generators::RandomRayOffseter *offseter,
+    collectionRules::CollectEnergyInterface *energyCollectionRules,
+    const std::vector<float> &frequencies, const Collectors &collectors,
+    int maxTracking)
+    : model_(model), triangles_(model->triangles()),
+      sphereWallRadius_(getSphereWallRadius(*model)), source_(source),
+      offseter_(offseter), energyCollectionRules_(energyCollectionRules),
+      frequencies_(frequencies), collectorsLayout_(copyLayout(collectors)),
+      maxTracking_(maxTracking), paths_(source->numOfRays()) {
+  if (frequencies.empty()) {
+    throw std::invalid_argument(
+        "Frequencies of IncrementalSimulator cannot be empty!");
+  }
+  timeline::ScopedSpan span("IncrementalSimulator::trace",
+                            {{"numOfRays", paths_.size()}});
+  RayTracer tracer(model_);
+  for (size_t rayIndex = 0; rayIndex < paths_.size(); ++rayIndex) {
+    traceRay(rayIndex, tracer, &paths_[rayIndex]);
+  }
+}
+
+int IncrementalSimulator::update(ModelInterface *model) {
+  timeline::ScopedSpan span("IncrementalSimulator::update");
+  const std::vector<objects::TriangleObj> &triangles = model->triangles();
+  std::vector<AxisAlignedBox> editedBounds;
+  const size_t numOfTriangles = std::max(triangles.size(), triangles_.size());
+  for (size_t index = 0; index < numOfTriangles; ++index) {
+    const bool inOld = index < triangles_.size();
+    const bool inNew = index < triangles.size();
+    if (inOld && inNew && sameVertices(triangles_[index], triangles[index])) {
+      continue;
+    }
+    if (inOld) {
+      editedBounds.push_back(triangleBounds(triangles_[index]));
+    }
+    if (inNew) {
+      editedBounds.push_back(triangleBounds(triangles[index]));
+    }
+  }
+
+  const bool sphereWallChanged =
+      getSphereWallRadius(*model) != sphereWallRadius_;
+  model_ = model;
+  triangles_ = triangles;
+  sphereWallRadius_ = getSphereWallRadius(*model);
+  if (editedBounds.empty() && !sphereWallChanged) {
+    return 0;
+  }
+
+  RayTracer tracer(model_);
+  int numOfRetracedRays = 0;
+  for (size_t rayIndex = 0; rayIndex < paths_.size(); ++rayIndex) {
+    if (sphereWallChanged || crossesAny(paths_[rayIndex], editedBounds)) {
+      traceRay(rayIndex, tracer, &paths_[rayIndex]);
+      ++numOfRetracedRays;
+    }
+  }
+  return numOfRetracedRays;
+}
+
+void IncrementalSimulator::traceRay(int rayIndex, const RayTracer &tracer,
+                                    RayPath *path) const {
+  // Follows Simulator::traceRays(), so cached final hits are the same.
+  const float frequency = frequencies_.front();
+  // Rays that leave the simulation are followed far enough to cross every
+  // triangle they could hit.
+  const float escapeDistance = 4 * sphereWallRadius_;
+  objects::SphereWall sphereWall(sphereWallRadius_);
+  path->segments.clear();
+
+  core::Ray currentRay = source_->getRay(rayIndex);
+  offseter_->offsetRay(&currentRay, rayIndex, frequency);
+  core::RayHitData hitData;
+  RayTracer::TraceResult hitResult = RayTracer::TraceResult::HIT_TRIANGLE;
+  int currentTracking = 0;
+  while (hitResult == RayTracer::TraceResult::HIT_TRIANGLE) {
+    const core::Vec3 origin = currentRay.origin();
+    hitResult = tracer.rayTrace(currentRay, frequency, &hitData);
+    path->segments.emplace_back(
+        origin, hitResult == RayTracer::TraceResult::HIT_TRIANGLE
+                    ? hitData.collisionPoint()
+                    : currentRay.at(origin.magnitude() + escapeDistance));
+    currentRay = tracer.getReflected(&hitData);
+
+    ++currentTracking;
+    if (currentTracking > maxTracking_) {
+      break;
+    }
+  }
+
+  const core::Vec3 origin = currentRay.origin();
+  if (sphereWall.hitObject(currentRay, frequency, &hitData)) {
+    path->segments.emplace_back(origin, hitData.collisionPoint());
+    hitData.accumulatedTime += hitData.time / constants::kSoundSpeed;
+  } else {
+    path->segments.emplace_back(
+        origin, currentRay.at(origin.magnitude() + escapeDistance));
+  }
+  path->finalHit = hitData;
+}
+
+bool IncrementalSimulator::crossesAny(
+    const RayPath &path, const std::vector<AxisAlignedBox> &boxes) {
+  for (const auto &[start, end] : path.segments) {
+    const core::Vec3 direction = end - start;
+    const float origin[3] = {start.x(), start.y(), start.z()};
+    const float inverseDirection[3] = {1 / direction.x(), 1 / direction.y(),
+                                       1 / direction.z()};
+    for (const AxisAlignedBox &box : boxes) {
+      float entryTime;
+      if (box.hitBox(origin, inverseDirection, /*maxTime=*/1, &entryTime)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+EnergyTensor IncrementalSimulator::energies() const {
+  timeline::ScopedSpan span("IncrementalSimulator::energies");
+  std::unordered_map<float, Collectors> collectorsPerFrequencies;
+  std::vector<Collectors *> collectors;
+  std::vector<CollectorsIndex> collectorsIndices;
+  for (float frequency : frequencies_) {
+    collectors.push_back(
+        &collectorsPerFrequencies
+             .emplace(frequency, copyLayout(collectorsLayout_))
+             .first->second);
+    collectorsIndices.emplace_back(*collectors.back());
+  }
+  for (const RayPath &path : paths_) {
+    for (size_t frequencyIndex = 0; frequencyIndex < frequencies_.size();
+         ++frequencyIndex) {
+      core::RayHitData frequencyHitData = path.finalHit;
+      frequencyHitData.frequency = frequencies_[frequencyIndex];
+      energyCollectionRules_->collectEnergy(*collectors[frequencyIndex],
+                                            collectorsIndices[frequencyIndex],
+                                            &frequencyHitData);
+    }
+  }
+  return EnergyTensor::FromCollectors(collectorsPerFrequencies);
+}
+
+void IncrementalSimulator::printItself(std::ostream &os) const noexcept {
+  os << "Incremental Simulator with " << paths_.size()
+     << " cached rays, model: " << *model_;
+}
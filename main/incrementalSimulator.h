@@ -0,0 +1,83 @@
+#ifndef INCREMENTAL_SIMULATOR_H
+#define INCREMENTAL_SIMULATOR_H
+
+#include "core/classUtlilities.h"
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "main/boundingVolumeHierarchy.h"
+#include "main/model.h"
+#include "main/rayTracer.h"
+#include "main/resultsCalculation.h"
+#include "main/simulator.h"
+#include "obj/generators.h"
+#include "obj/objects.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Simulation that caches path of every ray, so it can be updated after local
+// edits of the model, e.g. change of a single well depth of the diffusor, by
+// tracing again only rays whose paths cross the edited triangles. Paths of
+// other rays cannot change: they never hit edited triangles before the edit
+// and never cross them after it. Final hit of every ray is cached as well, so
+// energies of all rays are collected again from the cache, without tracing,
+// and results are the same as of the Simulator::run() on the single thread.
+// Rays are traced on the calling thread and termination policies are not
+// applied.
+class IncrementalSimulator : public Printable {
+public:
+  // Traces every ray of |source| offset by |offseter| through |model|, at
+  // most |maxTracking| reflections per ray. Energy of every frequency of
+  // |frequencies| is collected by |energyCollectionRules| into collectors
+  // with the same layout as |collectors|, which are left unchanged.
+  // |frequencies| cannot be empty.
+  IncrementalSimulator(
+      ModelInterface *model, generators::RayFactory *source,
+      generators::RandomRayOffseter *offseter,
+      collectionRules::CollectEnergyInterface *energyCollectionRules,
+      const std::vector<float> &frequencies, const Collectors &collectors,
+      int maxTracking);
+
+  // Replaces simulated model with |model|, which is the edited previous
+  // model. Triangles at the same index that differ in any vertex and
+  // triangles present only in one of the models are edited. Traces again
+  // rays whose paths cross bounds of edited triangles, before or after the
+  // edit, and returns their number. Every ray is traced again when the
+  // sphere wall of the model changes.
+  int update(ModelInterface *model);
+
+  // Energy collected by every frequency from all rays.
+  EnergyTensor energies() const;
+
+  int numOfRays() const { return paths_.size(); }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  struct RayPath {
+    // Segments of the path, from the source to the sphere wall.
+    std::vector<std::pair<core::Vec3, core::Vec3>> segments;
+    // Hit passed to the collection rules.
+    core::RayHitData finalHit;
+  };
+
+  void traceRay(int rayIndex, const RayTracer &tracer, RayPath *path) const;
+  // Returns true when any segment of |path| crosses any of |boxes|.
+  static bool crossesAny(const RayPath &path,
+                         const std::vector<AxisAlignedBox> &boxes);
+
+  ModelInterface *model_;
+  // Copy of the triangles of |model_|, so edits can be found.
+  std::vector<objects::TriangleObj> triangles_;
+  float sphereWallRadius_;
+  generators::RayFactory *source_;
+  generators::RandomRayOffseter *offseter_;
+  collectionRules::CollectEnergyInterface *energyCollectionRules_;
+  std::vector<float> frequencies_;
+  // Layout of the collectors: origin, radius, sample rate and time window.
+  Collectors collectorsLayout_;
+  int maxTracking_;
+  std::vector<RayPath> paths_;
+};
+
+#endif
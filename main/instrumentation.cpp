@@ -0,0 +1,157 @@
+#include "main/instrumentation.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace instrumentation {
+
+namespace {
+
+const char *counterName(Counter counter) {
+  switch (counter) {
+  case Counter::RAYS:
+    return "rays";
+  case Counter::TRIANGLE_TESTS:
+    return "triangleTests";
+  case Counter::TRIANGLE_HITS:
+    return "triangleHits";
+  case Counter::SPHERE_WALL_HITS:
+    return "sphereWallHits";
+  case Counter::TRUNCATED_RAYS:
+    return "truncatedRays";
+  default:
+    return "unknown";
+  }
+}
+
+const char *stageName(Stage stage) {
+  switch (stage) {
+  case Stage::SIMULATION:
+    return "simulation";
+  case Stage::RAY_GENERATION:
+    return "rayGeneration";
+  case Stage::RAY_TRACING:
+    return "rayTracing";
+  case Stage::SPHERE_WALL:
+    return "sphereWall";
+  case Stage::COLLECTION:
+    return "collection";
+  case Stage::TRACKING:
+    return "tracking";
+  default:
+    return "unknown";
+  }
+}
+
+// Statistics of running threads and sum of statistics of finished ones.
+struct Registry {
+  std::mutex mutex;
+  std::unordered_set<Statistics *> threads;
+  Statistics finishedThreads;
+};
+
+Registry &registry() {
+  // Never destroyed, so threads that finish during static destruction can
+  // still unregister.
+  static Registry *registry = new Registry();
+  return *registry;
+}
+
+// Registers statistics of the thread on construction and moves them into
+// finished threads when thread ends.
+struct ThreadStatistics {
+  ThreadStatistics() {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().threads.insert(&statistics);
+  }
+  ~ThreadStatistics() {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().finishedThreads.add(statistics);
+    registry().threads.erase(&statistics);
+  }
+
+  Statistics statistics;
+};
+
+} // namespace
+
+Statistics::Statistics() {
+  counters_.fill(0);
+  stageTimes_.fill(std::chrono::nanoseconds::zero());
+  bounceDepths_.fill(0);
+}
+
+void Statistics::addBounceDepth(int depth) {
+  ++bounceDepths_[std::clamp(depth, 0, kNumOfBounceDepths - 1)];
+}
+
+void Statistics::add(const Statistics &other) {
+  for (size_t index = 0; index < counters_.size(); ++index) {
+    counters_[index] += other.counters_[index];
+  }
+  for (size_t index = 0; index < stageTimes_.size(); ++index) {
+    stageTimes_[index] += other.stageTimes_[index];
+  }
+  for (size_t index = 0; index < bounceDepths_.size(); ++index) {
+    bounceDepths_[index] += other.bounceDepths_[index];
+  }
+}
+
+bool Statistics::empty() const {
+  auto isZero = [](auto value) { return value == decltype(value)(); };
+  return std::all_of(counters_.begin(), counters_.end(), isZero) &&
+         std::all_of(stageTimes_.begin(), stageTimes_.end(), isZero) &&
+         std::all_of(bounceDepths_.begin(), bounceDepths_.end(), isZero);
+}
+
+nlohmann::json Statistics::toJson() const {
+  nlohmann::json counters = nlohmann::json::object();
+  for (int index = 0; index < static_cast<int>(Counter::NUM_OF_COUNTERS);
+       ++index) {
+    counters[counterName(static_cast<Counter>(index))] = counters_[index];
+  }
+  nlohmann::json stageSeconds = nlohmann::json::object();
+  for (int index = 0; index < static_cast<int>(Stage::NUM_OF_STAGES);
+       ++index) {
+    stageSeconds[stageName(static_cast<Stage>(index))] =
+        std::chrono::duration<double>(stageTimes_[index]).count();
+  }
+  // Trailing empty depths are skipped.
+  auto lastDepth = std::find_if(bounceDepths_.rbegin(), bounceDepths_.rend(),
+                                [](uint64_t rays) { return rays > 0; });
+  nlohmann::json bounceDepths =
+      std::vector<uint64_t>(bounceDepths_.cbegin(), lastDepth.base());
+  return {{"counters", counters},
+          {"stageSeconds", stageSeconds},
+          {"bounceDepths", bounceDepths}};
+}
+
+void Statistics::printItself(std::ostream &os) const noexcept {
+  os << "Instrumentation Statistics: " << toJson().dump();
+}
+
+Statistics &threadStatistics() {
+  thread_local ThreadStatistics threadStatistics;
+  return threadStatistics.statistics;
+}
+
+Statistics collectStatistics() {
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  Statistics statistics = registry().finishedThreads;
+  for (const Statistics *thread : registry().threads) {
+    statistics.add(*thread);
+  }
+  return statistics;
+}
+
+void resetStatistics() {
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  registry().finishedThreads = Statistics();
+  for (Statistics *thread : registry().threads) {
+    *thread = Statistics();
+  }
+}
+
+} // namespace instrumentation
@@ -0,0 +1,129 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "core/classUtlilities.h"
+#include "nlohmann/json.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// Counters and timers of the simulation hot paths. Every thread records into
+// its own Statistics, which are summed by collectStatistics(), so recording
+// needs neither locks nor atomics.
+// Simulation code records through INSTRUMENT_* macros below, which compile
+// to nothing unless SIMULATION_INSTRUMENTATION is defined, e.g. with:
+//   bazel build --config=instrumentation validation
+namespace instrumentation {
+
+enum class Counter {
+  RAYS,
+  TRIANGLE_TESTS,
+  TRIANGLE_HITS,
+  SPHERE_WALL_HITS,
+  // Rays whose tracing stopped after maxTracking bounces.
+  TRUNCATED_RAYS,
+  NUM_OF_COUNTERS
+};
+
+enum class Stage {
+  SIMULATION,
+  RAY_GENERATION,
+  RAY_TRACING,
+  SPHERE_WALL,
+  COLLECTION,
+  TRACKING,
+  NUM_OF_STAGES
+};
+
+// Rays that bounced this many times or more share the last bin of the bounce
+// depth histogram.
+const int kNumOfBounceDepths = 32;
+
+class Statistics : public Printable {
+public:
+  Statistics();
+
+  void count(Counter counter, uint64_t value) {
+    counters_[static_cast<int>(counter)] += value;
+  }
+  void addStageTime(Stage stage, std::chrono::nanoseconds time) {
+    stageTimes_[static_cast<int>(stage)] += time;
+  }
+  void addBounceDepth(int depth);
+  void add(const Statistics &other);
+
+  uint64_t counter(Counter counter) const {
+    return counters_[static_cast<int>(counter)];
+  }
+  std::chrono::nanoseconds stageTime(Stage stage) const {
+    return stageTimes_[static_cast<int>(stage)];
+  }
+  const std::array<uint64_t, kNumOfBounceDepths> &bounceDepths() const {
+    return bounceDepths_;
+  }
+  // Returns true if nothing was recorded.
+  bool empty() const;
+
+  // Counters, bounce depth histogram and time of every stage in seconds,
+  // summed over all threads.
+  nlohmann::json toJson() const;
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  std::array<uint64_t, static_cast<int>(Counter::NUM_OF_COUNTERS)> counters_;
+  std::array<std::chrono::nanoseconds, static_cast<int>(Stage::NUM_OF_STAGES)>
+      stageTimes_;
+  std::array<uint64_t, kNumOfBounceDepths> bounceDepths_;
+};
+
+// Statistics recorded by the calling thread.
+Statistics &threadStatistics();
+// Sum of statistics recorded by every thread since the last reset, including
+// threads that already finished. Threads must not record while statistics
+// are collected or reset.
+Statistics collectStatistics();
+void resetStatistics();
+
+// Adds time from construction to destruction to the |stage| of the thread.
+class ScopedStageTimer {
+public:
+  explicit ScopedStageTimer(Stage stage)
+      : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedStageTimer() {
+    threadStatistics().addStageTime(stage_,
+                                    std::chrono::steady_clock::now() - start_);
+  }
+
+  ScopedStageTimer(const ScopedStageTimer &) = delete;
+  ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+private:
+  Stage stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace instrumentation
+
+#define INSTRUMENT_CONCATENATE_IMPL(left, right) left##right
+#define INSTRUMENT_CONCATENATE(left, right)                                    \
+  INSTRUMENT_CONCATENATE_IMPL(left, right)
+
+#ifdef SIMULATION_INSTRUMENTATION
+#define INSTRUMENT_COUNT(counter, value)                                       \
+  instrumentation::threadStatistics().count(                                   \
+      instrumentation::Counter::counter, value)
+#define INSTRUMENT_BOUNCE_DEPTH(depth)                                         \
+  instrumentation::threadStatistics().addBounceDepth(depth)
+// Times the rest of the enclosing scope.
+#define INSTRUMENT_STAGE(stage)                                                \
+  instrumentation::ScopedStageTimer INSTRUMENT_CONCATENATE(stageTimer,         \
+                                                           __LINE__)(          \
+      instrumentation::Stage::stage)
+#else
+#define INSTRUMENT_COUNT(counter, value)
+#define INSTRUMENT_BOUNCE_DEPTH(depth)
+#define INSTRUMENT_STAGE(stage)
+#endif
+
+#endif
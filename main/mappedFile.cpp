@@ -0,0 +1,48 @@
+#include "main/mappedFile.h"
+
+#include <fcntl.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(std::string_view path)
+    : path_(path), data_(nullptr), size_(0) {
+  int descriptor = open(path_.c_str(), O_RDONLY);
+  struct stat status;
+  if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+    if (descriptor >= 0) {
+      close(descriptor);
+    }
+    std::stringstream errorStream;
+    errorStream << "Cannot open file at: " << path_;
+    throw std::invalid_argument(errorStream.str());
+  }
+
+  size_ = status.st_size;
+  // Empty files cannot be mapped, but they are valid files to read.
+  if (size_ > 0) {
+    void *mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (mapping == MAP_FAILED) {
+      close(descriptor);
+      std::stringstream errorStream;
+      errorStream << "Cannot map file at: " << path_ << " into memory";
+      throw std::invalid_argument(errorStream.str());
+    }
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(mapping);
+  }
+  // Mapping stays valid after the descriptor is closed.
+  close(descriptor);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char *>(data_), size_);
+  }
+}
+
+void MappedFile::printItself(std::ostream &os) const noexcept {
+  os << "Mapped File: " << path_ << ", size: " << size_ << " bytes";
+}
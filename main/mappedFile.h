@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "core/classUtlilities.h"
+
+#include <string>
+#include <string_view>
+
+// Read-only view of the whole file mapped into memory. File content is read
+// by the operating system on first access to every page, so big files are
+// neither copied into user space buffers nor read in small portions.
+class MappedFile : public Printable {
+public:
+  // Throws std::invalid_argument if file at |path| cannot be opened or
+  // mapped.
+  explicit MappedFile(std::string_view path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Valid as long as the MappedFile exists.
+  std::string_view content() const { return std::string_view(data_, size_); }
+  size_t size() const { return size_; }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  std::string path_;
+  const char *data_;
+  size_t size_;
+};
+
+#endif
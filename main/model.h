@@ -2,6 +2,7 @@
 #define MODEL_H
 
 #include "core/classUtlilities.h"
+#include "main/boundingVolumeHierarchy.h"
 #include "obj/objects.h"
 
 #include <algorithm>
@@ -23,6 +24,12 @@ public:
   virtual float sideSize() const = 0;
   // returns true if there is no object assigned to a model.
   virtual bool empty() const = 0;
+  // Hierarchy built earlier over the triangles of the model, e.g. read from
+  // the scene cache, or nullptr if RayTracer has to build it.
+  virtual std::shared_ptr<const BoundingVolumeHierarchy>
+  boundingVolumeHierarchy() const {
+    return nullptr;
+  }
   void printItself(std::ostream &os) const noexcept override;
 
 private:
@@ -31,23 +38,41 @@ private:
 
 class Model : public ModelInterface {
 public:
-  // Creates model object from given path to .obj file.
-  static std::unique_ptr<Model> NewLoadFromObjectFile(std::string_view path);
+  // Creates model object from given path to .obj file. File is mapped into
+  // memory and parsed by |numOfThreads| threads, by default by every hardware
+  // thread. Degenerated triangles are reported and skipped.
+  static std::unique_ptr<Model> NewLoadFromObjectFile(std::string_view path,
+                                                      int numOfThreads = 0);
+  // Creates model object from |content| of .obj file, the same way as
+  // NewLoadFromObjectFile().
+  static std::unique_ptr<Model> NewFromObjFileContent(std::string_view content,
+                                                      int numOfThreads = 0);
   // Creates Model object that represent perfectly flat square on XY surface at
   // Z = 0, positioned at the middle of the simulation.
   // This model is made out of two equal-arm / rectangular Triangle Objects,
   // where |sideSize| represents sides length at a right angle.
   static std::unique_ptr<Model> NewReferenceModel(float sideSize);
 
-  Model(const std::vector<objects::TriangleObj> &triangles);
+  Model(std::vector<objects::TriangleObj> triangles);
   const std::vector<objects::TriangleObj> &triangles() const;
 
   bool empty() const override;
-  void setHeight(const float height) { height_ = height_; }
+  void setHeight(const float height) { height_ = height; }
   float height() const { return height_; }
 
   void setSideSize(const float sideSize) { sideSize_ = sideSize; }
   float sideSize() const { return sideSize_; }
+
+  // |hierarchy| must be built over the triangles of this model, in the same
+  // order.
+  void setBoundingVolumeHierarchy(
+      std::shared_ptr<const BoundingVolumeHierarchy> hierarchy) {
+    boundingVolumeHierarchy_ = std::move(hierarchy);
+  }
+  std::shared_ptr<const BoundingVolumeHierarchy>
+  boundingVolumeHierarchy() const override {
+    return boundingVolumeHierarchy_;
+  }
   void printItself(std::ostream &os) const noexcept override;
 
 private:
@@ -60,6 +85,7 @@ private:
 
   std::vector<objects::TriangleObj> triangles_;
   float height_, sideSize_;
+  std::shared_ptr<const BoundingVolumeHierarchy> boundingVolumeHierarchy_;
 };
 
 #endif
\ No newline at end of file
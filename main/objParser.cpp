@@ -0,0 +1,273 @@
+#include "main/objParser.h"
+
+#include "core/constants.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Content smaller than that is parsed by a single thread, as starting more
+// threads would take longer than parsing.
+const size_t kMinChunkSize = 1 << 16;
+
+struct Face {
+  // Position of the first vertex index in Chunk::indices.
+  size_t firstIndex;
+  int numOfIndices;
+  // Number of vertices declared in the chunk before the face, needed to
+  // resolve negative indices, which are relative to the last vertex.
+  int numOfPreviousVertices;
+  int line;
+};
+
+// Part of the content made of whole lines. Chunks are parsed in two passes:
+// first one reads vertices and faces, second one, which needs vertices of
+// every chunk, builds triangles.
+struct Chunk {
+  explicit Chunk(std::string_view chunkText) : text(chunkText) {}
+
+  std::string_view text;
+  int numOfLines = 0;
+  std::vector<core::Vec3> vertices;
+  std::vector<int> indices;
+  std::vector<Face> faces;
+
+  // Index of the first vertex and line of the chunk in the whole content.
+  int firstVertex = 0, firstLine = 0;
+  std::vector<std::array<core::Vec3, 3>> triangles;
+  std::vector<int> degeneratedTriangleLines;
+
+  // Empty if chunk was parsed successfully.
+  std::string error;
+  int errorLine = 0;
+};
+
+bool isSpace(char character) {
+  return character == ' ' || character == '\t' || character == '\r' ||
+         character == '\v' || character == '\f';
+}
+
+const char *skipSpaces(const char *position, const char *end) {
+  while (position != end && isSpace(*position)) {
+    ++position;
+  }
+  return position;
+}
+
+// Reads number at |position|, preceded by optional spaces, and moves
+// |position| past it. Number must end with space, '/' or end of the line.
+template <typename T>
+bool readNumber(const char *&position, const char *end, T *value) {
+  position = skipSpaces(position, end);
+  // std::from_chars doesn't accept explicit plus sign.
+  if (position != end && *position == '+') {
+    ++position;
+  }
+  auto [next, error] = std::from_chars(position, end, *value);
+  if (error != std::errc() ||
+      (next != end && !isSpace(*next) && *next != '/')) {
+    return false;
+  }
+  position = next;
+  return true;
+}
+
+void parseLine(const char *position, const char *end, int line,
+               Chunk *chunk) {
+  position = skipSpaces(position, end);
+  const char *keywordEnd = position;
+  while (keywordEnd != end && !isSpace(*keywordEnd)) {
+    ++keywordEnd;
+  }
+  std::string_view keyword(position, keywordEnd - position);
+  position = keywordEnd;
+
+  if (keyword == "v") {
+    float x, y, z;
+    // Z coordinate in .obj files represents y coordinate in this
+    // simulation.
+    if (!readNumber(position, end, &x) || !readNumber(position, end, &z) ||
+        !readNumber(position, end, &y)) {
+      chunk->error = "Invalid point declaration";
+      chunk->errorLine = line;
+      return;
+    }
+    chunk->vertices.push_back(core::Vec3(x, y, z));
+
+  } else if (keyword == "f") {
+    Face face{chunk->indices.size(), 0,
+              static_cast<int>(chunk->vertices.size()), line};
+    for (position = skipSpaces(position, end); position != end;
+         position = skipSpaces(position, end)) {
+      int index;
+      if (!readNumber(position, end, &index) || index == 0) {
+        chunk->error = "Invalid face declaration";
+        chunk->errorLine = line;
+        return;
+      }
+      chunk->indices.push_back(index);
+      ++face.numOfIndices;
+      // Texture and normal indices are not used.
+      while (position != end && !isSpace(*position)) {
+        ++position;
+      }
+    }
+    chunk->faces.push_back(face);
+  }
+}
+
+void readChunk(Chunk *chunk) {
+  const char *position = chunk->text.data();
+  const char *end = position + chunk->text.size();
+  while (position != end && chunk->error.empty()) {
+    const char *lineEnd = static_cast<const char *>(
+        std::memchr(position, '\n', end - position));
+    if (lineEnd == nullptr) {
+      lineEnd = end;
+    }
+    parseLine(position, lineEnd, chunk->numOfLines, chunk);
+    ++chunk->numOfLines;
+    position = lineEnd == end ? end : lineEnd + 1;
+  }
+}
+
+void buildTriangles(const std::vector<core::Vec3> &vertices, Chunk *chunk) {
+  std::vector<int> faceVertices;
+  for (const Face &face : chunk->faces) {
+    faceVertices.clear();
+    for (int offset = 0; offset < face.numOfIndices; ++offset) {
+      int index = chunk->indices[face.firstIndex + offset];
+      int vertex = index > 0 ? index - 1
+                             : chunk->firstVertex +
+                                   face.numOfPreviousVertices + index;
+      if (vertex < 0 || vertex >= static_cast<int>(vertices.size())) {
+        chunk->error = "Face refers to vertex that doesn't exist";
+        chunk->errorLine = face.line;
+        return;
+      }
+      faceVertices.push_back(vertex);
+    }
+
+    // Number of triangles to be made from one polygon
+    int numOfTriangles = face.numOfIndices - 2;
+    for (int triangleIndex = 0; triangleIndex < numOfTriangles;
+         ++triangleIndex) {
+      const core::Vec3 &point1 = vertices[faceVertices[0]];
+      const core::Vec3 &point2 = vertices[faceVertices[triangleIndex + 1]];
+      const core::Vec3 &point3 = vertices[faceVertices[triangleIndex + 2]];
+      if (objects::TriangleObj::Area(point1, point2, point3) <
+          constants::kAccuracy) {
+        chunk->degeneratedTriangleLines.push_back(chunk->firstLine +
+                                                  face.line + 1);
+        continue;
+      }
+      chunk->triangles.push_back({point1, point2, point3});
+    }
+  }
+}
+
+std::vector<Chunk> splitIntoChunks(std::string_view content,
+                                   int numOfThreads) {
+  size_t numOfChunks = std::clamp<size_t>(content.size() / kMinChunkSize, 1,
+                                          numOfThreads);
+  std::vector<Chunk> chunks;
+  chunks.reserve(numOfChunks);
+  size_t begin = 0;
+  for (size_t chunk = 1; chunk <= numOfChunks && begin < content.size();
+       ++chunk) {
+    size_t end = content.size();
+    if (chunk < numOfChunks) {
+      size_t newLine = content.find(
+          '\n', std::max(begin, content.size() * chunk / numOfChunks));
+      end = newLine == std::string_view::npos ? end : newLine + 1;
+    }
+    chunks.emplace_back(content.substr(begin, end - begin));
+    begin = end;
+  }
+  return chunks;
+}
+
+// Calls |function| for every chunk, each of them in separate thread.
+template <typename Function>
+void forEachChunk(std::vector<Chunk> *chunks, Function function) {
+  if (chunks->size() == 1) {
+    function(&chunks->front());
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(chunks->size());
+  for (Chunk &chunk : *chunks) {
+    threads.emplace_back(function, &chunk);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+// Throws error of the first chunk that failed, if there is any.
+void checkErrors(const std::vector<Chunk> &chunks) {
+  for (const Chunk &chunk : chunks) {
+    if (!chunk.error.empty()) {
+      std::stringstream errorStream;
+      errorStream << chunk.error << " in object file at:\n"
+                  << "line: " << chunk.firstLine + chunk.errorLine + 1;
+      throw std::invalid_argument(errorStream.str());
+    }
+  }
+}
+
+} // namespace
+
+ObjFileContent parseObjFile(std::string_view content, int numOfThreads) {
+  if (numOfThreads < 1) {
+    std::stringstream errorStream;
+    errorStream << "Number of threads parsing .obj file must be greater than "
+                << "0! Given: " << numOfThreads;
+    throw std::invalid_argument(errorStream.str());
+  }
+  std::vector<Chunk> chunks = splitIntoChunks(content, numOfThreads);
+  forEachChunk(&chunks, readChunk);
+
+  int numOfVertices = 0, numOfLines = 0;
+  for (Chunk &chunk : chunks) {
+    chunk.firstVertex = numOfVertices;
+    chunk.firstLine = numOfLines;
+    numOfVertices += chunk.vertices.size();
+    numOfLines += chunk.numOfLines;
+  }
+  checkErrors(chunks);
+
+  std::vector<core::Vec3> vertices;
+  vertices.reserve(numOfVertices);
+  for (const Chunk &chunk : chunks) {
+    vertices.insert(vertices.end(), chunk.vertices.begin(),
+                    chunk.vertices.end());
+  }
+  forEachChunk(&chunks,
+               [&vertices](Chunk *chunk) { buildTriangles(vertices, chunk); });
+  checkErrors(chunks);
+
+  ObjFileContent result;
+  size_t numOfTriangles = 0;
+  for (const Chunk &chunk : chunks) {
+    numOfTriangles += chunk.triangles.size();
+  }
+  result.triangles.reserve(numOfTriangles);
+  for (const Chunk &chunk : chunks) {
+    for (const std::array<core::Vec3, 3> &points : chunk.triangles) {
+      result.triangles.emplace_back(points[0], points[1], points[2]);
+    }
+    result.degeneratedTriangleLines.insert(
+        result.degeneratedTriangleLines.end(),
+        chunk.degeneratedTriangleLines.begin(),
+        chunk.degeneratedTriangleLines.end());
+  }
+  return result;
+}
@@ -0,0 +1,27 @@
+#ifndef OBJ_PARSER_H
+#define OBJ_PARSER_H
+
+#include "obj/objects.h"
+
+#include <string_view>
+#include <vector>
+
+// Triangles of the model read from .obj file.
+struct ObjFileContent {
+  std::vector<objects::TriangleObj> triangles;
+  // Line of the face of every triangle that was not included in |triangles|,
+  // because its area is too small.
+  std::vector<int> degeneratedTriangleLines;
+};
+
+// Parses |content| of .obj file. Only vertices ("v") and faces ("f") are
+// read, other declarations are skipped. Z coordinate in .obj files represents
+// y coordinate in this simulation, so they are swapped. Every polygon is
+// split into triangles that share its first vertex.
+// Content is split into at most |numOfThreads| chunks of whole lines, which
+// are parsed in parallel. Result doesn't depend on the number of threads.
+// Throws std::invalid_argument with the line number if vertex or face
+// declaration is malformed.
+ObjFileContent parseObjFile(std::string_view content, int numOfThreads);
+
+#endif
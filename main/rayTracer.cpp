@@ -1,23 +1,41 @@
 #include "main/rayTracer.h"
 
+#include "main/instrumentation.h"
+#include "main/traceRecorder.h"
+
+RayTracer::RayTracer(ModelInterface *model, Acceleration acceleration)
+    : model_(model), acceleration_(acceleration) {
+  timeline::ScopedSpan span("RayTracer::RayTracer");
+  std::shared_ptr<const BoundingVolumeHierarchy> prebuiltHierarchy =
+      model->boundingVolumeHierarchy();
+  mesh_ = prebuiltHierarchy
+              ? prebuiltHierarchy->mesh()
+              : std::make_shared<objects::TriangleMesh>(model->triangles());
+  if (acceleration_ == Acceleration::BOUNDING_VOLUME_HIERARCHY) {
+    boundingVolumeHierarchy_ =
+        prebuiltHierarchy ? prebuiltHierarchy
+                          : std::make_shared<BoundingVolumeHierarchy>(mesh_);
+  }
+}
+
 void RayTracer::printItself(std::ostream &os) const noexcept {
   os << "Ray Tracer class with model: \n" << *(model_);
+  if (boundingVolumeHierarchy_) {
+    os << "\nAcceleration: " << *boundingVolumeHierarchy_;
+  } else {
+    os << "\nAcceleration: Brute Force";
+  }
 }
 
 RayTracer::TraceResult RayTracer::rayTrace(const core::Ray &ray,
                                            float frequency,
-                                           core::RayHitData *hitData) {
-  bool hit = false;
+                                           core::RayHitData *hitData) const {
   float accumulatedTime = hitData->accumulatedTime;
   core::RayHitData closestHitData;
-  for (objects::TriangleObj triangle : model_->triangles()) {
-    if (triangle.hitObject(ray, frequency, hitData)) {
-      hit = true;
-      if (closestHitData.time > hitData->time) {
-        closestHitData = *hitData;
-      }
-    }
-  }
+  bool hit = boundingVolumeHierarchy_
+                 ? boundingVolumeHierarchy_->closestHit(ray, frequency,
+                                                        &closestHitData)
+                 : closestHitBruteForce(ray, frequency, &closestHitData);
   if (hit) {
     closestHitData.accumulatedTime =
         accumulatedTime + closestHitData.time / constants::kSoundSpeed;
@@ -27,6 +45,31 @@ RayTracer::TraceResult RayTracer::rayTrace(const core::Ray &ray,
   return TraceResult::WENT_OUTSIDE_OF_SIMULATION_SPACE;
 }
 
+bool RayTracer::closestHitBruteForce(const core::Ray &ray, float frequency,
+                                     core::RayHitData *hitData) const {
+  const float origin[3] = {ray.origin().x(), ray.origin().y(),
+                           ray.origin().z()};
+  const float direction[3] = {ray.direction().x(), ray.direction().y(),
+                              ray.direction().z()};
+  int closestTriangle = -1;
+  float closestTime = std::numeric_limits<float>::max();
+  INSTRUMENT_COUNT(TRIANGLE_TESTS, mesh_->size());
+  for (size_t index = 0; index < mesh_->size(); ++index) {
+    float time;
+    if (mesh_->intersect(index, origin, direction, &time) &&
+        time < closestTime) {
+      closestTime = time;
+      closestTriangle = index;
+    }
+  }
+  if (closestTriangle == -1) {
+    return false;
+  }
+  *hitData = core::RayHitData(closestTime, mesh_->normal(closestTriangle), ray,
+                              frequency);
+  return true;
+}
+
 // Returns reflection Ray from hit point stored in |hitData|
 // http://paulbourke.net/geometry/reflected/
 core::Ray RayTracer::getReflected(core::RayHitData *hitData) const {
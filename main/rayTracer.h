@@ -4,23 +4,48 @@
 #include "core/classUtlilities.h"
 #include "core/ray.h"
 #include "core/vec3.h"
+#include "main/boundingVolumeHierarchy.h"
 #include "main/model.h"
 #include "obj/objects.h"
+#include "obj/triangleMesh.h"
+
+#include <memory>
 
 class RayTracer : public Printable {
 public:
-  RayTracer(ModelInterface *model) : model_(model){};
+  // Determines how the closest triangle hit by the ray is searched for.
+  // BRUTE_FORCE tests every triangle of the model and is kept for A/B
+  // comparison with BOUNDING_VOLUME_HIERARCHY, which is built once when
+  // RayTracer is constructed. Both return exactly the same hits.
+  // In both cases triangles of the model are compiled into
+  // objects::TriangleMesh, so changes to the model made after the RayTracer
+  // is constructed are not visible to it. When the model already has
+  // ModelInterface::boundingVolumeHierarchy(), its mesh and hierarchy are
+  // used instead of building them again.
+  enum class Acceleration { BRUTE_FORCE, BOUNDING_VOLUME_HIERARCHY };
+
+  RayTracer(ModelInterface *model,
+            Acceleration acceleration =
+                Acceleration::BOUNDING_VOLUME_HIERARCHY);
 
   enum class TraceResult { HIT_TRIANGLE, WENT_OUTSIDE_OF_SIMULATION_SPACE };
   // |hitData| is modified to hold information where ray hit the triangle,
   // or where it went outside the simulation
   [[nodiscard]] TraceResult rayTrace(const core::Ray &ray, float frequency,
-                                     core::RayHitData *hitData);
+                                     core::RayHitData *hitData) const;
   core::Ray getReflected(core::RayHitData *hitdata) const;
   void printItself(std::ostream &os) const noexcept override;
 
+  Acceleration acceleration() const { return acceleration_; }
+
 private:
+  bool closestHitBruteForce(const core::Ray &ray, float frequency,
+                            core::RayHitData *hitData) const;
+
   ModelInterface *model_;
+  Acceleration acceleration_;
+  std::shared_ptr<const objects::TriangleMesh> mesh_;
+  std::shared_ptr<const BoundingVolumeHierarchy> boundingVolumeHierarchy_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "main/referencePlateSolver.h"
+
+#include "main/traceRecorder.h"
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+ReferencePlateSolver::ReferencePlateSolver(float plateSideSize,
+                                           float sphereWallRadius,
+                                           int numOfSamplesAlongEachAxis)
+    : plateSideSize_(plateSideSize), sphereWallRadius_(sphereWallRadius),
+      numOfSamplesAlongEachAxis_(numOfSamplesAlongEachAxis) {
+  if (!(plateSideSize > 0) || !(sphereWallRadius > 0) ||
+      numOfSamplesAlongEachAxis <= 0) {
+    std::stringstream errorStream;
+    errorStream << "Plate side size, sphere wall radius and number of samples "
+                   "of ReferencePlateSolver must be greater than 0! Given: "
+                << plateSideSize << ", " << sphereWallRadius << ", "
+                << numOfSamplesAlongEachAxis;
+    throw std::invalid_argument(errorStream.str());
+  }
+}
+
+void ReferencePlateSolver::collectEnergy(
+    const core::Vec3 &origin, float sourcePower, float targetSideSize,
+    float targetHeight, const std::vector<float> &frequencies,
+    const std::vector<Collectors *> &collectors,
+    collectionRules::CollectEnergyInterface *energyCollectionRules) const {
+  timeline::ScopedSpan span("ReferencePlateSolver::collectEnergy");
+  if (frequencies.empty() || frequencies.size() != collectors.size()) {
+    std::stringstream errorStream;
+    errorStream << "ReferencePlateSolver needs collectors for every "
+                   "frequency! Number of frequencies: "
+                << frequencies.size()
+                << ", number of collectors: " << collectors.size();
+    throw std::invalid_argument(errorStream.str());
+  }
+  if (!(targetSideSize > 0) || origin.z() <= std::max(targetHeight, 0.0f)) {
+    std::stringstream errorStream;
+    errorStream << "Source of ReferencePlateSolver must be above the target "
+                   "square of positive size! Origin: "
+                << origin << ", target side size: " << targetSideSize
+                << ", target height: " << targetHeight;
+    throw std::invalid_argument(errorStream.str());
+  }
+
+  // Source spreads its power uniformly over the target square. Plate is
+  // parallel to it, so power per area of the plate is uniform as well,
+  // scaled by the squared ratio of distances of both planes from the source.
+  const float scale = (origin.z() - targetHeight) / origin.z();
+  const float cellSize = 2 * plateSideSize_ / numOfSamplesAlongEachAxis_;
+  const float energyPerCell = sourcePower /
+                              (4 * targetSideSize * targetSideSize) * scale *
+                              scale * cellSize * cellSize;
+
+  objects::SphereWall sphereWall(sphereWallRadius_);
+  std::vector<CollectorsIndex> collectorsIndices;
+  collectorsIndices.reserve(collectors.size());
+  for (const Collectors *frequencyCollectors : collectors) {
+    collectorsIndices.emplace_back(*frequencyCollectors);
+  }
+
+  for (int yIndex = 0; yIndex < numOfSamplesAlongEachAxis_; ++yIndex) {
+    for (int xIndex = 0; xIndex < numOfSamplesAlongEachAxis_; ++xIndex) {
+      const core::Vec3 platePoint(-plateSideSize_ + (xIndex + 0.5f) * cellSize,
+                                  -plateSideSize_ + (yIndex + 0.5f) * cellSize,
+                                  0);
+      const core::Vec3 incident = platePoint - origin;
+      // Point where the incident ray crosses the plane of the targets, the
+      // plate receives energy only from rays aimed at the target square.
+      const core::Vec3 target = origin + scale * incident;
+      if (std::abs(target.x()) > targetSideSize ||
+          std::abs(target.y()) > targetSideSize) {
+        continue;
+      }
+
+      const core::Ray reflected(
+          platePoint, core::Vec3(incident.x(), incident.y(), -incident.z()),
+          energyPerCell);
+      core::RayHitData hitData;
+      if (!sphereWall.hitObject(reflected, frequencies.front(), &hitData)) {
+        continue;
+      }
+      hitData.accumulatedTime =
+          (incident.magnitude() + hitData.time) / constants::kSoundSpeed;
+      for (size_t frequencyIndex = 0; frequencyIndex < frequencies.size();
+           ++frequencyIndex) {
+        core::RayHitData frequencyHitData = hitData;
+        frequencyHitData.frequency = frequencies[frequencyIndex];
+        energyCollectionRules->collectEnergy(*collectors[frequencyIndex],
+                                             collectorsIndices[frequencyIndex],
+                                             &frequencyHitData);
+      }
+    }
+  }
+}
+
+void ReferencePlateSolver::printItself(std::ostream &os) const noexcept {
+  os << "Reference Plate Solver, plate side size: " << plateSideSize_
+     << ", sphere wall radius: " << sphereWallRadius_
+     << ", samples along each axis: " << numOfSamplesAlongEachAxis_;
+}
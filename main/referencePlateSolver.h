@@ -0,0 +1,54 @@
+#ifndef REFERENCE_PLATE_SOLVER_H
+#define REFERENCE_PLATE_SOLVER_H
+
+#include "core/classUtlilities.h"
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "main/collectorsIndex.h"
+#include "main/simulator.h"
+#include "obj/objects.h"
+
+#include <vector>
+
+// Deterministic solver of the flat reference plate created by
+// Model::NewReferenceModel(). Every ray of a point source above the plate
+// reflects exactly once and leaves the simulation through the sphere wall,
+// so instead of tracing rays, energy reflected by the plate is integrated
+// over the plate with the midpoint rule: the plate is divided into
+// |numOfSamplesAlongEachAxis|^2 cells and every cell reflects energy that
+// source puts on it along a closed-form path. Energy reaching the sphere wall
+// is passed to the collection rules as in Simulator, so results converge to
+// the traced results of infinitely many rays and have no sampling noise of
+// the ray grid.
+// |plateSideSize| is half of the side of the plate at z = 0 and
+// |sphereWallRadius| radius of the sphere wall centered at the plate. Both
+// and |numOfSamplesAlongEachAxis| must be greater than 0.
+class ReferencePlateSolver : public Printable {
+public:
+  static const int kDefaultNumOfSamplesAlongEachAxis = 512;
+
+  ReferencePlateSolver(
+      float plateSideSize, float sphereWallRadius,
+      int numOfSamplesAlongEachAxis = kDefaultNumOfSamplesAlongEachAxis);
+
+  // Collects energy of the point source at |origin|, which spreads
+  // |sourcePower| uniformly over the square of half side |targetSideSize|,
+  // centered at z axis at |targetHeight|, as generators::PointSpeakerRayFactory
+  // and generators::SobolRayFactory do. Energy is collected by
+  // |energyCollectionRules| into |collectors|[i] for |frequencies|[i].
+  // Source must be above both the target square and the plate.
+  void collectEnergy(
+      const core::Vec3 &origin, float sourcePower, float targetSideSize,
+      float targetHeight, const std::vector<float> &frequencies,
+      const std::vector<Collectors *> &collectors,
+      collectionRules::CollectEnergyInterface *energyCollectionRules) const;
+
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  float plateSideSize_;
+  float sphereWallRadius_;
+  int numOfSamplesAlongEachAxis_;
+};
+
+#endif
@@ -1,5 +1,79 @@
 #include "resultsCalculation.h"
 
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Creates wave from |numOfBins| consecutive |bins|. Trailing bins without
+// energy are skipped, so the wave ends at the last collected sample.
+WaveObject createWave(int sampleRate, const float *bins, size_t numOfBins) {
+  while (numOfBins > 0 && bins[numOfBins - 1] == 0) {
+    --numOfBins;
+  }
+  return WaveObject(sampleRate, std::vector<float>(bins, bins + numOfBins));
+}
+
+// Returns sum of |numOfSamples| consecutive |samples|. Partial sums of the
+// lanes do not depend on each other, so the compiler can keep them in a
+// single vector register.
+float sumOfSamples(const float *samples, size_t numOfSamples) {
+  constexpr size_t kNumOfLanes = 8;
+  std::array<float, kNumOfLanes> partialSums{};
+  size_t sampleIndex = 0;
+  for (; sampleIndex + kNumOfLanes <= numOfSamples;
+       sampleIndex += kNumOfLanes) {
+    for (size_t lane = 0; lane < kNumOfLanes; ++lane) {
+      partialSums[lane] += samples[sampleIndex + lane];
+    }
+  }
+  float sum = 0;
+  for (; sampleIndex < numOfSamples; ++sampleIndex) {
+    sum += samples[sampleIndex];
+  }
+  for (float partialSum : partialSums) {
+    sum += partialSum;
+  }
+  return sum;
+}
+
+// Trapezoid Integral calculation:
+// https://en.wikipedia.org/wiki/Trapezoidal_rule
+// Every inner sample is counted twice by the neighbouring trapezoids, so the
+// integral is equal to dt * (sum of samples - (first + last) / 2).
+float integrateSamples(const float *samples, size_t numOfSamples,
+                       int sampleRate) {
+  if (numOfSamples < 2) {
+    return 0;
+  }
+  const float kDt = 1.0f / sampleRate;
+  return kDt * (sumOfSamples(samples, numOfSamples) -
+                (samples[0] + samples[numOfSamples - 1]) / 2.0f);
+}
+
+// Returns sound pressure levels of every collector at |frequencyIndex| of
+// |energies|. Waves end at their last collected sample, as in createWave().
+std::vector<float> soundPressureLevels(const EnergyTensor &energies,
+                                       size_t frequencyIndex) {
+  std::vector<float> levels;
+  levels.reserve(energies.numOfCollectors());
+  for (size_t collectorIndex = 0; collectorIndex < energies.numOfCollectors();
+       ++collectorIndex) {
+    const float *bins = energies.bins(frequencyIndex, collectorIndex);
+    size_t numOfBins = energies.numOfBins();
+    while (numOfBins > 0 && bins[numOfBins - 1] == 0) {
+      --numOfBins;
+    }
+    levels.push_back(convertPressureToDecibels(
+        integrateSamples(bins, numOfBins, energies.sampleRate())));
+  }
+  return levels;
+}
+
+} // namespace
+
 float convertPressureToDecibels(float pressure) {
   return pressure > 0 ? (120 + 10 * std::log10(pressure)) : 0.0f;
 }
@@ -8,18 +82,24 @@ u_int64_t WaveObject::getTimeIndex(float time) const {
   return std::floor(time * sampleRate_);
 }
 
-float WaveObject::getTotalPressure() const {
-  // Trapezoid Integral calculation:
-  // https://en.wikipedia.org/wiki/Trapezoidal_rule
-  const float kDt = 1.0f / sampleRate_;
-  float total = 0;
-  for (size_t sampleIndex = 1; sampleIndex < length(); ++sampleIndex) {
-    float t0 = static_cast<float>(sampleIndex) / sampleRate_;
-    float t1 = static_cast<float>(sampleIndex - 1) / sampleRate_;
-    total += kDt * (getEnergyAtTime(t0) + getEnergyAtTime(t1)) / 2.0f;
+WaveObject WaveObject::Preallocated(int sampleRate, float maxTime) {
+  if (maxTime < 0) {
+    std::stringstream errorStream;
+    errorStream << "Maximum time of the WaveObject cannot be less then 0! "
+                << "Given Time: " << maxTime << "s.";
+    throw std::invalid_argument(errorStream.str());
   }
+  WaveObject wave(sampleRate);
+  wave.data_.reserve(wave.getTimeIndex(maxTime) + 1);
+  return wave;
+}
+
+float WaveObject::getTotalPressure() const {
+  return convertPressureToDecibels(getIntegratedEnergy());
+}
 
-  return (total > 0) ? (120 + 10 * std::log10(total)) : 0;
+float WaveObject::getIntegratedEnergy() const {
+  return integrateSamples(data_.data(), data_.size(), sampleRate_);
 }
 
 std::vector<float>
@@ -33,6 +113,58 @@ calculateSoundPressureLevels(const std::vector<WaveObject> &waveObjects) {
   return soundPressureLevels;
 }
 
+std::vector<std::vector<float>>
+calculateSoundPressureLevels(const EnergyTensor &energies) {
+  std::vector<std::vector<float>> levels;
+  levels.reserve(energies.numOfFrequencies());
+  for (size_t frequencyIndex = 0; frequencyIndex < energies.numOfFrequencies();
+       ++frequencyIndex) {
+    levels.push_back(soundPressureLevels(energies, frequencyIndex));
+  }
+  return levels;
+}
+
+std::map<float, float> normalizedDiffusionCoefficients(
+    const std::map<float, float> &diffusionCoefficients,
+    const std::map<float, float> &referenceDiffusionCoefficients) {
+  std::map<float, float> output;
+  for (const auto &[frequency, coefficient] : diffusionCoefficients) {
+    auto reference = referenceDiffusionCoefficients.find(frequency);
+    if (reference == referenceDiffusionCoefficients.end() ||
+        diffusionCoefficients.size() !=
+            referenceDiffusionCoefficients.size()) {
+      std::stringstream errorStream;
+      errorStream << "Reference diffusion coefficients must have the same "
+                     "frequencies as the normalized ones! Frequency: "
+                  << frequency;
+      throw std::invalid_argument(errorStream.str());
+    }
+    output[frequency] =
+        (coefficient - reference->second) / (1 - reference->second);
+  }
+  return output;
+}
+
+float jackknifeStandardError(const std::vector<float> &leaveOneOutStatistics) {
+  const size_t numOfSamples = leaveOneOutStatistics.size();
+  if (numOfSamples < 2) {
+    std::stringstream errorStream;
+    errorStream << "Jackknife needs at least 2 samples! Given: "
+                << numOfSamples;
+    throw std::invalid_argument(errorStream.str());
+  }
+  double mean = 0;
+  for (float statistic : leaveOneOutStatistics) {
+    mean += statistic;
+  }
+  mean /= numOfSamples;
+  double sumOfSquares = 0;
+  for (float statistic : leaveOneOutStatistics) {
+    sumOfSquares += (statistic - mean) * (statistic - mean);
+  }
+  return std::sqrt((numOfSamples - 1) * sumOfSquares / numOfSamples);
+}
+
 float WaveObject::getEnergyAtTime(float time) const {
   u_int64_t timeIndex = getTimeIndex(time);
   if (timeIndex >= data_.size() || timeIndex < 0) {
@@ -71,37 +203,158 @@ void WaveObject::printItself(std::ostream &os) const noexcept {
      << "Data size: " << length();
 }
 
+EnergyTensor::EnergyTensor(const std::vector<float> &frequencies,
+                           size_t numOfCollectors, size_t numOfBins,
+                           int sampleRate)
+    : frequencies_(frequencies), numOfCollectors_(numOfCollectors),
+      numOfBins_(numOfBins), sampleRate_(sampleRate),
+      data_(frequencies.size() * numOfCollectors * numOfBins, 0) {}
+
+EnergyTensor EnergyTensor::FromCollectors(
+    const std::unordered_map<float, Collectors> &collectors) {
+  std::vector<float> frequencies;
+  for (const auto &[frequency, frequencyCollectors] : collectors) {
+    frequencies.push_back(frequency);
+  }
+  std::sort(frequencies.begin(), frequencies.end());
+
+  std::stringstream errorStream;
+  size_t numOfCollectors = 0;
+  int endBin = 0;
+  const objects::EnergyHistogram *binning = nullptr;
+  if (!frequencies.empty()) {
+    numOfCollectors = collectors.at(frequencies.front()).size();
+  }
+  for (float frequency : frequencies) {
+    const Collectors &frequencyCollectors = collectors.at(frequency);
+    if (frequencyCollectors.size() != numOfCollectors) {
+      errorStream << "Frequency " << frequency << " has "
+                  << frequencyCollectors.size() << " collectors, expected "
+                  << numOfCollectors << "\n";
+    }
+    for (const auto &collector : frequencyCollectors) {
+      const objects::EnergyHistogram &energy = collector->getEnergy();
+      if (binning == nullptr) {
+        binning = &energy;
+      } else if (!binning->sameBinning(energy)) {
+        errorStream << "Collectors have different binning: " << *binning
+                    << " and " << energy << "\n";
+      }
+      // Histogram may store bins without energy at the end of its range.
+      int lastBin = energy.endBin() - 1;
+      while (lastBin >= energy.firstBin() && energy.at(lastBin) == 0) {
+        --lastBin;
+      }
+      endBin = std::max(endBin, lastBin + 1);
+    }
+  }
+  std::string errorMessage = errorStream.str();
+  if (!errorMessage.empty()) {
+    std::stringstream errorInfo;
+    errorInfo << "Cannot create EnergyTensor from collectors!\n"
+              << errorMessage;
+    throw std::invalid_argument(errorInfo.str());
+  }
+
+  int sampleRate =
+      binning != nullptr ? binning->sampleRate() : objects::kDefaultSampleRate;
+  EnergyTensor tensor(frequencies, numOfCollectors, endBin, sampleRate);
+  for (size_t frequencyIndex = 0; frequencyIndex < frequencies.size();
+       ++frequencyIndex) {
+    const Collectors &frequencyCollectors =
+        collectors.at(frequencies[frequencyIndex]);
+    for (size_t collectorIndex = 0; collectorIndex < numOfCollectors;
+         ++collectorIndex) {
+      const objects::EnergyHistogram &energy =
+          frequencyCollectors[collectorIndex]->getEnergy();
+      // Trailing bins without energy are not part of the tensor.
+      for (int binIndex = energy.firstBin();
+           binIndex < std::min(energy.endBin(), endBin); ++binIndex) {
+        tensor.at(frequencyIndex, collectorIndex, binIndex) =
+            energy.at(binIndex);
+      }
+    }
+  }
+  return tensor;
+}
+
+size_t EnergyTensor::frequencyIndex(float frequency) const {
+  auto it = std::find(frequencies_.cbegin(), frequencies_.cend(), frequency);
+  if (it == frequencies_.cend()) {
+    std::stringstream errorStream;
+    errorStream << "Frequency " << frequency << " not found in " << *this;
+    throw std::out_of_range(errorStream.str());
+  }
+  return it - frequencies_.cbegin();
+}
+
+void EnergyTensor::printItself(std::ostream &os) const noexcept {
+  os << "Energy Tensor of " << numOfFrequencies() << " frequencies x "
+     << numOfCollectors_ << " collectors x " << numOfBins_
+     << " bins, sample rate: " << sampleRate_ << " Hz";
+}
+
 std::vector<WaveObject> WaveObjectFactory::createWaveObjectsFromCollectors(
     const Collectors &collectors) {
   std::vector<WaveObject> output;
   output.reserve(collectors.size());
 
   for (auto &collector : collectors) {
-    WaveObject wave(sampleRate_);
-    for (auto energyPerTimeIt = collector->getEnergy().cbegin();
-         energyPerTimeIt != collector->getEnergy().cend(); ++energyPerTimeIt) {
-      wave.addEnergyAtTime(energyPerTimeIt->first, energyPerTimeIt->second);
+    const objects::EnergyHistogram &energy = collector->getEnergy();
+    checkSampleRate(energy.sampleRate());
+    std::vector<float> bins(energy.endBin(), 0);
+    for (int binIndex = energy.firstBin(); binIndex < energy.endBin();
+         ++binIndex) {
+      bins[binIndex] = energy.at(binIndex);
     }
+    output.push_back(createWave(sampleRate_, bins.data(), bins.size()));
+  }
+  return output;
+}
 
-    output.push_back(wave);
+std::vector<WaveObject>
+WaveObjectFactory::createWaveObjects(const EnergyTensor &energies,
+                                     size_t frequencyIndex) const {
+  checkSampleRate(energies.sampleRate());
+  std::vector<WaveObject> output;
+  output.reserve(energies.numOfCollectors());
+  for (size_t collectorIndex = 0; collectorIndex < energies.numOfCollectors();
+       ++collectorIndex) {
+    output.push_back(createWave(sampleRate_,
+                                energies.bins(frequencyIndex, collectorIndex),
+                                energies.numOfBins()));
   }
   return output;
 }
 
-std::map<float, float> ResultInterface::getResults(
-    const std::unordered_map<float, Collectors> &energyCollectorsPerFrequency)
-    const {
-  std::map<float, float> calculatedParameterVectorInTime;
-  for (auto it = std::cbegin(energyCollectorsPerFrequency);
-       it != std::cend(energyCollectorsPerFrequency); ++it) {
+void WaveObjectFactory::checkSampleRate(int sampleRate) const {
+  if (sampleRate != sampleRate_) {
+    std::stringstream errorStream;
+    errorStream << "Energy binned with sample rate " << sampleRate
+                << " Hz given to WaveObjectFactory with sample rate "
+                << sampleRate_ << " Hz!";
+    throw std::invalid_argument(errorStream.str());
+  }
+}
 
-    float frequency = it->first;
+std::map<float, float>
+ResultInterface::getResults(const EnergyTensor &energies) const {
+  std::map<float, float> calculatedParameterVectorInTime;
+  for (size_t frequencyIndex = 0; frequencyIndex < energies.numOfFrequencies();
+       ++frequencyIndex) {
     calculatedParameterVectorInTime.insert(
-        std::make_pair(frequency, calculateParameter(it->second)));
+        std::make_pair(energies.frequencies()[frequencyIndex],
+                       calculateParameter(energies, frequencyIndex)));
   }
   return calculatedParameterVectorInTime;
 }
 
+std::map<float, float> ResultInterface::getResults(
+    const std::unordered_map<float, Collectors> &energyCollectorsPerFrequency)
+    const {
+  return getResults(EnergyTensor::FromCollectors(energyCollectorsPerFrequency));
+}
+
 void ResultInterface::printItself(std::ostream &os) const noexcept {
   os << getName();
 }
@@ -110,16 +363,12 @@ std::string_view ResultInterface::getName() const noexcept {
   return "Acoustic Parameter Interface Class";
 }
 
-float DiffusionCoefficient::calculateParameter(
-    const Collectors &collectors) const {
-
-  std::vector<WaveObject> wavePerEnergyCollector =
-      waveFactory_->createWaveObjectsFromCollectors(collectors);
-
-  std::vector<float> soundPressureLevels =
-      calculateSoundPressureLevels(wavePerEnergyCollector);
+float DiffusionCoefficient::calculateParameter(const EnergyTensor &energies,
+                                               size_t frequencyIndex) const {
 
-  return calculateDiffusionCoefficient(soundPressureLevels);
+  waveFactory_->checkSampleRate(energies.sampleRate());
+  return calculateDiffusionCoefficient(
+      soundPressureLevels(energies, frequencyIndex));
 }
 
 float DiffusionCoefficient::calculateDiffusionCoefficient(
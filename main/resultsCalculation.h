@@ -6,6 +6,8 @@
 
 #include <cmath>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 using Collectors = std::vector<std::unique_ptr<objects::EnergyCollector>>;
 
@@ -18,9 +20,21 @@ float convertPressureToDecibels(float pressure);
 class WaveObject : public Printable {
 public:
   explicit WaveObject(int sampleRate) : sampleRate_(sampleRate){};
+  // Creates empty wave with memory reserved for samples up to |maxTime|, e.g.
+  // time of the longest path of the ray, so adding energy up to that time
+  // never reallocates the data. Throws std::invalid_argument when |maxTime|
+  // is less than 0.
+  static WaveObject Preallocated(int sampleRate, float maxTime);
+  // |data| holds energy of consecutive samples, starting at time 0.
+  WaveObject(int sampleRate, std::vector<float> data)
+      : sampleRate_(sampleRate), data_(std::move(data)){};
   const std::vector<float> &getData() const;
   // return pressure defined in [Pa]
   float getTotalPressure() const;
+  // Returns energy integrated over the whole wave, which getTotalPressure()
+  // converts into [dB]. Samples are integrated directly with the closed form
+  // of the trapezoid rule.
+  float getIntegratedEnergy() const;
 
   float getEnergyAtTime(float time) const;
   void addEnergyAtTime(float time, float energy);
@@ -37,11 +51,72 @@ private:
   std::vector<float> data_;
 };
 
+// Energy collected in the simulation, stored densely as frequency x collector
+// x time bin. Bins of one collector at one frequency are contiguous, bin i
+// holds energy collected between i / sampleRate and (i + 1) / sampleRate
+// seconds.
+class EnergyTensor : public Printable {
+public:
+  EnergyTensor(const std::vector<float> &frequencies, size_t numOfCollectors,
+               size_t numOfBins, int sampleRate);
+
+  // Creates tensor from collectors of every frequency. Frequencies are sorted
+  // in ascending order and number of bins is the smallest one, that contains
+  // every bin with collected energy. Throws std::invalid_argument when
+  // frequencies have different number of collectors or collectors have
+  // different binning.
+  static EnergyTensor
+  FromCollectors(const std::unordered_map<float, Collectors> &collectors);
+
+  float at(size_t frequencyIndex, size_t collectorIndex,
+           size_t binIndex) const {
+    return data_[offset(frequencyIndex, collectorIndex) + binIndex];
+  }
+  float &at(size_t frequencyIndex, size_t collectorIndex, size_t binIndex) {
+    return data_[offset(frequencyIndex, collectorIndex) + binIndex];
+  }
+  // Returns numOfBins() contiguous bins of the collector at the frequency.
+  const float *bins(size_t frequencyIndex, size_t collectorIndex) const {
+    return data_.data() + offset(frequencyIndex, collectorIndex);
+  }
+
+  // Returns index of the given |frequency|. Throws std::out_of_range when
+  // tensor does not contain |frequency|.
+  size_t frequencyIndex(float frequency) const;
+  const std::vector<float> &frequencies() const { return frequencies_; }
+  size_t numOfFrequencies() const { return frequencies_.size(); }
+  size_t numOfCollectors() const { return numOfCollectors_; }
+  size_t numOfBins() const { return numOfBins_; }
+  int sampleRate() const { return sampleRate_; }
+
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  size_t offset(size_t frequencyIndex, size_t collectorIndex) const {
+    return (frequencyIndex * numOfCollectors_ + collectorIndex) * numOfBins_;
+  }
+
+  std::vector<float> frequencies_;
+  size_t numOfCollectors_;
+  size_t numOfBins_;
+  int sampleRate_;
+  std::vector<float> data_;
+};
+
 class WaveObjectFactory {
 public:
   explicit WaveObjectFactory(int sampleRate) : sampleRate_(sampleRate){};
+  // Collectors must bin energy with the sample rate of the factory.
   std::vector<WaveObject>
   createWaveObjectsFromCollectors(const Collectors &collectors);
+  // Creates wave object of every collector at |frequencyIndex| of
+  // |energies|, which must have the sample rate of the factory.
+  std::vector<WaveObject> createWaveObjects(const EnergyTensor &energies,
+                                            size_t frequencyIndex) const;
+
+  // Throws std::invalid_argument when |sampleRate| is not the sample rate of
+  // the factory.
+  void checkSampleRate(int sampleRate) const;
 
 private:
   int sampleRate_;
@@ -49,6 +124,26 @@ private:
 
 std::vector<float>
 calculateSoundPressureLevels(const std::vector<WaveObject> &waveObjectVector);
+// Computes sound pressure levels of every collector at every frequency of
+// |energies| in one pass over its contiguous bins, without creating wave
+// objects. |result|[frequencyIndex][collectorIndex] is equal to the total
+// pressure of the wave created by WaveObjectFactory::createWaveObjects().
+std::vector<std::vector<float>>
+calculateSoundPressureLevels(const EnergyTensor &energies);
+
+// Normalized diffusion coefficient of ISO 17497-2:2012:
+// dn = (d - dref) / (1 - dref), where d is |diffusionCoefficients| of the
+// tested model and dref |referenceDiffusionCoefficients| of the flat
+// reference sample at the same frequency. Throws std::invalid_argument when
+// both do not have the same frequencies.
+std::map<float, float> normalizedDiffusionCoefficients(
+    const std::map<float, float> &diffusionCoefficients,
+    const std::map<float, float> &referenceDiffusionCoefficients);
+
+// Returns jackknife estimate of the standard error of a statistic, given the
+// statistic computed from every subset of samples with one sample left out.
+// Throws std::invalid_argument when there are less than 2 such values.
+float jackknifeStandardError(const std::vector<float> &leaveOneOutStatistics);
 
 // Interface struct for acoustic parameter calculation from function sequence of
 // sound level pressure acquired in simulation.
@@ -60,6 +155,7 @@ struct ResultInterface : public Printable {
   // Calculates desired acoustic parameter in frequency function. Key of the
   // std::unordered_map represents frequency and element value represent
   // value of the calculated acoustic parameter.
+  std::map<float, float> getResults(const EnergyTensor &energies) const;
   std::map<float, float> getResults(const std::unordered_map<float, Collectors>
                                         &energyCollectorsPerFrequency) const;
 
@@ -68,7 +164,9 @@ struct ResultInterface : public Printable {
   void printItself(std::ostream &os) const noexcept override;
 
 protected:
-  virtual float calculateParameter(const Collectors &collectors) const = 0;
+  // Calculates parameter from energies at |frequencyIndex| of |energies|.
+  virtual float calculateParameter(const EnergyTensor &energies,
+                                   size_t frequencyIndex) const = 0;
   WaveObjectFactory *waveFactory_;
 };
 // Diffusion Coefficient is a measure of the uniformity of diffusion for a
@@ -87,15 +185,15 @@ struct DiffusionCoefficient : public ResultInterface {
 
   std::string_view getName() const noexcept override;
 
-  void printItself(std::ostream &os) const noexcept override;
-
-protected:
-  float calculateParameter(const Collectors &collectors) const override;
-
-private:
   // Calculates parameter from given vector of pressures defined in [dB]
   float calculateDiffusionCoefficient(
       const std::vector<float> &soundPressureLevels) const;
+
+  void printItself(std::ostream &os) const noexcept override;
+
+protected:
+  float calculateParameter(const EnergyTensor &energies,
+                           size_t frequencyIndex) const override;
 };
 
 #endif
\ No newline at end of file
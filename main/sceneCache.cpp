@@ -0,0 +1,254 @@
+#include "main/sceneCache.h"
+
+#include "main/mappedFile.h"
+#include "obj/triangleMesh.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+struct CachedTriangle {
+  float points[9];
+  float normal[3];
+  float area;
+};
+
+struct CachedNode {
+  float min[3], max[3];
+  int32_t firstIndex, numOfTriangles;
+};
+
+// Reads consecutive values from the cache file content. Every read fails
+// once the content ends.
+class CacheReader {
+public:
+  explicit CacheReader(std::string_view content)
+      : content_(content), offset_(0) {}
+
+  template <typename T> bool read(T *value) { return read(value, 1); }
+
+  template <typename T> bool read(T *values, size_t count) {
+    if (count > (content_.size() - offset_) / sizeof(T)) {
+      return false;
+    }
+    std::memcpy(values, content_.data() + offset_, count * sizeof(T));
+    offset_ += count * sizeof(T);
+    return true;
+  }
+
+  // Size is checked before the allocation, so broken count never allocates
+  // more memory than the file has.
+  template <typename T> bool read(std::vector<T> *values, uint64_t count) {
+    if (count > (content_.size() - offset_) / sizeof(T)) {
+      return false;
+    }
+    values->resize(count);
+    return read(values->data(), count);
+  }
+
+  bool finished() const { return offset_ == content_.size(); }
+
+private:
+  std::string_view content_;
+  size_t offset_;
+};
+
+template <typename T>
+void write(std::ofstream &file, const T *values, size_t count) {
+  file.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+template <typename T> void write(std::ofstream &file, const T &value) {
+  write(file, &value, 1);
+}
+
+core::Vec3 vecAt(const float *values) {
+  return core::Vec3(values[0], values[1], values[2]);
+}
+
+void storeVec(const core::Vec3 &vec, float *values) {
+  values[0] = vec.x();
+  values[1] = vec.y();
+  values[2] = vec.z();
+}
+
+} // namespace
+
+uint64_t fnv1aHash(std::string_view data) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char character : data) {
+    hash ^= static_cast<unsigned char>(character);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+SceneCache::SceneCache(std::string_view folder)
+    : folder_(folder), numOfHits_(0), numOfMisses_(0) {
+  std::filesystem::create_directories(folder_);
+}
+
+std::unique_ptr<Model> SceneCache::loadModel(std::string_view objPath,
+                                             int numOfThreads) {
+  std::unique_ptr<MappedFile> objFile;
+  // Check if file exist at given path
+  try {
+    objFile = std::make_unique<MappedFile>(objPath);
+  } catch (const std::invalid_argument &e) {
+    std::stringstream errorStream;
+    errorStream << "Invalid path of the .obj \n"
+                << "Path: " << objPath.data();
+    throw std::invalid_argument(errorStream.str());
+  }
+
+  uint64_t hash = fnv1aHash(objFile->content());
+  std::string path = cachePath(objFile->content());
+  std::unique_ptr<Model> model = readModel(path, hash);
+  if (model) {
+    ++numOfHits_;
+    return model;
+  }
+
+  ++numOfMisses_;
+  model = Model::NewFromObjFileContent(objFile->content(), numOfThreads);
+  model->setBoundingVolumeHierarchy(std::make_shared<BoundingVolumeHierarchy>(
+      std::make_shared<objects::TriangleMesh>(model->triangles())));
+  writeModel(path, hash, *model);
+  return model;
+}
+
+std::string SceneCache::cachePath(std::string_view objContent) const {
+  std::stringstream path;
+  path << folder_ << "/" << std::hex << std::setw(16) << std::setfill('0')
+       << fnv1aHash(objContent) << ".scene";
+  return path.str();
+}
+
+std::unique_ptr<Model> SceneCache::readModel(const std::string &path,
+                                             uint64_t hash) const {
+  if (!std::filesystem::exists(path)) {
+    return nullptr;
+  }
+  MappedFile file(path);
+  CacheReader reader(file.content());
+
+  char magic[sizeof(kSceneCacheMagic)];
+  uint32_t version;
+  uint64_t fileHash, numOfTriangles, numOfNodes, numOfIndices;
+  if (!reader.read(magic, sizeof(magic)) ||
+      !std::equal(std::begin(magic), std::end(magic),
+                  std::begin(kSceneCacheMagic)) ||
+      !reader.read(&version) || version != kSceneCacheVersion ||
+      !reader.read(&fileHash) || fileHash != hash ||
+      !reader.read(&numOfTriangles) || !reader.read(&numOfNodes) ||
+      !reader.read(&numOfIndices)) {
+    return nullptr;
+  }
+
+  std::vector<CachedTriangle> cachedTriangles;
+  std::vector<std::vector<float>> meshArrays(
+      objects::TriangleMesh::kNumOfArrays);
+  std::vector<CachedNode> cachedNodes;
+  std::vector<int32_t> triangleIndices;
+  if (!reader.read(&cachedTriangles, numOfTriangles)) {
+    return nullptr;
+  }
+  for (std::vector<float> &array : meshArrays) {
+    if (!reader.read(&array, numOfTriangles)) {
+      return nullptr;
+    }
+  }
+  if (!reader.read(&cachedNodes, numOfNodes) ||
+      !reader.read(&triangleIndices, numOfIndices) || !reader.finished()) {
+    return nullptr;
+  }
+
+  std::vector<objects::TriangleObj> triangles;
+  triangles.reserve(numOfTriangles);
+  for (const CachedTriangle &triangle : cachedTriangles) {
+    triangles.emplace_back(vecAt(triangle.points), vecAt(triangle.points + 3),
+                           vecAt(triangle.points + 6), vecAt(triangle.normal),
+                           triangle.area);
+  }
+  std::vector<BoundingVolumeHierarchy::Node> nodes;
+  nodes.reserve(numOfNodes);
+  for (const CachedNode &cachedNode : cachedNodes) {
+    BoundingVolumeHierarchy::Node node{AxisAlignedBox(), cachedNode.firstIndex,
+                                       cachedNode.numOfTriangles};
+    std::copy(cachedNode.min, cachedNode.min + 3, node.bounds.min);
+    std::copy(cachedNode.max, cachedNode.max + 3, node.bounds.max);
+    nodes.push_back(node);
+  }
+
+  std::shared_ptr<const BoundingVolumeHierarchy> hierarchy;
+  try {
+    hierarchy = std::make_shared<BoundingVolumeHierarchy>(
+        std::make_shared<objects::TriangleMesh>(std::move(meshArrays)),
+        std::move(nodes),
+        std::vector<int>(triangleIndices.begin(), triangleIndices.end()));
+  } catch (const std::invalid_argument &e) {
+    return nullptr;
+  }
+  auto model = std::make_unique<Model>(std::move(triangles));
+  model->setBoundingVolumeHierarchy(std::move(hierarchy));
+  return model;
+}
+
+void SceneCache::writeModel(const std::string &path, uint64_t hash,
+                            const Model &model) const {
+  const BoundingVolumeHierarchy &hierarchy = *model.boundingVolumeHierarchy();
+  // File is written under temporary name and renamed, so other process
+  // never reads partially written file.
+  std::string temporaryPath = path + ".tmp";
+  std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+
+  write(file, kSceneCacheMagic, sizeof(kSceneCacheMagic));
+  write(file, kSceneCacheVersion);
+  write(file, hash);
+  write(file, static_cast<uint64_t>(model.triangles().size()));
+  write(file, static_cast<uint64_t>(hierarchy.nodes().size()));
+  write(file, static_cast<uint64_t>(hierarchy.triangleIndices().size()));
+
+  for (const objects::TriangleObj &triangle : model.triangles()) {
+    CachedTriangle cachedTriangle;
+    storeVec(triangle.point1(), cachedTriangle.points);
+    storeVec(triangle.point2(), cachedTriangle.points + 3);
+    storeVec(triangle.point3(), cachedTriangle.points + 6);
+    storeVec(triangle.normal(), cachedTriangle.normal);
+    cachedTriangle.area = triangle.area();
+    write(file, cachedTriangle);
+  }
+  for (const std::vector<float> *array : hierarchy.mesh()->arrays()) {
+    write(file, array->data(), array->size());
+  }
+  for (const BoundingVolumeHierarchy::Node &node : hierarchy.nodes()) {
+    CachedNode cachedNode;
+    std::copy(node.bounds.min, node.bounds.min + 3, cachedNode.min);
+    std::copy(node.bounds.max, node.bounds.max + 3, cachedNode.max);
+    cachedNode.firstIndex = node.firstIndex;
+    cachedNode.numOfTriangles = node.numOfTriangles;
+    write(file, cachedNode);
+  }
+  std::vector<int32_t> triangleIndices(hierarchy.triangleIndices().begin(),
+                                       hierarchy.triangleIndices().end());
+  write(file, triangleIndices.data(), triangleIndices.size());
+
+  file.close();
+  // Cache is only an optimization, so model is still returned when it cannot
+  // be written.
+  if (!file.good() || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+    std::cout << "WARNING! \n"
+              << "Scene cache could not be written to: " << path << std::endl;
+    std::filesystem::remove(temporaryPath);
+  }
+}
+
+void SceneCache::printItself(std::ostream &os) const noexcept {
+  os << "Scene Cache in: " << folder_ << "\n"
+     << "Hits: " << numOfHits_ << ", misses: " << numOfMisses_ << "\n";
+}
@@ -0,0 +1,65 @@
+#ifndef SCENE_CACHE_H
+#define SCENE_CACHE_H
+
+#include "core/classUtlilities.h"
+#include "main/boundingVolumeHierarchy.h"
+#include "main/model.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Stores models loaded from .obj files as binary files in the cache folder,
+// together with their compiled mesh and bounding volume hierarchy, so loading
+// the same model again only maps the file into memory. Cache file is named
+// after the FNV-1a hash of the .obj content, so modified .obj file never
+// uses stale data.
+//
+// Cache file layout, in native byte order:
+//   char[4] kSceneCacheMagic, uint32 kSceneCacheVersion, uint64 hash,
+//   uint64 number of triangles, nodes and triangle indices,
+//   triangles: 3 points, normal and area of each as 13 floats,
+//   mesh: objects::TriangleMesh::kNumOfArrays arrays of floats,
+//   nodes: bounds min and max as 6 floats, firstIndex and numOfTriangles as
+//   2 int32 each,
+//   triangle indices of the hierarchy: int32 each.
+// Version has to be increased whenever layout or the way data is computed
+// changes.
+class SceneCache : public Printable {
+public:
+  // Creates |folder| if it doesn't exist.
+  explicit SceneCache(std::string_view folder);
+
+  // Returns model from .obj file at |objPath| with bounding volume hierarchy
+  // over its triangles. Cache file is used if it is valid, otherwise .obj
+  // file is parsed by |numOfThreads| threads, as in
+  // Model::NewLoadFromObjectFile(), and cache file is written.
+  std::unique_ptr<Model> loadModel(std::string_view objPath,
+                                   int numOfThreads = 0);
+
+  // Path of the cache file for .obj file with |objContent|.
+  std::string cachePath(std::string_view objContent) const;
+
+  int numOfHits() const { return numOfHits_; }
+  int numOfMisses() const { return numOfMisses_; }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  // Returns nullptr if there is no valid cache file at |path|.
+  std::unique_ptr<Model> readModel(const std::string &path,
+                                   uint64_t hash) const;
+  void writeModel(const std::string &path, uint64_t hash,
+                  const Model &model) const;
+
+  std::string folder_;
+  int numOfHits_, numOfMisses_;
+};
+
+const char kSceneCacheMagic[4] = {'R', 'T', 'S', 'C'};
+const uint32_t kSceneCacheVersion = 1;
+
+// 64-bit FNV-1a hash of |data|.
+uint64_t fnv1aHash(std::string_view data);
+
+#endif
@@ -1,11 +1,72 @@
 #include "main/sceneManager.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <random>
+
+namespace {
+
+// Two-sided 95% quantile of the normal distribution.
+const float kConfidenceZScore = 1.96;
+
+// Diffusion coefficient of energies averaged over batches, where
+// |batchEnergies|[batch][collector] is energy integrated over time. It
+// differs from the coefficient of the summed energies only by the trailing
+// samples of the waves, which is negligible for the confidence interval.
+// Batch at |skippedBatch| is left out, when given.
+float averageDiffusionCoefficient(
+    const DiffusionCoefficient &diffusion,
+    const std::vector<std::vector<double>> &batchEnergies,
+    int skippedBatch = -1) {
+  const size_t numOfCollectors = batchEnergies.front().size();
+  std::vector<float> soundPressureLevels;
+  soundPressureLevels.reserve(numOfCollectors);
+  for (size_t collector = 0; collector < numOfCollectors; ++collector) {
+    double energy = 0;
+    int numOfBatches = 0;
+    for (size_t batch = 0; batch < batchEnergies.size(); ++batch) {
+      if (static_cast<int>(batch) != skippedBatch) {
+        energy += batchEnergies[batch][collector];
+        ++numOfBatches;
+      }
+    }
+    soundPressureLevels.push_back(
+        convertPressureToDecibels(energy / numOfBatches));
+  }
+  return diffusion.calculateDiffusionCoefficient(soundPressureLevels);
+}
+
+const char *rayDistributionName(RayDistribution rayDistribution) {
+  switch (rayDistribution) {
+  case RayDistribution::GRID:
+    return "Grid";
+  case RayDistribution::JITTERED_GRID:
+    return "Jittered Grid";
+  case RayDistribution::SOBOL:
+    return "Sobol";
+  case RayDistribution::PLANE_WAVE:
+    return "Plane Wave";
+  }
+  return "Unknown";
+}
+
+} // namespace
+
+
 BasicSimulationProperties::BasicSimulationProperties(
     const std::vector<float> &frequencies, float sourcePower,
-    int numOfCollectors, int numOfRaysSquared, int maxTracking)
+    int numOfCollectors, int numOfRaysSquared, int maxTracking,
+    int numOfThreads, bool multiFrequencyTracing, int sampleRate,
+    float timeWindow, RayDistribution rayDistribution,
+    Simulator::Execution execution)
     : frequencies(frequencies), sourcePower(sourcePower),
       numOfCollectors(numOfCollectors), numOfRaysSquared(numOfRaysSquared),
-      maxTracking(maxTracking) {
+      maxTracking(maxTracking), numOfThreads(numOfThreads),
+      multiFrequencyTracing(multiFrequencyTracing), sampleRate(sampleRate),
+      timeWindow(timeWindow), rayDistribution(rayDistribution),
+      execution(execution) {
 
   std::stringstream errorStream;
   if (frequencies.empty()) {
@@ -28,6 +89,15 @@ BasicSimulationProperties::BasicSimulationProperties(
   if (maxTracking < 1) {
     errorStream << "Max tracking in: must be greater then 1 \n";
   }
+  if (numOfThreads < 1) {
+    errorStream << "Number of threads must be greater then 0! \n";
+  }
+  if (sampleRate < 1) {
+    errorStream << "Sample rate must be greater then 0! \n";
+  }
+  if (!(timeWindow > 0)) {
+    errorStream << "Time window must be greater then 0! \n";
+  }
   std::string outputErrorMessage = errorStream.str();
   if (!outputErrorMessage.empty()) {
     std::stringstream errorInfo;
@@ -46,20 +116,173 @@ void BasicSimulationProperties::printItself(std::ostream &os) const noexcept {
   os << "\n"
      << "Source Power: " << sourcePower << "\n"
      << "Number Of Collectors: " << numOfCollectors << "\n"
-     << "Number of Rays Squared: " << numOfRaysSquared << "\n";
+     << "Number of Rays Squared: " << numOfRaysSquared << "\n"
+     << "Number of Threads: " << numOfThreads << "\n"
+     << "Multi Frequency Tracing: " << multiFrequencyTracing << "\n"
+     << "Sample Rate: " << sampleRate << " Hz\n"
+     << "Time Window: " << timeWindow << " s\n"
+     << "Ray Distribution: " << rayDistributionName(rayDistribution) << "\n"
+     << "Execution: "
+     << (execution == Simulator::Execution::WAVEFRONT ? "Wavefront"
+                                                       : "Depth First")
+     << "\n";
+}
+
+ProgressiveSimulationProperties::ProgressiveSimulationProperties(
+    float tolerance, int maxNumOfBatches, int minNumOfBatches)
+    : tolerance(tolerance), maxNumOfBatches(maxNumOfBatches),
+      minNumOfBatches(minNumOfBatches) {
+  std::stringstream errorStream;
+  if (!(tolerance > 0)) {
+    errorStream << "Tolerance must be greater then 0! \n";
+  }
+  if (minNumOfBatches < 2) {
+    errorStream << "Min number of batches must be at least 2! \n";
+  }
+  if (maxNumOfBatches < minNumOfBatches) {
+    errorStream << "Max number of batches cannot be less then min number of "
+                   "batches! \n";
+  }
+  std::string outputErrorMessage = errorStream.str();
+  if (!outputErrorMessage.empty()) {
+    std::stringstream errorInfo;
+    errorInfo << "Error detected in: " << *this << "\n" << outputErrorMessage;
+    throw std::invalid_argument(errorInfo.str());
+  }
+}
+
+void ProgressiveSimulationProperties::printItself(
+    std::ostream &os) const noexcept {
+  os << "ProgressiveSimulationProperties data class\n"
+     << "Tolerance: " << tolerance << "\n"
+     << "Max Number Of Batches: " << maxNumOfBatches << "\n"
+     << "Min Number Of Batches: " << minNumOfBatches << "\n";
+}
+
+void FrequencyConvergence::printItself(std::ostream &os) const noexcept {
+  os << "Frequency " << frequency << " Hz: diffusion coefficient "
+     << diffusionCoefficient << " +- " << confidenceHalfWidth << " after "
+     << numOfBatches << " batches, " << numOfRays << " rays"
+     << (converged ? "" : ", not converged");
+}
+
+ProgressiveResults::ProgressiveResults(
+    EnergyTensor energies, std::vector<FrequencyConvergence> convergence)
+    : energies(std::move(energies)), convergence(std::move(convergence)) {}
+
+std::map<float, float> ProgressiveResults::diffusionCoefficients() const {
+  std::map<float, float> output;
+  for (const FrequencyConvergence &frequency : convergence) {
+    output[frequency.frequency] = frequency.diffusionCoefficient;
+  }
+  return output;
+}
+
+std::map<float, float> ProgressiveResults::confidenceHalfWidths() const {
+  std::map<float, float> output;
+  for (const FrequencyConvergence &frequency : convergence) {
+    output[frequency.frequency] = frequency.confidenceHalfWidth;
+  }
+  return output;
+}
+
+std::map<float, float> ProgressiveResults::numOfRays() const {
+  std::map<float, float> output;
+  for (const FrequencyConvergence &frequency : convergence) {
+    output[frequency.frequency] = frequency.numOfRays;
+  }
+  return output;
+}
+
+void ProgressiveResults::printItself(std::ostream &os) const noexcept {
+  os << "Progressive Results\n" << energies;
+  for (const FrequencyConvergence &frequency : convergence) {
+    os << "\n" << frequency;
+  }
+}
+
+SourcePosition::SourcePosition(float incidenceAngle, float azimuthAngle)
+    : incidenceAngle(incidenceAngle), azimuthAngle(azimuthAngle) {
+  if (incidenceAngle < 0 || incidenceAngle >= constants::kPi / 2) {
+    std::stringstream errorStream;
+    errorStream << "Error detected in: " << *this << "\n"
+                << "Incidence angle must be in range [0, pi / 2)! \n";
+    throw std::invalid_argument(errorStream.str());
+  }
+}
+
+void SourcePosition::printItself(std::ostream &os) const noexcept {
+  os << "Source Position, incidence angle: " << incidenceAngle
+     << " rad, azimuth angle: " << azimuthAngle << " rad";
+}
+
+SweepResults::SweepResults(
+    std::vector<SourcePosition> sources, std::vector<EnergyTensor> energies,
+    std::vector<std::map<float, float>> diffusionCoefficients)
+    : sources(std::move(sources)), energies(std::move(energies)),
+      diffusionCoefficients(std::move(diffusionCoefficients)) {}
+
+std::map<float, float> SweepResults::averageDiffusionCoefficients() const {
+  std::map<float, float> output;
+  for (const std::map<float, float> &coefficients : diffusionCoefficients) {
+    for (const auto &[frequency, coefficient] : coefficients) {
+      output[frequency] += coefficient / diffusionCoefficients.size();
+    }
+  }
+  return output;
+}
+
+void SweepResults::printItself(std::ostream &os) const noexcept {
+  os << "Sweep Results";
+  for (size_t source = 0; source < sources.size(); ++source) {
+    os << "\n" << sources[source] << ":";
+    for (const auto &[frequency, coefficient] :
+         diffusionCoefficients[source]) {
+      os << " " << frequency << " Hz: " << coefficient;
+    }
+  }
+}
+
+PairedResults::PairedResults(
+    EnergyTensor energies, EnergyTensor referenceEnergies,
+    std::map<float, float> diffusionCoefficients,
+    std::map<float, float> referenceDiffusionCoefficients)
+    : energies(std::move(energies)),
+      referenceEnergies(std::move(referenceEnergies)),
+      diffusionCoefficients(std::move(diffusionCoefficients)),
+      referenceDiffusionCoefficients(
+          std::move(referenceDiffusionCoefficients)),
+      normalizedDiffusionCoefficients(::normalizedDiffusionCoefficients(
+          this->diffusionCoefficients, this->referenceDiffusionCoefficients)) {}
+
+void PairedResults::printItself(std::ostream &os) const noexcept {
+  os << "Paired Results";
+  for (const auto &[frequency, coefficient] : diffusionCoefficients) {
+    os << "\n"
+       << frequency << " Hz: diffusion coefficient " << coefficient
+       << ", reference " << referenceDiffusionCoefficients.at(frequency)
+       << ", normalized " << normalizedDiffusionCoefficients.at(frequency);
+  }
 }
 
 SimulationProperties::SimulationProperties(
     collectionRules::CollectEnergyInterface *energyCollectionRules,
-    const BasicSimulationProperties &basicSimulationProperties)
+    const BasicSimulationProperties &basicSimulationProperties,
+    const std::vector<const terminationPolicies::TerminationPolicy *>
+        &terminationPolicies)
     : energyCollectionRules_(energyCollectionRules),
-      basicSimulationProperties_(basicSimulationProperties){};
+      basicSimulationProperties_(basicSimulationProperties),
+      terminationPolicies_(terminationPolicies){};
 
 void SimulationProperties::printItself(std::ostream &os) const noexcept {
   os << "SimulationProperties\n"
      << "- Energy collection rules: \n"
      << *(energyCollectionRules_) << "- Basic Simulation Properties: \n"
      << basicSimulationProperties_;
+  for (const terminationPolicies::TerminationPolicy *policy :
+       terminationPolicies_) {
+    os << "\n- Termination policy: " << *policy;
+  }
 }
 
 SceneManager::SceneManager(
@@ -68,8 +291,14 @@ SceneManager::SceneManager(
     trackers::CollectorsTrackerInterface *collectorTracker)
     : model_(model), simulationProperties_(simulationProperties),
       raytracer_(model), positionTracker_(positionTracker),
-      collectorsTracker_(collectorTracker) {
-  offseter_ = std::make_unique<generators::FakeOffseter>();
+      collectorsTracker_(collectorTracker),
+      terminationSavings_(simulationProperties.terminationPolicies()) {
+  offseter_ = createRayOffseter(0);
+  int numOfThreads =
+      simulationProperties_.basicSimulationProperties().numOfThreads;
+  if (numOfThreads > 1) {
+    threadPool_ = std::make_unique<ThreadPool>(numOfThreads);
+  }
 }
 
 void SceneManager::printItself(std::ostream &os) const noexcept {
@@ -82,7 +311,399 @@ void SceneManager::printItself(std::ostream &os) const noexcept {
      << "Offseter: " << *(offseter_);
 }
 
-std::unordered_map<float, Collectors> SceneManager::run() {
+EnergyTensor SceneManager::run() {
+  timeline::ScopedSpan span("SceneManager::run");
+  std::unordered_map<float, Collectors> collectorsPerFrequencies =
+      simulationProperties_.basicSimulationProperties().multiFrequencyTracing
+          ? runAllFrequenciesAtOnce()
+          : runEveryFrequency();
+  return EnergyTensor::FromCollectors(collectorsPerFrequencies);
+}
+
+Collectors SceneManager::createCollectors() const {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  return buildCollectors(model_, basicProperties.numOfCollectors,
+                         basicProperties.sampleRate,
+                         basicProperties.timeWindow);
+}
+
+std::unique_ptr<generators::RayFactory>
+SceneManager::createRaySource(int batch,
+                              const SourcePosition &position) const {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  const int numOfRaysSquared = basicProperties.numOfRaysSquared;
+  const bool isMoved = position.incidenceAngle != 0;
+  // Point source is rotated around the center of the model.
+  auto movedOrigin = [&position](const core::Vec3 &origin) {
+    const float distance = origin.magnitude();
+    const float horizontal = distance * std::sin(position.incidenceAngle);
+    return core::Vec3(horizontal * std::cos(position.azimuthAngle),
+                      horizontal * std::sin(position.azimuthAngle),
+                      distance * std::cos(position.incidenceAngle));
+  };
+  if (basicProperties.rayDistribution == RayDistribution::SOBOL) {
+    // Batches trace consecutive ranges of the sequence.
+    const int numOfRays = numOfRaysSquared * numOfRaysSquared;
+    auto source = std::make_unique<generators::SobolRayFactory>(
+        numOfRays, basicProperties.sourcePower, model_, /*seed=*/0,
+        static_cast<uint32_t>(batch) * numOfRays);
+    if (isMoved) {
+      source->setOrigin(movedOrigin(source->origin()));
+    }
+    return source;
+  }
+  // Batches after the first one shift the grid of rays by a pseudo random
+  // offset.
+  float xGridOffset = 0, yGridOffset = 0;
+  if (batch > 0) {
+    std::mt19937 generator(batch);
+    std::uniform_real_distribution<float> gridOffset(-0.5, 0.5);
+    xGridOffset = gridOffset(generator);
+    yGridOffset = gridOffset(generator);
+  }
+  if (basicProperties.rayDistribution == RayDistribution::PLANE_WAVE) {
+    // Plane wave propagates away from the source position.
+    return std::make_unique<generators::PlaneWaveRayFactory>(
+        numOfRaysSquared, basicProperties.sourcePower, model_,
+        position.incidenceAngle, position.azimuthAngle + constants::kPi,
+        xGridOffset, yGridOffset);
+  }
+  auto source = std::make_unique<generators::PointSpeakerRayFactory>(
+      numOfRaysSquared, basicProperties.sourcePower, model_, xGridOffset,
+      yGridOffset);
+  if (isMoved) {
+    source->setOrigin(movedOrigin(source->origin()));
+  }
+  return source;
+}
+
+std::unique_ptr<generators::RandomRayOffseter>
+SceneManager::createRayOffseter(int batch) const {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  if (basicProperties.rayDistribution != RayDistribution::JITTERED_GRID) {
+    return std::make_unique<generators::FakeOffseter>();
+  }
+  // Every target is jittered inside its cell of the grid, at the height of
+  // the model where PointSpeakerRayFactory aims its rays.
+  generators::PointSpeakerRayFactory grid(basicProperties.numOfRaysSquared,
+                                          basicProperties.sourcePower, model_);
+  return std::make_unique<generators::StratifiedJitterOffseter>(
+      grid.targetSpacing(), model_->height(), /*seed=*/batch);
+}
+
+void SceneManager::traceBatch(
+    const std::vector<float> &frequencies,
+    const std::vector<Collectors *> &collectors,
+    generators::RayFactory *source, generators::RandomRayOffseter *offseter,
+    trackers::PositionTrackerInterface *positionTracker) {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  Simulator simulator(&raytracer_, model_, source, offseter,
+                      positionTracker,
+                      simulationProperties_.energyCollectionRules(),
+                      threadPool_.get(),
+                      simulationProperties_.terminationPolicies(),
+                      basicProperties.execution);
+  if (basicProperties.multiFrequencyTracing) {
+    simulator.run(frequencies, collectors, basicProperties.maxTracking);
+  } else {
+    for (size_t index = 0; index < frequencies.size(); ++index) {
+      simulator.run(frequencies[index], collectors[index],
+                    basicProperties.maxTracking);
+    }
+  }
+  terminationSavings_.add(simulator.terminationSavings());
+}
+
+ProgressiveResults SceneManager::runProgressive(
+    const ProgressiveSimulationProperties &progressiveProperties) {
+  timeline::ScopedSpan span("SceneManager::runProgressive");
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  WaveObjectFactory waveFactory(basicProperties.sampleRate);
+  DiffusionCoefficient diffusion(&waveFactory);
+  trackers::FakePositionTracker batchPositionTracker;
+
+  // Energy of every batch is summed here and averaged at the end.
+  std::unordered_map<float, Collectors> collectorsPerFrequencies;
+  // |batchEnergies|[frequency][batch][collector] holds energy integrated over
+  // time, which is all that diffusion coefficient needs.
+  std::unordered_map<float, std::vector<std::vector<double>>> batchEnergies;
+  std::unordered_map<float, FrequencyConvergence> convergence;
+  for (float frequency : basicProperties.frequencies) {
+    collectorsPerFrequencies.insert(
+        std::make_pair(frequency, createCollectors()));
+  }
+  collectorsTracker_->save(
+      collectorsPerFrequencies.at(basicProperties.frequencies.front()),
+      "./data");
+
+  std::vector<float> activeFrequencies = basicProperties.frequencies;
+  for (int batch = 0; !activeFrequencies.empty(); ++batch) {
+    std::unique_ptr<generators::RayFactory> source = createRaySource(batch);
+    std::unique_ptr<generators::RandomRayOffseter> offseter =
+        createRayOffseter(batch);
+
+    std::vector<Collectors> batchCollectors;
+    batchCollectors.reserve(activeFrequencies.size());
+    std::vector<Collectors *> collectors;
+    for (size_t index = 0; index < activeFrequencies.size(); ++index) {
+      collectors.push_back(&batchCollectors.emplace_back(createCollectors()));
+    }
+    {
+      timeline::ScopedSpan batchSpan(
+          "SceneManager::traceBatch",
+          {{"batch", batch}, {"numOfFrequencies", activeFrequencies.size()}});
+      traceBatch(activeFrequencies, collectors, source.get(), offseter.get(),
+                 &batchPositionTracker);
+    }
+
+    std::vector<float> stillActiveFrequencies;
+    for (size_t index = 0; index < activeFrequencies.size(); ++index) {
+      const float frequency = activeFrequencies[index];
+      std::vector<double> &energies =
+          batchEnergies[frequency].emplace_back();
+      std::vector<WaveObject> waves =
+          waveFactory.createWaveObjectsFromCollectors(batchCollectors[index]);
+      for (const WaveObject &wave : waves) {
+        energies.push_back(wave.getIntegratedEnergy());
+      }
+      Collectors &targetCollectors = collectorsPerFrequencies.at(frequency);
+      for (size_t collector = 0; collector < targetCollectors.size();
+           ++collector) {
+        targetCollectors[collector]->addEnergy(
+            batchCollectors[index][collector]->getEnergy());
+      }
+
+      const std::vector<std::vector<double>> &frequencyEnergies =
+          batchEnergies[frequency];
+      const int numOfBatches = frequencyEnergies.size();
+      FrequencyConvergence &result = convergence[frequency];
+      result.frequency = frequency;
+      result.confidenceHalfWidth = std::numeric_limits<float>::infinity();
+      if (numOfBatches >= 2) {
+        std::vector<float> leaveOneOut;
+        for (int skipped = 0; skipped < numOfBatches; ++skipped) {
+          leaveOneOut.push_back(averageDiffusionCoefficient(
+              diffusion, frequencyEnergies, skipped));
+        }
+        result.confidenceHalfWidth =
+            kConfidenceZScore * jackknifeStandardError(leaveOneOut);
+      }
+      result.numOfBatches = numOfBatches;
+      result.numOfRays =
+          static_cast<int64_t>(numOfBatches) * source->numOfRays();
+      result.converged =
+          numOfBatches >= progressiveProperties.minNumOfBatches &&
+          result.confidenceHalfWidth <= progressiveProperties.tolerance;
+      if (!result.converged &&
+          numOfBatches < progressiveProperties.maxNumOfBatches) {
+        stillActiveFrequencies.push_back(frequency);
+      }
+    }
+    activeFrequencies = std::move(stillActiveFrequencies);
+  }
+
+  EnergyTensor energies =
+      EnergyTensor::FromCollectors(collectorsPerFrequencies);
+  std::vector<FrequencyConvergence> frequenciesConvergence;
+  for (size_t frequencyIndex = 0; frequencyIndex < energies.numOfFrequencies();
+       ++frequencyIndex) {
+    const FrequencyConvergence &result =
+        convergence.at(energies.frequencies()[frequencyIndex]);
+    frequenciesConvergence.push_back(result);
+    for (size_t collector = 0; collector < energies.numOfCollectors();
+         ++collector) {
+      for (size_t bin = 0; bin < energies.numOfBins(); ++bin) {
+        energies.at(frequencyIndex, collector, bin) /= result.numOfBatches;
+      }
+    }
+  }
+  // Reported coefficients are calculated from the averaged energies, exactly
+  // as run() results are.
+  std::map<float, float> diffusionCoefficients = diffusion.getResults(energies);
+  for (FrequencyConvergence &result : frequenciesConvergence) {
+    result.diffusionCoefficient = diffusionCoefficients.at(result.frequency);
+  }
+  return ProgressiveResults(std::move(energies),
+                            std::move(frequenciesConvergence));
+}
+
+size_t SceneManager::addTracingJobs(RayTracer *tracer,
+                                    generators::RayFactory *source,
+                                    std::vector<TracingJob> *jobs) const {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  std::vector<std::vector<float>> jobFrequencies;
+  if (basicProperties.multiFrequencyTracing) {
+    jobFrequencies.push_back(basicProperties.frequencies);
+  } else {
+    for (float frequency : basicProperties.frequencies) {
+      jobFrequencies.push_back({frequency});
+    }
+  }
+  const size_t firstJob = jobs->size();
+  for (std::vector<float> &frequencies : jobFrequencies) {
+    TracingJob job{tracer, source, std::move(frequencies), {},
+                   terminationPolicies::TerminationSavings(
+                       simulationProperties_.terminationPolicies())};
+    for (size_t index = 0; index < job.frequencies.size(); ++index) {
+      job.collectors.push_back(createCollectors());
+    }
+    jobs->push_back(std::move(job));
+  }
+  return firstJob;
+}
+
+void SceneManager::runTracingJobs(std::vector<TracingJob> *jobs) {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  const int maxTracking = basicProperties.maxTracking;
+  const Simulator::Execution execution = basicProperties.execution;
+  auto runJob = [this, maxTracking, execution](TracingJob *job) {
+    timeline::ScopedSpan jobSpan(
+        "SceneManager::runTracingJob",
+        {{"numOfFrequencies", job->frequencies.size()}});
+    trackers::FakePositionTracker positionTracker;
+    // Sphere wall is determined by the tested model for every job, so the
+    // reference model is traced in the same simulation space.
+    Simulator simulator(job->tracer, model_, job->source, offseter_.get(),
+                        &positionTracker,
+                        simulationProperties_.energyCollectionRules(),
+                        /*threadPool=*/nullptr,
+                        simulationProperties_.terminationPolicies(),
+                        execution);
+    std::vector<Collectors *> collectors;
+    for (Collectors &frequencyCollectors : job->collectors) {
+      collectors.push_back(&frequencyCollectors);
+    }
+    simulator.run(job->frequencies, collectors, maxTracking);
+    job->savings.add(simulator.terminationSavings());
+  };
+  if (threadPool_) {
+    for (TracingJob &job : *jobs) {
+      threadPool_->schedule([&runJob, &job] { runJob(&job); });
+    }
+    threadPool_->wait();
+  } else {
+    for (TracingJob &job : *jobs) {
+      runJob(&job);
+    }
+  }
+  for (const TracingJob &job : *jobs) {
+    terminationSavings_.add(job.savings);
+  }
+}
+
+EnergyTensor SceneManager::collectJobEnergies(std::vector<TracingJob> *jobs,
+                                              size_t firstJob,
+                                              size_t numOfJobs) {
+  std::unordered_map<float, Collectors> collectorsPerFrequencies;
+  for (size_t jobIndex = firstJob; jobIndex < firstJob + numOfJobs;
+       ++jobIndex) {
+    TracingJob &job = (*jobs)[jobIndex];
+    for (size_t index = 0; index < job.frequencies.size(); ++index) {
+      collectorsPerFrequencies.insert(std::make_pair(
+          job.frequencies[index], std::move(job.collectors[index])));
+    }
+  }
+  return EnergyTensor::FromCollectors(collectorsPerFrequencies);
+}
+
+SweepResults
+SceneManager::runSweep(const std::vector<SourcePosition> &sources) {
+  timeline::ScopedSpan span("SceneManager::runSweep",
+                            {{"numOfSources", sources.size()}});
+  if (sources.empty()) {
+    throw std::invalid_argument("Sweep needs at least one source position!");
+  }
+
+  std::vector<std::unique_ptr<generators::RayFactory>> raySources;
+  std::vector<TracingJob> jobs;
+  std::vector<size_t> firstJobs;
+  for (const SourcePosition &position : sources) {
+    raySources.push_back(createRaySource(0, position));
+    firstJobs.push_back(
+        addTracingJobs(&raytracer_, raySources.back().get(), &jobs));
+  }
+  collectorsTracker_->save(jobs.front().collectors.front(), "./data");
+  runTracingJobs(&jobs);
+
+  const size_t numOfJobsPerSource = jobs.size() / sources.size();
+  WaveObjectFactory waveFactory(
+      simulationProperties_.basicSimulationProperties().sampleRate);
+  DiffusionCoefficient diffusion(&waveFactory);
+  std::vector<EnergyTensor> energies;
+  std::vector<std::map<float, float>> diffusionCoefficients;
+  for (size_t firstJob : firstJobs) {
+    const EnergyTensor &sourceEnergies = energies.emplace_back(
+        collectJobEnergies(&jobs, firstJob, numOfJobsPerSource));
+    diffusionCoefficients.push_back(diffusion.getResults(sourceEnergies));
+  }
+  return SweepResults(sources, std::move(energies),
+                      std::move(diffusionCoefficients));
+}
+
+PairedResults
+SceneManager::runWithReference(ReferenceSolver referenceSolver) {
+  timeline::ScopedSpan span("SceneManager::runWithReference");
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  if (referenceSolver == ReferenceSolver::ANALYTIC &&
+      basicProperties.rayDistribution == RayDistribution::PLANE_WAVE) {
+    throw std::invalid_argument(
+        "Analytic reference solver does not support plane wave sources!");
+  }
+  std::unique_ptr<Model> referenceModel =
+      Model::NewReferenceModel(model_->sideSize());
+  RayTracer referenceTracer(referenceModel.get());
+
+  // Both models are traced with the source built for the tested one.
+  std::unique_ptr<generators::RayFactory> source = createRaySource(0);
+  std::vector<TracingJob> jobs;
+  addTracingJobs(&raytracer_, source.get(), &jobs);
+  const size_t firstReferenceJob = jobs.size();
+  if (referenceSolver == ReferenceSolver::TRACED) {
+    addTracingJobs(&referenceTracer, source.get(), &jobs);
+  }
+  collectorsTracker_->save(jobs.front().collectors.front(), "./data");
+  runTracingJobs(&jobs);
+
+  EnergyTensor energies = collectJobEnergies(&jobs, 0, firstReferenceJob);
+  std::optional<EnergyTensor> referenceEnergies;
+  if (referenceSolver == ReferenceSolver::TRACED) {
+    referenceEnergies = collectJobEnergies(&jobs, firstReferenceJob,
+                                           jobs.size() - firstReferenceJob);
+  } else {
+    std::unordered_map<float, Collectors> collectorsPerFrequencies;
+    std::vector<Collectors *> collectors;
+    for (float frequency : basicProperties.frequencies) {
+      collectors.push_back(
+          &collectorsPerFrequencies.emplace(frequency, createCollectors())
+               .first->second);
+    }
+    ReferencePlateSolver solver(model_->sideSize(),
+                                getSphereWallRadius(*model_));
+    solver.collectEnergy(source->origin(), basicProperties.sourcePower,
+                         model_->sideSize(), model_->height(),
+                         basicProperties.frequencies, collectors,
+                         simulationProperties_.energyCollectionRules());
+    referenceEnergies = EnergyTensor::FromCollectors(collectorsPerFrequencies);
+  }
+  WaveObjectFactory waveFactory(basicProperties.sampleRate);
+  DiffusionCoefficient diffusion(&waveFactory);
+  std::map<float, float> diffusionCoefficients = diffusion.getResults(energies);
+  std::map<float, float> referenceDiffusionCoefficients =
+      diffusion.getResults(*referenceEnergies);
+  return PairedResults(std::move(energies), std::move(*referenceEnergies),
+                       std::move(diffusionCoefficients),
+                       std::move(referenceDiffusionCoefficients));
+}
+
+std::unordered_map<float, Collectors> SceneManager::runEveryFrequency() {
   std::vector<float> frequencies =
       simulationProperties_.basicSimulationProperties().frequencies;
 
@@ -93,24 +714,28 @@ std::unordered_map<float, Collectors> SceneManager::run() {
     // Initialize frequency in visual reporesentation of the simulation
     positionTracker_->initializeNewFrequency(freq);
 
-    generators::PointSpeakerRayFactory pointSpeaker(
-        simulationProperties_.basicSimulationProperties().numOfRaysSquared,
-        simulationProperties_.basicSimulationProperties().sourcePower, model_);
+    std::unique_ptr<generators::RayFactory> source = createRaySource(0);
 
-    Simulator simulator(&raytracer_, model_, &pointSpeaker, offseter_.get(),
+    Simulator simulator(&raytracer_, model_, source.get(), offseter_.get(),
                         positionTracker_,
-                        simulationProperties_.energyCollectionRules());
+                        simulationProperties_.energyCollectionRules(),
+                        threadPool_.get(),
+                        simulationProperties_.terminationPolicies(),
+                        simulationProperties_.basicSimulationProperties()
+                            .execution);
 
-    Collectors collectors = buildCollectors(
-        model_,
-        simulationProperties_.basicSimulationProperties().numOfCollectors);
+    Collectors collectors = createCollectors();
 
     // Save collectors for the visual representation
     collectorsTracker_->save(collectors, "./data");
 
     int maxTracking =
         simulationProperties_.basicSimulationProperties().maxTracking;
-    simulator.run(freq, &collectors, maxTracking);
+    {
+      timeline::ScopedSpan span("Simulator::run", {{"frequency", freq}});
+      simulator.run(freq, &collectors, maxTracking);
+    }
+    terminationSavings_.add(simulator.terminationSavings());
 
     collectorsPerFrequencies.insert(
         std::make_pair(freq, std::move(collectors)));
@@ -119,3 +744,52 @@ std::unordered_map<float, Collectors> SceneManager::run() {
   positionTracker_->save();
   return collectorsPerFrequencies;
 }
+
+std::unordered_map<float, Collectors> SceneManager::runAllFrequenciesAtOnce() {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  const std::vector<float> &frequencies = basicProperties.frequencies;
+
+  std::unique_ptr<generators::RayFactory> source = createRaySource(0);
+
+  Simulator simulator(&raytracer_, model_, source.get(), offseter_.get(),
+                      positionTracker_,
+                      simulationProperties_.energyCollectionRules(),
+                      threadPool_.get(),
+                      simulationProperties_.terminationPolicies(),
+                      basicProperties.execution);
+
+  std::vector<Collectors> collectorsPerFrequency;
+  collectorsPerFrequency.reserve(frequencies.size());
+  std::vector<Collectors *> collectors;
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    collectors.push_back(
+        &collectorsPerFrequency.emplace_back(createCollectors()));
+  }
+
+  // Save collectors for the visual representation
+  collectorsTracker_->save(collectorsPerFrequency.front(), "./data");
+
+  // Trackings are the same for every frequency, so they are saved only with
+  // the first one and remaining frequencies are left without trackings.
+  positionTracker_->initializeNewFrequency(frequencies.front());
+  {
+    timeline::ScopedSpan span("Simulator::run",
+                              {{"numOfFrequencies", frequencies.size()}});
+    simulator.run(frequencies, collectors, basicProperties.maxTracking);
+  }
+  terminationSavings_.add(simulator.terminationSavings());
+  positionTracker_->endCurrentFrequency();
+  for (size_t index = 1; index < frequencies.size(); ++index) {
+    positionTracker_->initializeNewFrequency(frequencies[index]);
+    positionTracker_->endCurrentFrequency();
+  }
+  positionTracker_->save();
+
+  std::unordered_map<float, Collectors> collectorsPerFrequencies;
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    collectorsPerFrequencies.insert(std::make_pair(
+        frequencies[index], std::move(collectorsPerFrequency[index])));
+  }
+  return collectorsPerFrequencies;
+}
@@ -4,12 +4,18 @@
 #include "core/classUtlilities.h"
 #include "core/vec3.h"
 #include "main/rayTracer.h"
+#include "main/referencePlateSolver.h"
+#include "main/resultsCalculation.h"
 #include "main/simulator.h"
+#include "main/terminationPolicies.h"
+#include "main/threadPool.h"
 #include "main/trackers.h"
 #include "obj/generators.h"
 #include "obj/objects.h"
 
+#include <cstdint>
 #include <exception>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string_view>
@@ -17,6 +23,17 @@
 #include <utility>
 #include <vector>
 
+// Determines at which points of the model footprint rays of the source are
+// aimed: at the regular grid of generators::PointSpeakerRayFactory, at the
+// same grid with every target jittered inside its own cell by
+// generators::StratifiedJitterOffseter or at the scrambled Sobol sequence of
+// generators::SobolRayFactory. PLANE_WAVE replaces the point source with
+// parallel rays of generators::PlaneWaveRayFactory at normal incidence.
+// Jitter depends on the traced frequency, so with |multiFrequencyTracing|
+// every frequency is jittered as the first one and results differ from
+// tracing frequencies separately.
+enum class RayDistribution { GRID, JITTERED_GRID, SOBOL, PLANE_WAVE };
+
 // Store basic properties of the simulation.
 // |frequencies| is vector of frequencies that simulation will be performed on.
 // |sourcePower| determine how much energy is given to each
@@ -26,20 +43,42 @@
 // |numOfRaysSquared| determine how many rays will be used in the simulation.
 // Note: final number of used rays in simulation will be: |numOfRaysSquared|^2.
 // |maxTracking| how many reflection will simulation track per ray at maximum.
+// |numOfThreads| how many threads trace rays of the simulation. Simulation is
+// performed on the calling thread when equal to 1.
+// |multiFrequencyTracing| when true, every ray is traced once and its energy
+// is collected for all |frequencies| at the same time. Collected energy is
+// the same, but trackings are saved only for the first frequency.
+// |sampleRate| and |timeWindow| determine binning of the collected energy in
+// time: energy is summed in bins of 1 / |sampleRate| [s] and energy that
+// reaches collectors after |timeWindow| [s] is skipped.
+// |rayDistribution| determines where rays are aimed, see RayDistribution.
+// |execution| determines order in which reflections of the rays are traced,
+// see Simulator::Execution. Results do not depend on it.
 // REQUIREMENTS: |frequencies| cannot be empty, |sourcePower| must
 // be positive value, |numOfCollectors| must be greater then 4 and
 // |numCollectors| or  |numOfCollectors| - 1 must be divisable by 4,
-// |numOfRaysSquared| greater then 0, |maxTracking| must be greater then 1
+// |numOfRaysSquared| greater then 0, |maxTracking| must be greater then 1,
+// |numOfThreads|, |sampleRate| and |timeWindow| must be greater then 0
 struct BasicSimulationProperties : public Printable {
-  explicit BasicSimulationProperties(const std::vector<float> &frequencies,
-                                     float sourcePower, int numOfCollectors,
-                                     int numOfRaysSquared,
-                                     int maxTracking = 12);
+  explicit BasicSimulationProperties(
+      const std::vector<float> &frequencies, float sourcePower,
+      int numOfCollectors, int numOfRaysSquared, int maxTracking = 12,
+      int numOfThreads = 1, bool multiFrequencyTracing = false,
+      int sampleRate = objects::kDefaultSampleRate,
+      float timeWindow = objects::kDefaultTimeWindow,
+      RayDistribution rayDistribution = RayDistribution::GRID,
+      Simulator::Execution execution = Simulator::Execution::DEPTH_FIRST);
   std::vector<float> frequencies;
   float sourcePower;
   int numOfCollectors;
   int numOfRaysSquared;
   int maxTracking;
+  int numOfThreads;
+  bool multiFrequencyTracing;
+  int sampleRate;
+  float timeWindow;
+  RayDistribution rayDistribution;
+  Simulator::Execution execution;
 
   void printItself(std::ostream &os) const noexcept override;
 };
@@ -49,15 +88,24 @@ struct BasicSimulationProperties : public Printable {
 // EnergyCollector.
 // |basicSimulationProperies| determine how objects for simulation are built and
 // on which frequencies simulation will be performed.
+// |terminationPolicies| are asked in order after every reflection, whether ray
+// should be dropped before it reaches |maxTracking|.
 struct SimulationProperties : public Printable {
   explicit SimulationProperties(
       collectionRules::CollectEnergyInterface *energyCollectionRules,
-      const BasicSimulationProperties &basicSimulationProperties);
+      const BasicSimulationProperties &basicSimulationProperties,
+      const std::vector<const terminationPolicies::TerminationPolicy *>
+          &terminationPolicies = {});
 
   collectionRules::CollectEnergyInterface *energyCollectionRules() const {
     return energyCollectionRules_;
   }
 
+  const std::vector<const terminationPolicies::TerminationPolicy *> &
+  terminationPolicies() const {
+    return terminationPolicies_;
+  }
+
   BasicSimulationProperties basicSimulationProperties() const {
     return basicSimulationProperties_;
   }
@@ -67,6 +115,118 @@ struct SimulationProperties : public Printable {
 private:
   collectionRules::CollectEnergyInterface *energyCollectionRules_;
   BasicSimulationProperties basicSimulationProperties_;
+  std::vector<const terminationPolicies::TerminationPolicy *>
+      terminationPolicies_;
+};
+
+// Properties of the progressive simulation, which traces rays in batches
+// until diffusion coefficient of every frequency converges.
+// Every batch traces |numOfRaysSquared|^2 rays, aimed at the grid of targets
+// shifted by a different offset or at the next range of the Sobol sequence,
+// depending on the rayDistribution. After every batch, diffusion coefficient of
+// every frequency is calculated from all batches so far, together with its
+// 95% confidence interval estimated with jackknife over the batches.
+// Frequency stops when half width of the interval is at most |tolerance|,
+// but not before |minNumOfBatches| batches, or after |maxNumOfBatches|.
+// REQUIREMENTS: |tolerance| must be greater then 0, |minNumOfBatches| must
+// be at least 2 and |maxNumOfBatches| cannot be less then |minNumOfBatches|.
+struct ProgressiveSimulationProperties : public Printable {
+  explicit ProgressiveSimulationProperties(float tolerance,
+                                           int maxNumOfBatches,
+                                           int minNumOfBatches = 4);
+  float tolerance;
+  int maxNumOfBatches;
+  int minNumOfBatches;
+
+  void printItself(std::ostream &os) const noexcept override;
+};
+
+// Result of the progressive simulation at a single frequency.
+struct FrequencyConvergence : public Printable {
+  float frequency;
+  float diffusionCoefficient;
+  // Half width of the 95% confidence interval of |diffusionCoefficient|.
+  float confidenceHalfWidth;
+  int numOfBatches;
+  int64_t numOfRays;
+  // False when the simulation stopped at maxNumOfBatches before reaching
+  // the tolerance.
+  bool converged;
+
+  void printItself(std::ostream &os) const noexcept override;
+};
+
+struct ProgressiveResults : public Printable {
+  ProgressiveResults(EnergyTensor energies,
+                     std::vector<FrequencyConvergence> convergence);
+
+  // Energy collected at every frequency, averaged over its batches.
+  EnergyTensor energies;
+  // Convergence of every frequency, in the order of |energies| frequencies.
+  std::vector<FrequencyConvergence> convergence;
+
+  // Values of |convergence| per frequency, e.g. for
+  // trackers::ResultTracker::registerResult().
+  std::map<float, float> diffusionCoefficients() const;
+  std::map<float, float> confidenceHalfWidths() const;
+  std::map<float, float> numOfRays() const;
+
+  void printItself(std::ostream &os) const noexcept override;
+};
+
+// Position of the source in the sweep, given by direction from the center of
+// the model towards the source: |incidenceAngle| from the vertical and
+// |azimuthAngle| around z axis, both in radians. Point sources are placed at
+// the same distance from the model as in run(), plane waves come from the
+// given direction.
+// REQUIREMENTS: |incidenceAngle| must be in range [0, pi / 2).
+struct SourcePosition : public Printable {
+  explicit SourcePosition(float incidenceAngle = 0, float azimuthAngle = 0);
+  float incidenceAngle;
+  float azimuthAngle;
+
+  void printItself(std::ostream &os) const noexcept override;
+};
+
+struct SweepResults : public Printable {
+  SweepResults(std::vector<SourcePosition> sources,
+               std::vector<EnergyTensor> energies,
+               std::vector<std::map<float, float>> diffusionCoefficients);
+
+  std::vector<SourcePosition> sources;
+  // Energy collected from the source at the same index.
+  std::vector<EnergyTensor> energies;
+  // Diffusion coefficient per frequency of the source at the same index.
+  std::vector<std::map<float, float>> diffusionCoefficients;
+
+  // Random incidence diffusion coefficient per frequency, which is the
+  // arithmetic mean of the coefficients of every source.
+  std::map<float, float> averageDiffusionCoefficients() const;
+
+  void printItself(std::ostream &os) const noexcept override;
+};
+
+// Determines how SceneManager::runWithReference() obtains energy of the flat
+// reference model: TRACED traces it as any other model, ANALYTIC integrates
+// it with ReferencePlateSolver, which is much faster and free of ray noise.
+// TRACED is kept to cross-check both.
+enum class ReferenceSolver { TRACED, ANALYTIC };
+
+// Results of the tested model and the flat reference model traced with the
+// same source and collectors, see SceneManager::runWithReference().
+struct PairedResults : public Printable {
+  PairedResults(EnergyTensor energies, EnergyTensor referenceEnergies,
+                std::map<float, float> diffusionCoefficients,
+                std::map<float, float> referenceDiffusionCoefficients);
+
+  EnergyTensor energies;
+  EnergyTensor referenceEnergies;
+  std::map<float, float> diffusionCoefficients;
+  std::map<float, float> referenceDiffusionCoefficients;
+  // See normalizedDiffusionCoefficients().
+  std::map<float, float> normalizedDiffusionCoefficients;
+
+  void printItself(std::ostream &os) const noexcept override;
 };
 
 // This class is creating all necessary objects for simulation.
@@ -86,20 +246,94 @@ public:
       trackers::PositionTrackerInterface *positionTracker,
       trackers::CollectorsTrackerInterface *collectorsTracker);
 
-  // Runs simulation and retruns map of collectors with acquired energy per
+  // Runs simulation and retruns energy acquired by every collector per
   // frequency
-  std::unordered_map<float, Collectors> run();
+  EnergyTensor run();
+  // Runs simulation in batches until diffusion coefficient of every
+  // frequency converges, see ProgressiveSimulationProperties. Trackings of
+  // the batches are not saved.
+  ProgressiveResults
+  runProgressive(const ProgressiveSimulationProperties &progressiveProperties);
+  // Runs simulation for every source of the sweep with the same model and
+  // collectors. Every source and frequency is a separate job scheduled on
+  // the thread pool, rays of a single job are traced on one thread. Results
+  // do not depend on the number of threads. Trackings of the sweep are not
+  // saved. Throws std::invalid_argument when |sources| is empty.
+  SweepResults runSweep(const std::vector<SourcePosition> &sources);
+  // Runs simulation of the model together with the flat reference model of
+  // the same side size, created with Model::NewReferenceModel(). Both models
+  // are traced with the same source and the same collectors, both built for
+  // the tested model. Every model and frequency is a separate job scheduled
+  // on the thread pool, as in runSweep(). Trackings are not saved.
+  // Termination policies are not applied to the ANALYTIC |referenceSolver|,
+  // which does not support plane wave sources and throws
+  // std::invalid_argument for them.
+  PairedResults
+  runWithReference(ReferenceSolver referenceSolver = ReferenceSolver::ANALYTIC);
+
+  // Work saved by termination policies in every run so far.
+  const terminationPolicies::TerminationSavings &terminationSavings() const {
+    return terminationSavings_;
+  }
 
   void printItself(std::ostream &os) const noexcept override;
 
 private:
+  std::unordered_map<float, Collectors> runEveryFrequency();
+  std::unordered_map<float, Collectors> runAllFrequenciesAtOnce();
+  Collectors createCollectors() const;
+  // Creates source of rays traced in the |batch| of the progressive
+  // simulation from given |position|. The first batch traces rays of run().
+  std::unique_ptr<generators::RayFactory>
+  createRaySource(int batch,
+                  const SourcePosition &position = SourcePosition()) const;
+  // Creates offseter of rays traced in the |batch| of the progressive
+  // simulation, every batch is jittered with a different seed.
+  std::unique_ptr<generators::RandomRayOffseter>
+  createRayOffseter(int batch) const;
+  // Rays of |source| traced by |tracer| at |frequencies|, whose energy is
+  // collected into own |collectors| of every frequency, so jobs can be
+  // traced on any thread.
+  struct TracingJob {
+    RayTracer *tracer;
+    generators::RayFactory *source;
+    std::vector<float> frequencies;
+    std::vector<Collectors> collectors;
+    terminationPolicies::TerminationSavings savings;
+  };
+  // Appends jobs that trace every frequency of the simulation with |source|
+  // and |tracer| to |jobs|. Frequencies are traced in a single job when
+  // multiFrequencyTracing is enabled. Returns index of the first added job.
+  size_t addTracingJobs(RayTracer *tracer, generators::RayFactory *source,
+                        std::vector<TracingJob> *jobs) const;
+  // Traces |jobs| on the thread pool, or on the calling thread when there is
+  // no pool. Rays of every job are traced on a single thread, so results do
+  // not depend on the number of threads.
+  void runTracingJobs(std::vector<TracingJob> *jobs);
+  // Moves collectors of |numOfJobs| jobs starting at |firstJob| into a
+  // tensor of energies.
+  static EnergyTensor collectJobEnergies(std::vector<TracingJob> *jobs,
+                                         size_t firstJob, size_t numOfJobs);
+  // Traces rays of |source| offset by |offseter| and collects their energy
+  // into |collectors| of every frequency.
+  void traceBatch(const std::vector<float> &frequencies,
+                  const std::vector<Collectors *> &collectors,
+                  generators::RayFactory *source,
+                  generators::RandomRayOffseter *offseter,
+                  trackers::PositionTrackerInterface *positionTracker);
+
   Model *model_;
   SimulationProperties simulationProperties_;
   RayTracer raytracer_;
   trackers::PositionTrackerInterface *positionTracker_;
   trackers::CollectorsTrackerInterface *collectorsTracker_;
 
+  terminationPolicies::TerminationSavings terminationSavings_;
+
+  // Offseter of the rays traced by run().
   std::unique_ptr<generators::RandomRayOffseter> offseter_;
+  // Not created when simulation is performed on the single thread.
+  std::unique_ptr<ThreadPool> threadPool_;
 };
 
 #endif
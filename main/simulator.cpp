@@ -2,72 +2,82 @@
 
 namespace collectionRules {
 
-void CollectEnergyInterface::printItself(std::ostream &os) const noexcept {
-  os << "Collect Energy Rules Class Interface";
+void CollectEnergyInterface::collectEnergy(const Collectors &collectors,
+                                           core::RayHitData *hitData) {
+  core::Vec3 reachedPosition = hitData->collisionPoint();
+  for (const auto &collector : collectors) {
+    if (collector->isVecInside(reachedPosition)) {
+      collectEnergyInside(collector.get(), reachedPosition, hitData);
+    }
+  }
 }
 
-void LinearEnergyCollection::collectEnergy(
-    const std::vector<std::unique_ptr<objects::EnergyCollector>> &collectors,
-    core::RayHitData *hitData) {
-
+void CollectEnergyInterface::collectEnergy(const Collectors &collectors,
+                                           const CollectorsIndex &index,
+                                           core::RayHitData *hitData) {
   core::Vec3 reachedPosition = hitData->collisionPoint();
-  for (auto &energyCollector : collectors) {
-    if (energyCollector->isVecInside(reachedPosition)) {
-      float distanceToOrigin =
-          (energyCollector->getOrigin() - reachedPosition).magnitude();
-
-      // The closer ray hits origin of the energy Collector, the more energy
-      // energyCollector collects.
-      float energyRatio = 1 - distanceToOrigin / energyCollector->getRadius();
-      energyCollector->addEnergy(hitData->accumulatedTime,
-                                 energyRatio * hitData->energy());
-    };
+  for (int collectorIndex : index.candidates(reachedPosition)) {
+    objects::EnergyCollector *collector = collectors[collectorIndex].get();
+    if (collector->isVecInside(reachedPosition)) {
+      collectEnergyInside(collector, reachedPosition, hitData);
+    }
   }
 }
 
+void CollectEnergyInterface::printItself(std::ostream &os) const noexcept {
+  os << "Collect Energy Rules Class Interface";
+}
+
+void LinearEnergyCollection::collectEnergyInside(
+    objects::EnergyCollector *energyCollector,
+    const core::Vec3 &reachedPosition, core::RayHitData *hitData) {
+  float distanceToOrigin =
+      (energyCollector->getOrigin() - reachedPosition).magnitude();
+
+  // The closer ray hits origin of the energy Collector, the more energy
+  // energyCollector collects.
+  float energyRatio = 1 - distanceToOrigin / energyCollector->getRadius();
+  energyCollector->addEnergy(hitData->accumulatedTime,
+                             energyRatio * hitData->energy());
+}
+
 void LinearEnergyCollection::printItself(std::ostream &os) const noexcept {
   os << "Linear Energy Collection";
 }
 
-void LinearEnergyCollectionWithPhaseImpact::collectEnergy(
-    const std::vector<std::unique_ptr<objects::EnergyCollector>> &collectors,
-    core::RayHitData *hitData) {
-
-  core::Vec3 reachedPosition = hitData->collisionPoint();
-  for (auto &energyCollector : collectors) {
-    if (energyCollector->isVecInside(reachedPosition)) {
-      float distanceToOrigin =
-          (energyCollector->getOrigin() - reachedPosition).magnitude();
-
-      // The closer ray hits origin of the energy Collector, the more energy
-      // energyCollector collects.
-      float energyRatio = 1 - distanceToOrigin / energyCollector->getRadius();
-      energyCollector->addEnergy(hitData->accumulatedTime,
-                                 energyRatio * hitData->energy() *
-                                     std::cos(hitData->phase()));
-    };
-  }
+void LinearEnergyCollectionWithPhaseImpact::collectEnergyInside(
+    objects::EnergyCollector *energyCollector,
+    const core::Vec3 &reachedPosition, core::RayHitData *hitData) {
+  float distanceToOrigin =
+      (energyCollector->getOrigin() - reachedPosition).magnitude();
+
+  // The closer ray hits origin of the energy Collector, the more energy
+  // energyCollector collects.
+  float energyRatio = 1 - distanceToOrigin / energyCollector->getRadius();
+  energyCollector->addEnergy(hitData->accumulatedTime,
+                             energyRatio * hitData->energy() *
+                                 std::cos(hitData->phase()));
 }
 void LinearEnergyCollectionWithPhaseImpact::printItself(
     std::ostream &os) const noexcept {
   os << "Linear Energy Collection With Phase Impact";
 }
 
-void NonLinearEnergyCollection::collectEnergy(const Collectors &collectors,
-                                              core::RayHitData *hitData) {
-  core::Vec3 reachedPosition = hitData->collisionPoint();
-  for (const auto &collector : collectors) {
-    if (collector->isVecInside(reachedPosition)) {
-      float distanceToOrigin =
-          (collector->getOrigin() - reachedPosition).magnitude();
-      float distanceFactor = 2 * std::sqrt(std::pow(collector->getRadius(), 2) -
-                                           std::pow(distanceToOrigin, 2));
-      float soundIntensity =
-          hitData->energy() * distanceFactor / collector->volume();
-
-      collector->addEnergy(hitData->accumulatedTime, soundIntensity);
-    }
-  }
+void NonLinearEnergyCollection::collectEnergyInside(
+    objects::EnergyCollector *collector, const core::Vec3 &reachedPosition,
+    core::RayHitData *hitData) {
+  float distanceToOrigin =
+      (collector->getOrigin() - reachedPosition).magnitude();
+  // Squares of floats are exact in double precision, so they are equal to
+  // std::pow(value, 2) without the call.
+  const double radius = collector->getRadius();
+  const double distance = distanceToOrigin;
+  float distanceFactor =
+      2 * std::sqrt(radius * radius - distance * distance);
+  float soundIntensity =
+      hitData->energy() * distanceFactor / collector->volume();
+
+  collector->addEnergy(hitData->accumulatedTime, soundIntensity);
 }
 
 void NonLinearEnergyCollection::printItself(std::ostream &os) const noexcept {
@@ -79,7 +89,9 @@ void NonLinearEnergyCollection::printItself(std::ostream &os) const noexcept {
 }
 } // namespace collectionRules
 
-Collectors buildCollectors(const ModelInterface *model, int numCollectors) {
+Collectors buildCollectors(const ModelInterface *model, int numCollectors,
+                           int sampleRate, float timeWindow) {
+  timeline::ScopedSpan span("buildCollectors");
 
   if (model->empty()) {
     throw std::invalid_argument(
@@ -136,7 +148,8 @@ Collectors buildCollectors(const ModelInterface *model, int numCollectors) {
   // collectorSphereRadius)
   if (numCollectorReminder == 1) {
     energyCollectors.push_back(std::make_unique<objects::EnergyCollector>(
-        core::Vec3(0, 0, collectorSphereRadius), energyCollectorRadius));
+        core::Vec3(0, 0, collectorSphereRadius), energyCollectorRadius,
+        sampleRate, timeWindow));
   }
   // and decrease number remaining collectors to create remaining ones
   const int numToGo = numCollectors - (numCollectorReminder);
@@ -157,7 +170,7 @@ Collectors buildCollectors(const ModelInterface *model, int numCollectors) {
 
     for (const core::Vec3 &origin : origins) {
       energyCollectors.push_back(std::make_unique<objects::EnergyCollector>(
-          origin, energyCollectorRadius));
+          origin, energyCollectorRadius, sampleRate, timeWindow));
     }
   }
   return energyCollectors;
@@ -176,47 +189,403 @@ void Simulator::printItself(std::ostream &os) const noexcept {
      << "Ray Offseter: " << *offsetter_ << "\n"
      << "Position Tracker: " << *positionTracker_ << "\n"
      << "Energy Collection Rules: " << *energyCollectionRules_ << "\n";
+  if (threadPool_ != nullptr) {
+    os << "Thread Pool: " << *threadPool_ << "\n";
+  }
+  os << "Execution: "
+     << (execution_ == Execution::WAVEFRONT ? "Wavefront" : "Depth First")
+     << "\n";
+  for (const terminationPolicies::TerminationPolicy *policy :
+       terminationPolicies_) {
+    os << "Termination Policy: " << *policy << "\n";
+  }
 }
 
 void Simulator::run(float frequency, Collectors *collectors,
                     const int maxTracking) {
+  run(std::vector<float>{frequency}, std::vector<Collectors *>{collectors},
+      maxTracking);
+}
 
-  // Determines spacial limits of the simulation
-  objects::SphereWall sphereWall(getSphereWallRadius(*model_));
+void Simulator::run(const std::vector<float> &frequencies,
+                    const std::vector<Collectors *> &collectors,
+                    const int maxTracking) {
+  if (frequencies.empty() || frequencies.size() != collectors.size()) {
+    std::stringstream errorStream;
+    errorStream << "Simulator needs collectors for every frequency! Number of "
+                   "frequencies: "
+                << frequencies.size()
+                << ", number of collectors: " << collectors.size();
+    throw std::invalid_argument(errorStream.str());
+  }
+  run(frequencies, {energyCollectionRules_}, {collectors}, maxTracking);
+}
+void Simulator::run(const std::vector<float> &frequencies,
+                    const std::vector<collectionRules::CollectEnergyInterface *>
+                        &energyCollectionRules,
+                    const std::vector<std::vector<Collectors *>> &collectors,
+                    const int maxTracking) {
+  if (energyCollectionRules.empty() ||
+      energyCollectionRules.size() != collectors.size()) {
+    std::stringstream errorStream;
+    errorStream << "Simulator needs collectors for every collection rule! "
+                   "Number of rules: "
+                << energyCollectionRules.size()
+                << ", number of collector sets: " << collectors.size();
+    throw std::invalid_argument(errorStream.str());
+  }
+  for (const std::vector<Collectors *> &ruleCollectors : collectors) {
+    if (frequencies.empty() || frequencies.size() != ruleCollectors.size()) {
+      std::stringstream errorStream;
+      errorStream << "Simulator needs collectors for every frequency! Number "
+                     "of frequencies: "
+                  << frequencies.size()
+                  << ", number of collectors: " << ruleCollectors.size();
+      throw std::invalid_argument(errorStream.str());
+    }
+  }
+  INSTRUMENT_STAGE(SIMULATION);
+
+  // Collectors do not move during the simulation, so lookup of collectors
+  // that can contain hit position is built once per run. Indices are
+  // reserved up front, so targets can point to them.
+  std::vector<CollectorsIndex> collectorsIndices;
+  collectorsIndices.reserve(energyCollectionRules.size() * frequencies.size());
+  std::vector<CollectionTarget> targets;
+  for (size_t rule = 0; rule < energyCollectionRules.size(); ++rule) {
+    for (size_t frequencyIndex = 0; frequencyIndex < frequencies.size();
+         ++frequencyIndex) {
+      Collectors *frequencyCollectors = collectors[rule][frequencyIndex];
+      collectorsIndices.emplace_back(*frequencyCollectors);
+      targets.push_back({energyCollectionRules[rule], frequencyIndex,
+                         frequencyCollectors, &collectorsIndices.back()});
+    }
+  }
+
+  if (threadPool_ != nullptr && threadPool_->size() > 1) {
+    runInParallel(frequencies, targets, maxTracking);
+    return;
+  }
+  traceRays(0, source_->numOfRays(), frequencies, targets, maxTracking,
+            positionTracker_, &terminationSavings_);
+}
+void Simulator::runInParallel(const std::vector<float> &frequencies,
+                              const std::vector<CollectionTarget> &targets,
+                              int maxTracking) {
+  const int numOfRays = source_->numOfRays();
+  const int numOfShards = threadPool_->size();
+
+  // Every shard collects energy into its own collectors, so no
+  // synchronization is needed during the tracing.
+  // |shardCollectors|[shard][targetIndex]
+  std::vector<std::vector<Collectors>> shardCollectors(numOfShards);
+  std::vector<terminationPolicies::TerminationSavings> shardSavings(
+      numOfShards,
+      terminationPolicies::TerminationSavings(terminationPolicies_));
+  std::mutex positionTrackerMutex;
+  for (int shard = 0; shard < numOfShards; ++shard) {
+    for (const CollectionTarget &target : targets) {
+      Collectors &copy = shardCollectors[shard].emplace_back();
+      for (const auto &collector : *target.collectors) {
+        copy.push_back(std::make_unique<objects::EnergyCollector>(
+            collector->getOrigin(), collector->getRadius(),
+            collector->getEnergy().sampleRate(),
+            collector->getEnergy().timeWindow()));
+      }
+    }
+  }
 
-  core::Ray currentRay;
-  while (source_->genRay(&currentRay)) {
+  for (int shard = 0; shard < numOfShards; ++shard) {
+    // Index math is done on 64 bits to avoid overflow for big ray counts.
+    const int beginRayIndex =
+        static_cast<int64_t>(numOfRays) * shard / numOfShards;
+    const int endRayIndex =
+        static_cast<int64_t>(numOfRays) * (shard + 1) / numOfShards;
+    // Copies of collectors have the same geometry, so they share indices.
+    std::vector<CollectionTarget> shardTargets = targets;
+    for (size_t targetIndex = 0; targetIndex < targets.size(); ++targetIndex) {
+      shardTargets[targetIndex].collectors =
+          &shardCollectors[shard][targetIndex];
+    }
+    threadPool_->schedule([this, shard, beginRayIndex, endRayIndex,
+                           &frequencies, maxTracking, &positionTrackerMutex,
+                           &shardSavings,
+                           shardTargets = std::move(shardTargets)] {
+      timeline::ScopedSpan span("Simulator::traceRays", {{"shard", shard}});
+      trackers::BufferedPositionTracker positionTracker(positionTracker_,
+                                                        &positionTrackerMutex);
+      traceRays(beginRayIndex, endRayIndex, frequencies, shardTargets,
+                maxTracking, &positionTracker, &shardSavings[shard]);
+    });
+  }
+  threadPool_->wait();
+  for (const terminationPolicies::TerminationSavings &savings : shardSavings) {
+    terminationSavings_.add(savings);
+  }
 
-    // Initialize visual representation of ray tracking in gui
-    positionTracker_->initializeNewTracking();
+  // Shards are reduced always in the same order, so results do not depend on
+  // scheduling of the threads.
+  for (const std::vector<Collectors> &shard : shardCollectors) {
+    for (size_t targetIndex = 0; targetIndex < shard.size(); ++targetIndex) {
+      const Collectors &source = shard[targetIndex];
+      Collectors &target = *targets[targetIndex].collectors;
+      for (size_t index = 0; index < source.size(); ++index) {
+        target[index]->addEnergy(source[index]->getEnergy());
+      }
+    }
+  }
+}
+
+void Simulator::traceRays(
+    int beginRayIndex, int endRayIndex, const std::vector<float> &frequencies,
+    const std::vector<CollectionTarget> &targets, int maxTracking,
+    trackers::PositionTrackerInterface *positionTracker,
+    terminationPolicies::TerminationSavings *savings) const {
+  if (execution_ == Execution::WAVEFRONT) {
+    traceRaysWavefront(beginRayIndex, endRayIndex, frequencies, targets,
+                       maxTracking, positionTracker, savings);
+    return;
+  }
+
+  // Path of the ray is the same for every frequency, it is traced with the
+  // first one and frequency of the final hit is changed before collection.
+  const float frequency = frequencies.front();
+
+  // Traced rays wait for the exit through the sphere wall, until there are
+  // enough of them to fill the ExitBatch.
+  std::array<TracedRay, ExitBatch::kCapacity> tracedRays;
+  int numOfTracedRays = 0;
+
+  for (int rayIndex = beginRayIndex; rayIndex < endRayIndex; ++rayIndex) {
+    INSTRUMENT_COUNT(RAYS, 1);
+    TracedRay &traced = tracedRays[numOfTracedRays++];
+    core::Ray &currentRay = traced.ray;
+    {
+      INSTRUMENT_STAGE(RAY_GENERATION);
+      currentRay = source_->getRay(rayIndex);
+      offsetter_->offsetRay(&currentRay, rayIndex, frequency);
+    }
+    traced.trackedHits.clear();
 
     // TODO: replace hitData with factory to delete default values for
     // rayHitData
-    core::RayHitData hitData;
+    core::RayHitData &hitData = traced.hitData;
+    hitData = core::RayHitData();
     RayTracer::TraceResult hitResult = RayTracer::TraceResult::HIT_TRIANGLE;
     int currentTracking = 0;
+    int numOfBounces = 0;
+    bool terminated = false;
     while (hitResult == RayTracer::TraceResult::HIT_TRIANGLE) {
-      hitResult = tracer_->rayTrace(currentRay, frequency, &hitData);
-      currentRay = tracer_->getReflected(&hitData);
+      {
+        INSTRUMENT_STAGE(RAY_TRACING);
+        hitResult = tracer_->rayTrace(currentRay, frequency, &hitData);
+        currentRay = tracer_->getReflected(&hitData);
+      }
 
       if (hitResult == RayTracer::TraceResult::HIT_TRIANGLE) {
-        positionTracker_->addNewPositionToCurrentTracking(hitData);
+        ++numOfBounces;
+        INSTRUMENT_STAGE(TRACKING);
+        traced.trackedHits.push_back(hitData);
       }
 
       ++currentTracking;
       if (currentTracking > maxTracking) {
+        INSTRUMENT_COUNT(TRUNCATED_RAYS, 1);
         break;
       }
+
+      if (hitResult == RayTracer::TraceResult::HIT_TRIANGLE &&
+          !terminationPolicies_.empty()) {
+        int policy = terminatingPolicy(rayIndex, numOfBounces,
+                                       hitData.accumulatedTime, &currentRay);
+        if (policy != -1) {
+          savings->addTerminatedRay(policy, maxTracking - currentTracking + 1);
+          terminated = true;
+          break;
+        }
+      }
     };
+    INSTRUMENT_COUNT(TRIANGLE_HITS, numOfBounces);
+    INSTRUMENT_BOUNCE_DEPTH(numOfBounces);
+    savings->addTracedReflections(numOfBounces);
+    traced.terminated = terminated;
+
+    if (numOfTracedRays == ExitBatch::kCapacity) {
+      finishRays(tracedRays.data(), numOfTracedRays, frequencies, targets,
+                 positionTracker);
+      numOfTracedRays = 0;
+    }
+  }
+  finishRays(tracedRays.data(), numOfTracedRays, frequencies, targets,
+             positionTracker);
+}
 
-    if (sphereWall.hitObject(currentRay, frequency, &hitData)) {
-      positionTracker_->addNewPositionToCurrentTracking(hitData);
-      hitData.accumulatedTime += hitData.time / constants::kSoundSpeed;
+void Simulator::traceRaysWavefront(
+    int beginRayIndex, int endRayIndex, const std::vector<float> &frequencies,
+    const std::vector<CollectionTarget> &targets, int maxTracking,
+    trackers::PositionTrackerInterface *positionTracker,
+    terminationPolicies::TerminationSavings *savings) const {
+  const float frequency = frequencies.front();
+
+  std::vector<TracedRay> tracedRays;
+  // Indices of the rays in |tracedRays| reflected by a triangle in every
+  // pass so far, in ascending order.
+  std::vector<int> liveRays, nextLiveRays;
+  std::vector<bool> isLive;
+  for (int batchBegin = beginRayIndex; batchBegin < endRayIndex;
+       batchBegin += kWavefrontSize) {
+    const int numOfRays = std::min(kWavefrontSize, endRayIndex - batchBegin);
+    tracedRays.resize(numOfRays);
+    liveRays.clear();
+    isLive.assign(numOfRays, true);
+    {
+      INSTRUMENT_STAGE(RAY_GENERATION);
+      for (int index = 0; index < numOfRays; ++index) {
+        INSTRUMENT_COUNT(RAYS, 1);
+        TracedRay &traced = tracedRays[index];
+        traced.ray = source_->getRay(batchBegin + index);
+        offsetter_->offsetRay(&traced.ray, batchBegin + index, frequency);
+        traced.hitData = core::RayHitData();
+        traced.trackedHits.clear();
+        traced.terminated = false;
+        liveRays.push_back(index);
+      }
     }
 
-    positionTracker_->endCurrentTracking();
-    energyCollectionRules_->collectEnergy(*collectors, &hitData);
+    // Rays before |numOfFinishedRays| are already finished.
+    int numOfFinishedRays = 0;
+    for (int currentTracking = 1; !liveRays.empty(); ++currentTracking) {
+      nextLiveRays.clear();
+      for (int index : liveRays) {
+        TracedRay &traced = tracedRays[index];
+        RayTracer::TraceResult hitResult;
+        {
+          INSTRUMENT_STAGE(RAY_TRACING);
+          hitResult = tracer_->rayTrace(traced.ray, frequency, &traced.hitData);
+          traced.ray = tracer_->getReflected(&traced.hitData);
+        }
+        const bool hitTriangle =
+            hitResult == RayTracer::TraceResult::HIT_TRIANGLE;
+        if (hitTriangle) {
+          INSTRUMENT_STAGE(TRACKING);
+          traced.trackedHits.push_back(traced.hitData);
+        }
+
+        // The same order of checks as in traceRays().
+        bool survived = hitTriangle;
+        if (currentTracking > maxTracking) {
+          INSTRUMENT_COUNT(TRUNCATED_RAYS, 1);
+          survived = false;
+        } else if (hitTriangle && !terminationPolicies_.empty()) {
+          int policy = terminatingPolicy(
+              batchBegin + index, static_cast<int>(traced.trackedHits.size()),
+              traced.hitData.accumulatedTime, &traced.ray);
+          if (policy != -1) {
+            savings->addTerminatedRay(policy,
+                                      maxTracking - currentTracking + 1);
+            traced.terminated = true;
+            survived = false;
+          }
+        }
+
+        if (survived) {
+          nextLiveRays.push_back(index);
+          continue;
+        }
+        isLive[index] = false;
+        const int numOfBounces = traced.trackedHits.size();
+        INSTRUMENT_COUNT(TRIANGLE_HITS, numOfBounces);
+        INSTRUMENT_BOUNCE_DEPTH(numOfBounces);
+        savings->addTracedReflections(numOfBounces);
+      }
+      std::swap(liveRays, nextLiveRays);
+
+      // Rays that left the model go straight to the collection, as soon as
+      // every ray before them is finished as well.
+      int numOfReadyRays = numOfFinishedRays;
+      while (numOfReadyRays < numOfRays && !isLive[numOfReadyRays]) {
+        ++numOfReadyRays;
+      }
+      finishRays(tracedRays.data() + numOfFinishedRays,
+                 numOfReadyRays - numOfFinishedRays, frequencies, targets,
+                 positionTracker);
+      numOfFinishedRays = numOfReadyRays;
+    }
+  }
+}
+
+void Simulator::finishRays(
+    TracedRay *rays, int numOfRays, const std::vector<float> &frequencies,
+    const std::vector<CollectionTarget> &targets,
+    trackers::PositionTrackerInterface *positionTracker) const {
+  const float frequency = frequencies.front();
+  // Determines spacial limits of the simulation
+  ExitBatch exitBatch(getSphereWallRadius(*model_));
+  std::array<int, ExitBatch::kCapacity> exitSlots;
+
+  for (int batchBegin = 0; batchBegin < numOfRays;
+       batchBegin += ExitBatch::kCapacity) {
+    const int batchSize =
+        std::min(ExitBatch::kCapacity, numOfRays - batchBegin);
+    TracedRay *batch = rays + batchBegin;
+    exitBatch.clear();
+    for (int index = 0; index < batchSize; ++index) {
+      exitSlots[index] =
+          batch[index].terminated ? -1 : exitBatch.add(batch[index].ray);
+    }
+    {
+      INSTRUMENT_STAGE(SPHERE_WALL);
+      exitBatch.computeExits();
+    }
+
+    for (int index = 0; index < batchSize; ++index) {
+      TracedRay &traced = batch[index];
+      core::RayHitData &hitData = traced.hitData;
+      bool hitSphereWall = false;
+      if (!traced.terminated) {
+        INSTRUMENT_STAGE(SPHERE_WALL);
+        hitSphereWall = exitBatch.exit(exitSlots[index], frequency, &hitData);
+      }
+
+      {
+        INSTRUMENT_STAGE(TRACKING);
+        positionTracker->initializeNewTracking();
+        for (const core::RayHitData &trackedHit : traced.trackedHits) {
+          positionTracker->addNewPositionToCurrentTracking(trackedHit);
+        }
+        if (hitSphereWall) {
+          INSTRUMENT_COUNT(SPHERE_WALL_HITS, 1);
+          positionTracker->addNewPositionToCurrentTracking(hitData);
+        }
+        positionTracker->endCurrentTracking();
+      }
+      if (traced.terminated) {
+        continue;
+      }
+      if (hitSphereWall) {
+        hitData.accumulatedTime += hitData.time / constants::kSoundSpeed;
+      }
+
+      INSTRUMENT_STAGE(COLLECTION);
+      for (const CollectionTarget &target : targets) {
+        core::RayHitData frequencyHitData = hitData;
+        frequencyHitData.frequency = frequencies[target.frequencyIndex];
+        target.rules->collectEnergy(*target.collectors, *target.index,
+                                    &frequencyHitData);
+      }
+    }
+  }
+}
+
+int Simulator::terminatingPolicy(int rayIndex, int numOfReflections,
+                                 float accumulatedTime, core::Ray *ray) const {
+  for (size_t policy = 0; policy < terminationPolicies_.size(); ++policy) {
+    if (terminationPolicies_[policy]->terminate(rayIndex, numOfReflections,
+                                                accumulatedTime, ray)) {
+      return policy;
+    }
   }
+  return -1;
 }
 
 // ! THIS WILL BE USEFUL FOR RESULTS CALCULATION LATER
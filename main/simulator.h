@@ -2,16 +2,25 @@
 #define SIMULATOR_H
 
 #include "core/classUtlilities.h"
+#include "main/collectorsIndex.h"
+#include "main/exitBatch.h"
+#include "main/instrumentation.h"
 #include "main/rayTracer.h"
+#include "main/terminationPolicies.h"
+#include "main/threadPool.h"
 #include "main/trackers.h"
 #include "nlohmann/json.hpp"
 #include "obj/generators.h"
 #include "obj/objects.h"
 
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string_view>
 #include <unordered_map>
@@ -26,9 +35,21 @@ namespace collectionRules {
 
 // defines how energy collectors collect energy in the simulation
 struct CollectEnergyInterface : public Printable {
-  virtual void collectEnergy(const Collectors &collectors,
-                             core::RayHitData *hitData) = 0;
+  // Puts energy of the ray, whose final hit is |hitData|, into every
+  // collector that contains position of the hit.
+  void collectEnergy(const Collectors &collectors, core::RayHitData *hitData);
+  // The same as above, but checks only candidates returned by |index| built
+  // for |collectors|. Candidates are visited in the same order, so collected
+  // energy is the same.
+  void collectEnergy(const Collectors &collectors,
+                     const CollectorsIndex &index, core::RayHitData *hitData);
   void printItself(std::ostream &os) const noexcept override;
+
+protected:
+  // Puts energy into |collector| which contains |reachedPosition| of the hit.
+  virtual void collectEnergyInside(objects::EnergyCollector *collector,
+                                   const core::Vec3 &reachedPosition,
+                                   core::RayHitData *hitData) = 0;
 };
 
 // The futher away from origin of energy collectors ray hits, the less energy it
@@ -37,19 +58,24 @@ struct CollectEnergyInterface : public Printable {
 // of the energyCollector, none energy is put inside the energy Collector. Phase
 // impact of the wave is not considered here.
 struct LinearEnergyCollection : public CollectEnergyInterface {
-  void collectEnergy(const Collectors &collectors,
-                     core::RayHitData *hitData) override;
   void printItself(std::ostream &os) const noexcept override;
+
+protected:
+  void collectEnergyInside(objects::EnergyCollector *collector,
+                           const core::Vec3 &reachedPosition,
+                           core::RayHitData *hitData) override;
 };
 
 // Rules of collection are exactly the same as in LinearEnergyCollection, but in
 // addition energy is multiplied by cos(phase), where phase represents wave
 // phase at hit position.
 struct LinearEnergyCollectionWithPhaseImpact : public CollectEnergyInterface {
-  void collectEnergy(const Collectors &collectors,
-                     core::RayHitData *hitData) override;
-
   void printItself(std::ostream &os) const noexcept override;
+
+protected:
+  void collectEnergyInside(objects::EnergyCollector *collector,
+                           const core::Vec3 &reachedPosition,
+                           core::RayHitData *hitData) override;
 };
 
 // Energy collection based on the "Optimizing diffusive surface topology through
@@ -60,11 +86,13 @@ struct LinearEnergyCollectionWithPhaseImpact : public CollectEnergyInterface {
 // where distance factor is:
 // distanceFactor = 2 * sqrt(collectorRadius^2 - distanceToOrigin^2)
 struct NonLinearEnergyCollection : public CollectEnergyInterface {
-  void collectEnergy(const Collectors &collectors,
-                     core::RayHitData *hitData) override;
   void printItself(std::ostream &os) const noexcept override;
+
+protected:
+  void collectEnergyInside(objects::EnergyCollector *collector,
+                           const core::Vec3 &reachedPosition,
+                           core::RayHitData *hitData) override;
 };
-// TODO: Create Combined Rules of collection
 // TODO: Add time factor to the collected energy
 } // namespace collectionRules
 
@@ -80,9 +108,13 @@ struct NonLinearEnergyCollection : public CollectEnergyInterface {
 // model. Radius of an energy collector is equal to distance between twoenergy
 // collectors.
 
+// Collected energy is binned with given |sampleRate| over |timeWindow|.
+
 // Throws std::invalid_argument when |numCollectors| < 4 or when |numCollectors|
 // or |numCollectors|-1 is not divisible by 4.
-Collectors buildCollectors(const ModelInterface *model, int numCollectors);
+Collectors buildCollectors(const ModelInterface *model, int numCollectors,
+                           int sampleRate = objects::kDefaultSampleRate,
+                           float timeWindow = objects::kDefaultTimeWindow);
 
 // Saves positions of the energyCollectors to the Json file at given path.
 void exportCollectorsToJson(const Collectors &energyCollectors,
@@ -94,23 +126,130 @@ void exportCollectorsToJson(const Collectors &energyCollectors,
 const float getSphereWallRadius(const ModelInterface &model);
 
 // Performs ray-tracing simulation on given model.
+// When |threadPool| with more than one thread is given, rays are traced in
+// parallel: range of ray indices is split into one contiguous shard per
+// thread, each shard collects energy into its own copy of collectors, which
+// are added to the given collectors in order of shards after all of them are
+// traced. Trackings of each shard are passed to |positionTracker| as whole
+// trackings, so |positionTracker| does not need to be thread safe, but the
+// order of trackings is not preserved.
+// After every reflection, |terminationPolicies| are asked in order whether
+// the ray should be dropped, see terminationPolicies::TerminationPolicy.
+// Every generated ray is offset by |offsetter| keyed on its index and the
+// traced frequency, so the offset does not depend on the thread tracing it.
+// When all frequencies are traced at once, rays are offset with the first
+// of them. Rays are traced in order given by |execution|.
 class Simulator : public Printable {
 public:
+  // Determines order in which reflections of the rays are traced.
+  // DEPTH_FIRST follows every ray through its whole chain of reflections
+  // before the next ray is started. WAVEFRONT traces every live ray of a
+  // batch of kWavefrontSize rays one reflection at a time, so every pass runs
+  // the tracer over a large batch of rays, and moves only rays reflected by
+  // a triangle to the next pass. Rays are finished in order of their indices
+  // in both cases, so results and trackings are exactly the same.
+  enum class Execution { DEPTH_FIRST, WAVEFRONT };
+  // Number of rays traced together by the WAVEFRONT execution.
+  static constexpr int kWavefrontSize = 4096;
+
   Simulator(RayTracer *tracer, ModelInterface *model,
             generators::RayFactory *source,
             generators::RandomRayOffseter *offsetter,
             trackers::PositionTrackerInterface *positionTracker,
-            collectionRules::CollectEnergyInterface *energyCollectionRules)
+            collectionRules::CollectEnergyInterface *energyCollectionRules,
+            ThreadPool *threadPool = nullptr,
+            const std::vector<const terminationPolicies::TerminationPolicy *>
+                &terminationPolicies = {},
+            Execution execution = Execution::DEPTH_FIRST)
       : tracer_(tracer), model_(model), source_(source), offsetter_(offsetter),
         positionTracker_(positionTracker),
-        energyCollectionRules_(energyCollectionRules){};
+        energyCollectionRules_(energyCollectionRules),
+        threadPool_(threadPool), terminationPolicies_(terminationPolicies),
+        terminationSavings_(terminationPolicies), execution_(execution){};
 
   // Runs the simulation by modifying given collectors
   void run(float frequency, Collectors *collectors, const int maxTracking);
+  // Runs the simulation for all |frequencies| at once. Reflection paths do
+  // not depend on frequency, so every ray is traced only once and its final
+  // hit is passed to the collection rules for each frequency, with
+  // |collectors|[i] collecting energy for |frequencies|[i]. Results are the
+  // same as from running the simulation for every frequency separately.
+  // Trackings are passed to the position tracker once, not per frequency.
+  // |frequencies| and |collectors| must have the same size.
+  void run(const std::vector<float> &frequencies,
+           const std::vector<Collectors *> &collectors, const int maxTracking);
+  // Runs the simulation for all |frequencies| at once, as above, but applies
+  // every rule of |energyCollectionRules| to the final hit of every ray, with
+  // |collectors|[r][i] collecting energy by |energyCollectionRules|[r] for
+  // |frequencies|[i]. Every ray is traced once for all the rules, so results
+  // are the same as from running the simulation for every rule separately at
+  // cost of a single trace. Rules given in the constructor are not used.
+  void run(const std::vector<float> &frequencies,
+           const std::vector<collectionRules::CollectEnergyInterface *>
+               &energyCollectionRules,
+           const std::vector<std::vector<Collectors *>> &collectors,
+           const int maxTracking);
+
+  // Work saved by termination policies in every run so far.
+  const terminationPolicies::TerminationSavings &terminationSavings() const {
+    return terminationSavings_;
+  }
 
   void printItself(std::ostream &os) const noexcept override;
 
 private:
+  // Collectors that collect energy of the final hits by |rules| for the
+  // frequency at |frequencyIndex|, |index| is built for |collectors|.
+  struct CollectionTarget {
+    collectionRules::CollectEnergyInterface *rules;
+    size_t frequencyIndex;
+    Collectors *collectors;
+    const CollectorsIndex *index;
+  };
+
+  // Ray whose reflections are traced, waiting for its exit through the
+  // sphere wall and for collection of its energy.
+  struct TracedRay {
+    // Ray reflected by the last hit triangle.
+    core::Ray ray;
+    core::RayHitData hitData;
+    // Hits of triangles, passed to the position tracker when the ray is
+    // finished.
+    std::vector<core::RayHitData> trackedHits;
+    bool terminated;
+  };
+
+  // Traces rays with indices in range [|beginRayIndex|, |endRayIndex|) and
+  // collects their energy into every target of |targets|, in order of them.
+  void traceRays(int beginRayIndex, int endRayIndex,
+                 const std::vector<float> &frequencies,
+                 const std::vector<CollectionTarget> &targets, int maxTracking,
+                 trackers::PositionTrackerInterface *positionTracker,
+                 terminationPolicies::TerminationSavings *savings) const;
+  // The same as above, but traces rays in WAVEFRONT order.
+  void traceRaysWavefront(int beginRayIndex, int endRayIndex,
+                          const std::vector<float> &frequencies,
+                          const std::vector<CollectionTarget> &targets,
+                          int maxTracking,
+                          trackers::PositionTrackerInterface *positionTracker,
+                          terminationPolicies::TerminationSavings *savings)
+      const;
+  // Finishes |numOfRays| consecutive |rays| in order: computes their exits
+  // through the sphere wall in batches of ExitBatch::kCapacity rays, passes
+  // their trackings to |positionTracker| and collects energy of rays that
+  // were not terminated into every target of |targets|.
+  void finishRays(TracedRay *rays, int numOfRays,
+                  const std::vector<float> &frequencies,
+                  const std::vector<CollectionTarget> &targets,
+                  trackers::PositionTrackerInterface *positionTracker) const;
+  // Returns index of the first termination policy that drops |ray| or -1 if
+  // none of them does.
+  int terminatingPolicy(int rayIndex, int numOfReflections,
+                        float accumulatedTime, core::Ray *ray) const;
+  void runInParallel(const std::vector<float> &frequencies,
+                     const std::vector<CollectionTarget> &targets,
+                     int maxTracking);
+
   RayTracer *tracer_;
   ModelInterface *model_;
   generators::RayFactory *source_;
@@ -118,6 +257,11 @@ private:
 
   trackers::PositionTrackerInterface *positionTracker_;
   collectionRules::CollectEnergyInterface *energyCollectionRules_;
+  ThreadPool *threadPool_;
+  std::vector<const terminationPolicies::TerminationPolicy *>
+      terminationPolicies_;
+  terminationPolicies::TerminationSavings terminationSavings_;
+  Execution execution_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "main/terminationPolicies.h"
+
+#include "core/constants.h"
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace terminationPolicies {
+
+namespace {
+
+// SplitMix64 finalizer, maps consecutive keys to uncorrelated values.
+uint64_t mix(uint64_t key) {
+  key += 0x9e3779b97f4a7c15ULL;
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+// Returns number in range [0, 1) uniquely determined by given keys.
+double uniform(uint64_t seed, int rayIndex, int numOfReflections) {
+  uint64_t hash = mix(mix(seed ^ mix(static_cast<uint64_t>(rayIndex))) ^
+                      static_cast<uint64_t>(numOfReflections));
+  // 53 most significant bits fill the whole mantissa of the double.
+  return (hash >> 11) * 0x1.0p-53;
+}
+
+} // namespace
+
+EnergyThresholdTermination::EnergyThresholdTermination(float minEnergy)
+    : minEnergy_(minEnergy) {}
+
+bool EnergyThresholdTermination::terminate(int rayIndex, int numOfReflections,
+                                           float accumulatedTime,
+                                           core::Ray *ray) const {
+  return ray->energy() < minEnergy_;
+}
+
+std::string_view EnergyThresholdTermination::name() const noexcept {
+  return "energyThreshold";
+}
+
+void EnergyThresholdTermination::printItself(std::ostream &os) const noexcept {
+  os << "Energy Threshold Termination, min energy: " << minEnergy_;
+}
+
+RussianRouletteTermination::RussianRouletteTermination(
+    int minReflections, float survivalProbability, uint64_t seed)
+    : minReflections_(minReflections),
+      survivalProbability_(survivalProbability), seed_(seed) {
+  if (minReflections < 0 ||
+      !(survivalProbability > 0 && survivalProbability <= 1)) {
+    std::stringstream errorStream;
+    errorStream << "Error in: " << *this << "\n"
+                << "Min reflections cannot be negative and survival "
+                   "probability must be in range (0, 1]!";
+    throw std::invalid_argument(errorStream.str());
+  }
+}
+
+bool RussianRouletteTermination::terminate(int rayIndex, int numOfReflections,
+                                           float accumulatedTime,
+                                           core::Ray *ray) const {
+  if (numOfReflections <= minReflections_) {
+    return false;
+  }
+  if (uniform(seed_, rayIndex, numOfReflections) >= survivalProbability_) {
+    return true;
+  }
+  ray->setEnergy(ray->energy() / survivalProbability_);
+  return false;
+}
+
+std::string_view RussianRouletteTermination::name() const noexcept {
+  return "russianRoulette";
+}
+
+void RussianRouletteTermination::printItself(std::ostream &os) const noexcept {
+  os << "Russian Roulette Termination, min reflections: " << minReflections_
+     << ", survival probability: " << survivalProbability_
+     << ", seed: " << seed_;
+}
+
+TimeGateTermination::TimeGateTermination(int sampleRate, float timeWindow,
+                                         float sphereWallRadius)
+    : sphereWallRadius_(sphereWallRadius) {
+  if (sampleRate <= 0 || !(timeWindow > 0) || !(sphereWallRadius > 0)) {
+    std::stringstream errorStream;
+    errorStream << "Sample rate, time window and sphere wall radius of "
+                   "TimeGateTermination must be greater than 0! Given: "
+                << sampleRate << ", " << timeWindow << ", " << sphereWallRadius;
+    throw std::invalid_argument(errorStream.str());
+  }
+  // End of the last bin of the histogram, with one more bin of margin for
+  // floating point errors of the accumulated time.
+  gateTime_ = (std::ceil(sampleRate * timeWindow) + 1) / sampleRate;
+}
+
+bool TimeGateTermination::terminate(int rayIndex, int numOfReflections,
+                                    float accumulatedTime,
+                                    core::Ray *ray) const {
+  // Ray reaches the sphere wall after at least this distance.
+  float distanceToWall = sphereWallRadius_ - ray->origin().magnitude();
+  return accumulatedTime + distanceToWall / constants::kSoundSpeed > gateTime_;
+}
+
+std::string_view TimeGateTermination::name() const noexcept {
+  return "timeGate";
+}
+
+void TimeGateTermination::printItself(std::ostream &os) const noexcept {
+  os << "Time Gate Termination, gate time: " << gateTime_
+     << " s, sphere wall radius: " << sphereWallRadius_;
+}
+
+TerminationSavings::TerminationSavings(
+    const std::vector<const TerminationPolicy *> &policies)
+    : numOfTerminatedRays_(policies.size()),
+      numOfSkippedReflections_(policies.size()) {
+  for (const TerminationPolicy *policy : policies) {
+    policyNames_.emplace_back(policy->name());
+  }
+}
+
+void TerminationSavings::addTerminatedRay(size_t policyIndex,
+                                          int numOfSkippedReflections) {
+  ++numOfTerminatedRays_[policyIndex];
+  numOfSkippedReflections_[policyIndex] += numOfSkippedReflections;
+}
+
+void TerminationSavings::add(const TerminationSavings &other) {
+  if (policyNames_ != other.policyNames_) {
+    std::stringstream errorStream;
+    errorStream << "Cannot add savings of different policies: " << *this
+                << " and " << other;
+    throw std::invalid_argument(errorStream.str());
+  }
+  for (size_t policy = 0; policy < policyNames_.size(); ++policy) {
+    numOfTerminatedRays_[policy] += other.numOfTerminatedRays_[policy];
+    numOfSkippedReflections_[policy] += other.numOfSkippedReflections_[policy];
+  }
+  numOfTracedReflections_ += other.numOfTracedReflections_;
+}
+
+nlohmann::json TerminationSavings::toJson() const {
+  nlohmann::json policies = nlohmann::json::array();
+  for (size_t policy = 0; policy < policyNames_.size(); ++policy) {
+    policies.push_back(
+        {{"name", policyNames_[policy]},
+         {"terminatedRays", numOfTerminatedRays_[policy]},
+         {"skippedReflections", numOfSkippedReflections_[policy]}});
+  }
+  return {{"tracedReflections", numOfTracedReflections_},
+          {"policies", policies}};
+}
+
+void TerminationSavings::printItself(std::ostream &os) const noexcept {
+  os << "Termination Savings, traced reflections: " << numOfTracedReflections_;
+  for (size_t policy = 0; policy < policyNames_.size(); ++policy) {
+    os << "\n\t" << policyNames_[policy]
+       << ": terminated rays: " << numOfTerminatedRays_[policy]
+       << ", skipped reflections: " << numOfSkippedReflections_[policy];
+  }
+}
+
+} // namespace terminationPolicies
@@ -0,0 +1,130 @@
+#ifndef TERMINATION_POLICIES_H
+#define TERMINATION_POLICIES_H
+
+#include "core/classUtlilities.h"
+#include "core/ray.h"
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Policies that stop tracing of rays before maxTracking reflections, when
+// further tracing is not worth its cost. Terminated rays are dropped: they
+// never reach the sphere wall, so they put no energy into collectors.
+namespace terminationPolicies {
+
+struct TerminationPolicy : public Printable {
+  virtual ~TerminationPolicy(){};
+
+  // Called after every reflection of the ray. |ray| is the reflected ray,
+  // which starts at the reflection point, |numOfReflections| is the number of
+  // reflections so far and |accumulatedTime| is time [s] the ray travelled.
+  // Returns true if the ray should be dropped. Policy may change energy of
+  // the surviving |ray|. Decision must depend only on given arguments, so
+  // results do not depend on the number of threads.
+  virtual bool terminate(int rayIndex, int numOfReflections,
+                         float accumulatedTime, core::Ray *ray) const = 0;
+  virtual std::string_view name() const noexcept = 0;
+};
+
+// Drops rays whose energy fell below |minEnergy|. Energy of such rays is
+// lost, so the result is biased by at most |minEnergy| per dropped ray.
+class EnergyThresholdTermination : public TerminationPolicy {
+public:
+  explicit EnergyThresholdTermination(float minEnergy);
+
+  bool terminate(int rayIndex, int numOfReflections, float accumulatedTime,
+                 core::Ray *ray) const override;
+  std::string_view name() const noexcept override;
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  float minEnergy_;
+};
+
+// Russian roulette: after |minReflections| reflections, ray survives every
+// next reflection with |survivalProbability| and energy of the surviving ray
+// is divided by |survivalProbability|, so the expected collected energy is
+// unchanged. Roulette is driven by hash of |seed|, index of the ray and
+// number of its reflections.
+// |minReflections| cannot be negative, |survivalProbability| must be in range
+// (0, 1].
+class RussianRouletteTermination : public TerminationPolicy {
+public:
+  RussianRouletteTermination(int minReflections, float survivalProbability,
+                             uint64_t seed = 0);
+
+  bool terminate(int rayIndex, int numOfReflections, float accumulatedTime,
+                 core::Ray *ray) const override;
+  std::string_view name() const noexcept override;
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  int minReflections_;
+  float survivalProbability_;
+  uint64_t seed_;
+};
+
+// Drops rays that cannot reach the sphere wall of |sphereWallRadius| before
+// the end of the energy histogram of collectors, which bin energy with
+// |sampleRate| over |timeWindow|. Such rays would put their energy outside of
+// the analysed window, so the gate does not change results.
+// |sampleRate|, |timeWindow| and |sphereWallRadius| must be greater than 0.
+class TimeGateTermination : public TerminationPolicy {
+public:
+  TimeGateTermination(int sampleRate, float timeWindow,
+                      float sphereWallRadius);
+
+  bool terminate(int rayIndex, int numOfReflections, float accumulatedTime,
+                 core::Ray *ray) const override;
+  std::string_view name() const noexcept override;
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  // Rays that cannot reach the sphere wall before this time [s] are dropped.
+  float gateTime_;
+  float sphereWallRadius_;
+};
+
+// Work saved by every policy of the simulation. Policies are asked in order,
+// so the ray is credited to the first policy that terminated it.
+class TerminationSavings : public Printable {
+public:
+  TerminationSavings() = default;
+  explicit TerminationSavings(
+      const std::vector<const TerminationPolicy *> &policies);
+
+  // |numOfSkippedReflections| is the number of reflections that ray could
+  // still be traced for, until it reached maxTracking.
+  void addTerminatedRay(size_t policyIndex, int numOfSkippedReflections);
+  void addTracedReflections(uint64_t numOfReflections) {
+    numOfTracedReflections_ += numOfReflections;
+  }
+  // Both savings must come from the same policies.
+  void add(const TerminationSavings &other);
+
+  uint64_t numOfTerminatedRays(size_t policyIndex) const {
+    return numOfTerminatedRays_[policyIndex];
+  }
+  // Upper bound of reflections that were not traced thanks to the policy.
+  uint64_t numOfSkippedReflections(size_t policyIndex) const {
+    return numOfSkippedReflections_[policyIndex];
+  }
+  uint64_t numOfTracedReflections() const { return numOfTracedReflections_; }
+  size_t numOfPolicies() const { return policyNames_.size(); }
+
+  nlohmann::json toJson() const;
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  std::vector<std::string> policyNames_;
+  std::vector<uint64_t> numOfTerminatedRays_;
+  std::vector<uint64_t> numOfSkippedReflections_;
+  uint64_t numOfTracedReflections_ = 0;
+};
+
+} // namespace terminationPolicies
+
+#endif
@@ -0,0 +1,83 @@
+#include "main/threadPool.h"
+
+#include <sstream>
+#include <stdexcept>
+
+ThreadPool::ThreadPool(int numOfThreads)
+    : numOfUnfinishedTasks_(0), stopping_(false) {
+  if (numOfThreads < 1) {
+    std::stringstream errorStream;
+    errorStream << "Number of threads in ThreadPool must be greater than 0! "
+                << "Given: " << numOfThreads;
+    throw std::invalid_argument(errorStream.str());
+  }
+  workers_.reserve(numOfThreads);
+  for (int thread = 0; thread < numOfThreads; ++thread) {
+    workers_.emplace_back(&ThreadPool::work, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  taskAvailable_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::schedule(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(std::move(task));
+    ++numOfUnfinishedTasks_;
+  }
+  taskAvailable_.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  tasksFinished_.wait(lock, [this] { return numOfUnfinishedTasks_ == 0; });
+  if (firstException_) {
+    std::exception_ptr exception = firstException_;
+    firstException_ = nullptr;
+    std::rethrow_exception(exception);
+  }
+}
+
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      taskAvailable_.wait(lock,
+                          [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop();
+    }
+
+    std::exception_ptr exception;
+    try {
+      task();
+    } catch (...) {
+      exception = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (exception && !firstException_) {
+      firstException_ = exception;
+    }
+    if (--numOfUnfinishedTasks_ == 0) {
+      tasksFinished_.notify_all();
+    }
+  }
+}
+
+void ThreadPool::printItself(std::ostream &os) const noexcept {
+  os << "Thread Pool with " << workers_.size() << " threads";
+}
@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "core/classUtlilities.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed number of worker threads that execute scheduled tasks in order of
+// scheduling. Tasks can be scheduled from any thread, including workers
+// themselves.
+class ThreadPool : public Printable {
+public:
+  // |numOfThreads| must be greater than 0.
+  explicit ThreadPool(int numOfThreads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void schedule(std::function<void()> task);
+  // Blocks until every scheduled task is finished. If any of the tasks threw
+  // an exception, first of them is rethrown here.
+  void wait();
+
+  int size() const { return workers_.size(); }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  void work();
+
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable taskAvailable_;
+  std::condition_variable tasksFinished_;
+  int numOfUnfinishedTasks_;
+  bool stopping_;
+  std::exception_ptr firstException_;
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "main/traceRecorder.h"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+namespace timeline {
+
+namespace {
+
+struct Span {
+  const char *name;
+  SpanArguments arguments;
+  int64_t startMicroseconds, durationMicroseconds;
+  int threadId;
+};
+
+struct ThreadBuffer;
+
+// Buffers of running threads and spans of threads that already finished.
+struct Registry {
+  std::mutex mutex;
+  std::unordered_set<ThreadBuffer *> buffers;
+  std::vector<Span> finishedThreadSpans;
+  int nextThreadId = 0;
+};
+
+Registry &registry() {
+  // Never destroyed, so threads that finish during static destruction can
+  // still unregister.
+  static Registry *registry = new Registry();
+  return *registry;
+}
+
+std::atomic<bool> recording(false);
+// Start of the recording, set before |recording| is set to true.
+std::chrono::steady_clock::time_point recordingStart;
+
+// Spans recorded by a single thread. Lock of the buffer is taken by its own
+// thread on every span and by other threads only when spans are collected, so
+// it is almost never contended.
+struct ThreadBuffer {
+  ThreadBuffer() {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    threadId = registry().nextThreadId++;
+    registry().buffers.insert(this);
+  }
+  ~ThreadBuffer() {
+    std::lock_guard<std::mutex> registryLock(registry().mutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    registry().finishedThreadSpans.insert(
+        registry().finishedThreadSpans.end(), spans.begin(), spans.end());
+    registry().buffers.erase(this);
+  }
+
+  std::mutex mutex;
+  std::vector<Span> spans;
+  int threadId;
+};
+
+ThreadBuffer &threadBuffer() {
+  thread_local ThreadBuffer buffer;
+  return buffer;
+}
+
+int64_t microsecondsSinceStart(std::chrono::steady_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(time -
+                                                               recordingStart)
+      .count();
+}
+
+nlohmann::json spanToJson(const Span &span) {
+  nlohmann::json arguments = nlohmann::json::object();
+  for (const auto &[name, value] : span.arguments) {
+    arguments[name] = value;
+  }
+  // Complete event, which holds both start and duration of the span.
+  return {{"name", span.name},
+          {"cat", "simulation"},
+          {"ph", "X"},
+          {"ts", span.startMicroseconds},
+          {"dur", span.durationMicroseconds},
+          {"pid", 1},
+          {"tid", span.threadId},
+          {"args", arguments}};
+}
+
+} // namespace
+
+ScopedSpan::ScopedSpan(
+    const char *name,
+    std::initializer_list<std::pair<const char *, double>> arguments)
+    : recording_(recording.load(std::memory_order_acquire)), name_(name) {
+  if (recording_) {
+    arguments_.assign(arguments.begin(), arguments.end());
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedSpan::~ScopedSpan() {
+  if (!recording_ || !recording.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  ThreadBuffer &buffer = threadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.spans.push_back(Span{name_, std::move(arguments_),
+                              microsecondsSinceStart(start_),
+                              microsecondsSinceStart(end) -
+                                  microsecondsSinceStart(start_),
+                              buffer.threadId});
+}
+
+TraceRecorder::TraceRecorder() {
+  std::lock_guard<std::mutex> registryLock(registry().mutex);
+  if (recording.load(std::memory_order_acquire)) {
+    throw std::logic_error("Only one TraceRecorder can record at a time!");
+  }
+  registry().finishedThreadSpans.clear();
+  for (ThreadBuffer *buffer : registry().buffers) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->spans.clear();
+  }
+  recordingStart = std::chrono::steady_clock::now();
+  recording.store(true, std::memory_order_release);
+}
+
+TraceRecorder::~TraceRecorder() {
+  recording.store(false, std::memory_order_release);
+}
+
+nlohmann::json TraceRecorder::toJson() const {
+  nlohmann::json events = nlohmann::json::array();
+  std::lock_guard<std::mutex> registryLock(registry().mutex);
+  for (const Span &span : registry().finishedThreadSpans) {
+    events.push_back(spanToJson(span));
+  }
+  for (ThreadBuffer *buffer : registry().buffers) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    for (const Span &span : buffer->spans) {
+      events.push_back(spanToJson(span));
+    }
+  }
+  return {{"traceEvents", events}, {"displayTimeUnit", "ms"}};
+}
+
+void TraceRecorder::save(std::string_view path) const {
+  std::ofstream file{std::string(path)};
+  if (!file.good()) {
+    std::stringstream errorStream;
+    errorStream << "Error in: " << *this << "Cannot open file at: " << path;
+    throw std::invalid_argument(errorStream.str());
+  }
+  file << toJson();
+}
+
+void TraceRecorder::printItself(std::ostream &os) const noexcept {
+  os << "Trace Recorder\n";
+}
+
+} // namespace timeline
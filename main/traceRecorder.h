@@ -0,0 +1,61 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include "core/classUtlilities.h"
+#include "nlohmann/json.hpp"
+
+#include <chrono>
+#include <initializer_list>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Timeline of the simulation in Chrome trace-event format, which can be
+// opened in Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+// Spans are recorded only while TraceRecorder exists, otherwise ScopedSpan
+// costs a single atomic load. Every thread records into its own buffer, so
+// threads recording at the same time never wait for each other.
+namespace timeline {
+
+using SpanArguments = std::vector<std::pair<const char *, double>>;
+
+// Records work done from construction to destruction as a span on the
+// timeline of the calling thread. |name| and argument names must outlive the
+// TraceRecorder, e.g. be string literals.
+class ScopedSpan {
+public:
+  explicit ScopedSpan(
+      const char *name,
+      std::initializer_list<std::pair<const char *, double>> arguments = {});
+  ~ScopedSpan();
+
+  ScopedSpan(const ScopedSpan &) = delete;
+  ScopedSpan &operator=(const ScopedSpan &) = delete;
+
+private:
+  bool recording_;
+  const char *name_;
+  SpanArguments arguments_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Spans are recorded from construction to destruction of the recorder.
+// Only one recorder can exist at a time, otherwise std::logic_error is thrown.
+class TraceRecorder : public Printable {
+public:
+  TraceRecorder();
+  ~TraceRecorder();
+
+  TraceRecorder(const TraceRecorder &) = delete;
+  TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+  // Returns every span recorded so far as Chrome trace-event JSON object.
+  nlohmann::json toJson() const;
+  // Saves toJson() at |path|.
+  void save(std::string_view path) const;
+  void printItself(std::ostream &os) const noexcept override;
+};
+
+} // namespace timeline
+
+#endif
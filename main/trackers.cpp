@@ -10,6 +10,7 @@ void ResultTracker::registerResult(std::string_view parameterName,
 }
 
 void ResultTracker::saveRaport(std::string path) const {
+  timeline::ScopedSpan span("ResultTracker::saveRaport");
   FileBuffer jsVariable;
   jsVariable.stream << raport_;
 
@@ -18,6 +19,11 @@ void ResultTracker::saveRaport(std::string path) const {
   resultJS.write(jsVariable);
 }
 
+void ResultTracker::registerTerminationSavings(
+    const terminationPolicies::TerminationSavings &savings) {
+  terminationSavings_ = savings;
+}
+
 const Json ResultTracker::generateRaport() {
 
   Json resultArray = Json::array();
@@ -35,6 +41,15 @@ const Json ResultTracker::generateRaport() {
                               {"values", parameterValues}};
     resultArray.push_back(acousticParameter);
   }
+  if (terminationSavings_) {
+    resultArray.push_back({{"name", kTerminationRaportName},
+                           {"savings", terminationSavings_->toJson()}});
+  }
+  instrumentation::Statistics statistics = instrumentation::collectStatistics();
+  if (!statistics.empty()) {
+    resultArray.push_back(
+        {{"name", kStatisticsRaportName}, {"statistics", statistics.toJson()}});
+  }
   raport_ = resultArray;
   return raport_;
 }
@@ -175,6 +190,7 @@ void endSimulation() {
 void DataExporter::saveResultsAsJson(std::string_view path,
                                      const EnergyPerFrequency &results,
                                      bool referenceModel) {
+  timeline::ScopedSpan span("DataExporter::saveResultsAsJson");
   std::string outputPath = path.data();
   outputPath += "/results.js";
 
@@ -214,6 +230,7 @@ void DataExporter::saveResultsAsJson(std::string_view path,
 
 void DataExporter::saveModelToJson(std::string_view pathToFolder,
                                    ModelInterface *model, bool referenceModel) {
+  timeline::ScopedSpan span("DataExporter::saveModelToJson");
   if (model == nullptr) {
     std::stringstream errorStream;
     errorStream << "Given model to: " << *this << "Cannot be nullptr! ";
@@ -260,6 +277,15 @@ Json DataExporter::convertTriangleToJson(
             {"z", triangle.point3().z()}}}};
 }
 
+TrackedHit TrackedHit::FromHitData(const core::RayHitData &hitData) {
+  core::Vec3 origin = hitData.origin();
+  core::Vec3 direction = hitData.direction();
+  return {{origin.x(), origin.y(), origin.z()},
+          {direction.x(), direction.y(), direction.z()},
+          hitData.energy(),
+          (origin - hitData.collisionPoint()).magnitude()};
+}
+
 void PositionTrackerInterface::printItself(std::ostream &os) const noexcept {
   os << "Position Tracker Class Inteface\n";
 }
@@ -309,23 +335,31 @@ void JsonPositionTracker::endCurrentFrequency() {
 }
 
 void JsonPositionTracker::endCurrentTracking() {
-  if (currentTracking_.size() > 1) {
+  std::vector<TrackedHit> tracking;
+  tracking.reserve(currentTracking_.size());
+  for (const core::RayHitData &hitData : currentTracking_) {
+    tracking.push_back(TrackedHit::FromHitData(hitData));
+  }
+  writeTracking(tracking);
+}
+
+void JsonPositionTracker::writeTracking(
+    const std::vector<TrackedHit> &tracking) {
+  if (tracking.size() > 1) {
     Json trackingJson = Json::array();
-    for (const core::RayHitData &hitData : currentTracking_) {
-      Json hitDataJson = {
-          {"origin",
-           {{"x", hitData.origin().x()},
-            {"y", hitData.origin().y()},
-            {"z", hitData.origin().z()}}},
-          {"direction",
-           {
-               {"x", hitData.direction().x()},
-               {"y", hitData.direction().y()},
-               {"z", hitData.direction().z()},
-           }},
-          {"energy", hitData.energy()},
-          {"length",
-           (hitData.origin() - hitData.collisionPoint()).magnitude()}};
+    for (const TrackedHit &hit : tracking) {
+      Json hitDataJson = {{"origin",
+                           {{"x", hit.origin[0]},
+                            {"y", hit.origin[1]},
+                            {"z", hit.origin[2]}}},
+                          {"direction",
+                           {
+                               {"x", hit.direction[0]},
+                               {"y", hit.direction[1]},
+                               {"z", hit.direction[2]},
+                           }},
+                          {"energy", hit.energy},
+                          {"length", hit.length}};
       trackingJson.push_back(hitDataJson);
     }
 
@@ -337,6 +371,7 @@ void JsonPositionTracker::endCurrentTracking() {
 }
 
 void JsonPositionTracker::save() {
+  timeline::ScopedSpan span("JsonPositionTracker::save");
   FileBuffer buffer = javascript::endArray();
   javascript::endLineInBuffer(buffer);
   file_.write(buffer);
@@ -398,6 +433,274 @@ void JsonSampledPositionTracker::endCurrentTracking() {
 
 void JsonSampledPositionTracker::save() { tracker_.save(); }
 
+BufferedPositionTracker::BufferedPositionTracker(
+    PositionTrackerInterface *target, std::mutex *targetMutex)
+    : target_(target), targetMutex_(targetMutex), currentTrackingSize_(0) {}
+
+BufferedPositionTracker::~BufferedPositionTracker() { flush(); }
+
+void BufferedPositionTracker::initializeNewFrequency(float frequency) {
+  flush();
+  std::lock_guard<std::mutex> lock(*targetMutex_);
+  target_->initializeNewFrequency(frequency);
+}
+
+void BufferedPositionTracker::initializeNewTracking() {
+  currentTrackingSize_ = 0;
+}
+
+void BufferedPositionTracker::addNewPositionToCurrentTracking(
+    const core::RayHitData &hitData) {
+  hits_.push_back(hitData);
+  ++currentTrackingSize_;
+}
+
+void BufferedPositionTracker::endCurrentFrequency() {
+  flush();
+  std::lock_guard<std::mutex> lock(*targetMutex_);
+  target_->endCurrentFrequency();
+}
+
+void BufferedPositionTracker::endCurrentTracking() {
+  trackingSizes_.push_back(currentTrackingSize_);
+  currentTrackingSize_ = 0;
+  if (static_cast<int>(trackingSizes_.size()) >= kNumOfTrackingsPerBatch) {
+    flush();
+  }
+}
+
+void BufferedPositionTracker::save() {
+  flush();
+  std::lock_guard<std::mutex> lock(*targetMutex_);
+  target_->save();
+}
+
+void BufferedPositionTracker::switchToReferenceModel() {
+  flush();
+  std::lock_guard<std::mutex> lock(*targetMutex_);
+  target_->switchToReferenceModel();
+}
+
+void BufferedPositionTracker::flush() {
+  if (trackingSizes_.empty()) {
+    return;
+  }
+  timeline::ScopedSpan span("BufferedPositionTracker::flush",
+                            {{"numOfTrackings", trackingSizes_.size()}});
+  std::lock_guard<std::mutex> lock(*targetMutex_);
+  std::vector<core::RayHitData>::const_iterator hit = hits_.begin();
+  for (int trackingSize : trackingSizes_) {
+    target_->initializeNewTracking();
+    for (int index = 0; index < trackingSize; ++index, ++hit) {
+      target_->addNewPositionToCurrentTracking(*hit);
+    }
+    target_->endCurrentTracking();
+  }
+  // Hits of the tracking that is not ended yet stay in the buffer.
+  hits_.erase(hits_.begin(), hit);
+  trackingSizes_.clear();
+}
+
+void BufferedPositionTracker::printItself(std::ostream &os) const noexcept {
+  os << "Buffered Position Tracker\n"
+     << "Target: " << *target_ << "\n"
+     << "Buffered trackings: " << trackingSizes_.size() << "\n";
+}
+
+BinaryPositionTracker::BinaryPositionTracker(std::string_view path)
+    : path_(std::string(path) + "/trackingData.bin"), writing_(false),
+      stopping_(false) {
+  file_.open(path_, std::ios::binary | std::ios::trunc);
+  if (!file_.good()) {
+    std::stringstream errorStream;
+    errorStream << "Error in: " << *this << "Cannot open file!";
+    throw std::invalid_argument(errorStream.str());
+  }
+  buffer_.reserve(kBufferSize);
+  buffer_.insert(buffer_.end(), std::begin(kBinaryTrackingMagic),
+                 std::end(kBinaryTrackingMagic));
+  append(kBinaryTrackingVersion);
+  writer_ = std::thread(&BinaryPositionTracker::writeRecords, this);
+}
+
+BinaryPositionTracker::~BinaryPositionTracker() {
+  flush();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  pendingBufferChanged_.notify_all();
+  writer_.join();
+}
+
+void BinaryPositionTracker::initializeNewFrequency(float frequency) {
+  append(BinaryTrackingRecord::FREQUENCY);
+  append(frequency);
+}
+
+void BinaryPositionTracker::initializeNewTracking() {
+  currentTracking_.clear();
+}
+
+void BinaryPositionTracker::addNewPositionToCurrentTracking(
+    const core::RayHitData &hitData) {
+  currentTracking_.push_back(TrackedHit::FromHitData(hitData));
+}
+
+void BinaryPositionTracker::endCurrentFrequency() {
+  append(BinaryTrackingRecord::END_FREQUENCY);
+}
+
+void BinaryPositionTracker::endCurrentTracking() {
+  append(BinaryTrackingRecord::TRACKING);
+  append(static_cast<uint32_t>(currentTracking_.size()));
+  const char *hits = reinterpret_cast<const char *>(currentTracking_.data());
+  buffer_.insert(buffer_.end(), hits,
+                 hits + currentTracking_.size() * sizeof(TrackedHit));
+  if (buffer_.size() >= kBufferSize) {
+    passBufferToWriter();
+  }
+}
+
+void BinaryPositionTracker::save() {
+  append(BinaryTrackingRecord::SAVE);
+  flush();
+}
+
+void BinaryPositionTracker::switchToReferenceModel() {
+  append(BinaryTrackingRecord::REFERENCE_MODEL);
+}
+
+void BinaryPositionTracker::flush() {
+  timeline::ScopedSpan span("BinaryPositionTracker::flush");
+  passBufferToWriter();
+  std::unique_lock<std::mutex> lock(mutex_);
+  pendingBufferChanged_.wait(
+      lock, [this] { return pendingBuffer_.empty() && !writing_; });
+  file_.flush();
+}
+
+template <typename T> void BinaryPositionTracker::append(const T &value) {
+  const char *bytes = reinterpret_cast<const char *>(&value);
+  buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+}
+
+void BinaryPositionTracker::passBufferToWriter() {
+  if (buffer_.empty()) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Simulation waits only when it is faster than the disk for the whole
+    // buffer.
+    pendingBufferChanged_.wait(lock, [this] { return pendingBuffer_.empty(); });
+    pendingBuffer_.swap(buffer_);
+  }
+  pendingBufferChanged_.notify_all();
+  buffer_.clear();
+}
+
+void BinaryPositionTracker::writeRecords() {
+  std::vector<char> records;
+  records.reserve(kBufferSize);
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pendingBufferChanged_.wait(
+          lock, [this] { return stopping_ || !pendingBuffer_.empty(); });
+      if (pendingBuffer_.empty()) {
+        return;
+      }
+      records.swap(pendingBuffer_);
+      writing_ = true;
+    }
+    pendingBufferChanged_.notify_all();
+
+    file_.write(records.data(), records.size());
+    records.clear();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      writing_ = false;
+    }
+    pendingBufferChanged_.notify_all();
+  }
+}
+
+void BinaryPositionTracker::printItself(std::ostream &os) const noexcept {
+  os << "Binary Position Tracker\n"
+     << "File: " << path_ << "\n";
+}
+
+namespace {
+
+template <typename T> T readValue(std::ifstream &file) {
+  T value;
+  file.read(reinterpret_cast<char *>(&value), sizeof(T));
+  if (!file) {
+    throw std::invalid_argument("Tracking file ends in the middle of record");
+  }
+  return value;
+}
+
+} // namespace
+
+void convertBinaryTrackingToJs(std::string_view binaryFile,
+                               std::string_view outputFolder) {
+  std::ifstream file(std::string(binaryFile), std::ios::binary);
+  char magic[sizeof(kBinaryTrackingMagic)];
+  file.read(magic, sizeof(magic));
+  if (!file || !std::equal(std::begin(magic), std::end(magic),
+                           std::begin(kBinaryTrackingMagic))) {
+    std::stringstream errorStream;
+    errorStream << "File at: " << binaryFile
+                << " is not a binary tracking file!";
+    throw std::invalid_argument(errorStream.str());
+  }
+  uint32_t version = readValue<uint32_t>(file);
+  if (version != kBinaryTrackingVersion) {
+    std::stringstream errorStream;
+    errorStream << "Unsupported version of binary tracking file: " << version
+                << ", expected: " << kBinaryTrackingVersion;
+    throw std::invalid_argument(errorStream.str());
+  }
+
+  JsonPositionTracker tracker(outputFolder);
+  std::vector<TrackedHit> tracking;
+  uint8_t record;
+  while (file.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+    switch (static_cast<BinaryTrackingRecord>(record)) {
+    case BinaryTrackingRecord::FREQUENCY:
+      tracker.initializeNewFrequency(readValue<float>(file));
+      break;
+    case BinaryTrackingRecord::END_FREQUENCY:
+      tracker.endCurrentFrequency();
+      break;
+    case BinaryTrackingRecord::TRACKING:
+      tracking.resize(readValue<uint32_t>(file));
+      file.read(reinterpret_cast<char *>(tracking.data()),
+                tracking.size() * sizeof(TrackedHit));
+      if (!file) {
+        throw std::invalid_argument(
+            "Tracking file ends in the middle of record");
+      }
+      tracker.writeTracking(tracking);
+      break;
+    case BinaryTrackingRecord::REFERENCE_MODEL:
+      tracker.switchToReferenceModel();
+      break;
+    case BinaryTrackingRecord::SAVE:
+      tracker.save();
+      break;
+    default:
+      std::stringstream errorStream;
+      errorStream << "Unknown record type in tracking file: "
+                  << static_cast<int>(record);
+      throw std::invalid_argument(errorStream.str());
+    }
+  }
+}
+
 void JsonSampledPositionTracker::switchToReferenceModel() {
   tracker_.switchToReferenceModel();
 }
@@ -423,6 +726,7 @@ bool JsonSampledPositionTracker::isSampling() const {
 // exports |energyCollectors| as string representation to |path|
 void CollectorsTrackerToJson::save(const Collectors &energyCollectors,
                                    std::string_view path) {
+  timeline::ScopedSpan span("CollectorsTrackerToJson::save");
   Json outArray = Json::array();
   int currentCollectorNumber = 0;
   for (const auto &collector : energyCollectors) {
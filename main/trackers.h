@@ -3,15 +3,25 @@
 
 #include "core/classUtlilities.h"
 #include "core/ray.h"
+#include "main/instrumentation.h"
 #include "main/model.h"
 #include "main/resultsCalculation.h"
+#include "main/terminationPolicies.h"
+#include "main/traceRecorder.h"
 #include "nlohmann/json.hpp"
 #include "obj/objects.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
 #include <fstream>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 // Contains objects and functions that are responsible for exporting calculated
 // data, objects and ray trajectories in simulation to different files. They
@@ -27,6 +37,9 @@ class ResultTracker : Printable {
 public:
   void registerResult(std::string_view parameterName,
                       const std::map<float, float> &result);
+  // Savings are reported as an element named kTerminationRaportName.
+  void registerTerminationSavings(
+      const terminationPolicies::TerminationSavings &savings);
 
   // Saves acoustic in json format
   void saveRaport(std::string path) const;
@@ -35,14 +48,21 @@ public:
   // void compareDataToReference(std::string_view path);
 
   void printItself(std::ostream &os) const noexcept override;
+  // Raport holds every registered result. When simulation was instrumented,
+  // statistics collected by instrumentation::collectStatistics() are appended
+  // as an element named kStatisticsRaportName.
   const Json generateRaport();
 
 private:
   Json raport_;
 
   std::unordered_map<std::string_view, std::map<float, float>> results_;
+  std::optional<terminationPolicies::TerminationSavings> terminationSavings_;
 };
 
+const char kStatisticsRaportName[] = "Simulation Statistics";
+const char kTerminationRaportName[] = "Ray Termination Savings";
+
 // Mediator between different type of input data File.
 // Prepares data to be saved into file
 struct FileBuffer {
@@ -149,6 +169,17 @@ struct DataExporter : Printable {
 private:
   Json convertTriangleToJson(const objects::TriangleObj &triangle) const;
 };
+// Part of the ray hit that is saved for visual representation of trackings.
+struct TrackedHit {
+  static TrackedHit FromHitData(const core::RayHitData &hitData);
+
+  float origin[3];
+  float direction[3];
+  float energy;
+  // Distance between origin of the ray and position of the hit.
+  float length;
+};
+
 // Tracks all reached position by rays in the simulation and
 // saves them to files in the given path.
 class PositionTrackerInterface : public Printable {
@@ -195,6 +226,9 @@ public:
 
   void save() override;
   void switchToReferenceModel() override;
+  // Writes whole |tracking| to the file. Trackings with less than two hits
+  // are skipped.
+  void writeTracking(const std::vector<TrackedHit> &tracking);
   void printItself(std::ostream &os) const noexcept override;
 
 private:
@@ -237,6 +271,113 @@ private:
   int currentNumberOfTracking_;
 };
 
+// Collects trackings of rays traced by one worker thread of the simulation
+// and passes them in batches to the shared |target| tracker, locking
+// |targetMutex| only once per batch. Every tracking is passed as the whole
+// initializeNewTracking(), addNewPositionToCurrentTracking(),
+// endCurrentTracking() sequence, so trackings from different threads never
+// interleave. Remaining trackings are passed on flush() or destruction.
+class BufferedPositionTracker : public PositionTrackerInterface {
+public:
+  BufferedPositionTracker(PositionTrackerInterface *target,
+                          std::mutex *targetMutex);
+  ~BufferedPositionTracker() override;
+
+  void initializeNewFrequency(float frequency) override;
+  void initializeNewTracking() override;
+  void
+  addNewPositionToCurrentTracking(const core::RayHitData &hitData) override;
+  void endCurrentFrequency() override;
+  void endCurrentTracking() override;
+  void save() override;
+  void switchToReferenceModel() override;
+
+  // Passes all buffered trackings to the target tracker.
+  void flush();
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  static const int kNumOfTrackingsPerBatch = 256;
+
+  PositionTrackerInterface *target_;
+  std::mutex *targetMutex_;
+  std::vector<core::RayHitData> hits_;
+  // Number of hits in |hits_| that belongs to each of buffered trackings.
+  std::vector<int> trackingSizes_;
+  int currentTrackingSize_;
+};
+
+// Tracks all reached rays position and saves them as compact binary records
+// to trackingData.bin file at given path. Records are collected in memory and
+// written to the file by a background thread, so the simulation does not wait
+// for the disk. Use convertBinaryTrackingToJs() to create trackingData.js file
+// for the gui. REQUIREMENTS: folder must exist at given path.
+//
+// File starts with kBinaryTrackingMagic and kBinaryTrackingVersion (uint32)
+// followed by records, each starting with BinaryTrackingRecord (uint8):
+// - FREQUENCY: float frequency,
+// - TRACKING: uint32 number of hits followed by the TrackedHit of each hit,
+// - END_FREQUENCY, REFERENCE_MODEL and SAVE: no data.
+// Values are saved in the byte order of the machine.
+class BinaryPositionTracker : public PositionTrackerInterface {
+public:
+  explicit BinaryPositionTracker(std::string_view path);
+  ~BinaryPositionTracker() override;
+
+  void initializeNewFrequency(float frequency) override;
+  void initializeNewTracking() override;
+  void
+  addNewPositionToCurrentTracking(const core::RayHitData &hitData) override;
+  void endCurrentFrequency() override;
+  void endCurrentTracking() override;
+  void save() override;
+  void switchToReferenceModel() override;
+
+  // Blocks until every record is written to the file.
+  void flush();
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  // Size of the buffer which is passed to the writer thread when full.
+  static const size_t kBufferSize = 1 << 20;
+
+  template <typename T> void append(const T &value);
+  // Passes filled buffer to the writer thread.
+  void passBufferToWriter();
+  void writeRecords();
+
+  std::string path_;
+  std::ofstream file_;
+  std::vector<TrackedHit> currentTracking_;
+  // Filled by the simulation.
+  std::vector<char> buffer_;
+  // Waiting to be written by the writer thread.
+  std::vector<char> pendingBuffer_;
+  std::mutex mutex_;
+  std::condition_variable pendingBufferChanged_;
+  bool writing_;
+  bool stopping_;
+  std::thread writer_;
+};
+
+enum class BinaryTrackingRecord : uint8_t {
+  FREQUENCY = 1,
+  END_FREQUENCY = 2,
+  TRACKING = 3,
+  REFERENCE_MODEL = 4,
+  SAVE = 5,
+};
+
+const char kBinaryTrackingMagic[4] = {'R', 'T', 'R', 'K'};
+const uint32_t kBinaryTrackingVersion = 1;
+
+// Converts |binaryFile| created by BinaryPositionTracker into trackingData.js
+// file in |outputFolder|, the same as JsonPositionTracker would create.
+// Throws std::invalid_argument when |binaryFile| cannot be read or is not a
+// valid tracking file.
+void convertBinaryTrackingToJs(std::string_view binaryFile,
+                               std::string_view outputFolder);
+
 // Saves all current collectors arrangement into file.
 struct CollectorsTrackerInterface : public Printable {
   virtual ~CollectorsTrackerInterface(){};
@@ -0,0 +1,113 @@
+#include "energyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace objects {
+
+EnergyHistogram::EnergyHistogram(int sampleRate, float timeWindow)
+    : sampleRate_(sampleRate), timeWindow_(timeWindow),
+      numOfBins_(std::ceil(sampleRate * timeWindow)), firstBin_(0),
+      energyOutsideWindow_(0) {
+  if (sampleRate <= 0 || !(timeWindow > 0)) {
+    std::stringstream errorStream;
+    errorStream << "Sample rate and time window of the energy histogram must "
+                   "be greater than 0! Sample rate: "
+                << sampleRate << ", time window: " << timeWindow;
+    throw std::invalid_argument(errorStream.str());
+  }
+}
+
+void EnergyHistogram::add(float time, float energy) {
+  float bin = std::floor(time * sampleRate_);
+  if (!(bin >= 0 && bin < numOfBins_)) {
+    energyOutsideWindow_ += energy;
+    return;
+  }
+  int binIndex = bin;
+  reserveBins(binIndex, binIndex);
+  bins_[binIndex - firstBin_] += energy;
+}
+
+void EnergyHistogram::add(const EnergyHistogram &other) {
+  if (!sameBinning(other)) {
+    std::stringstream errorStream;
+    errorStream << "Cannot add energy histograms with different binning!\n"
+                << *this << "\n"
+                << other;
+    throw std::invalid_argument(errorStream.str());
+  }
+  energyOutsideWindow_ += other.energyOutsideWindow_;
+  if (other.empty()) {
+    return;
+  }
+  reserveBins(other.firstBin(), other.endBin() - 1);
+  for (int binIndex = other.firstBin(); binIndex < other.endBin();
+       ++binIndex) {
+    bins_[binIndex - firstBin_] += other.bins_[binIndex - other.firstBin_];
+  }
+}
+
+float EnergyHistogram::at(int binIndex) const {
+  if (binIndex < firstBin() || binIndex >= endBin()) {
+    return 0;
+  }
+  return bins_[binIndex - firstBin_];
+}
+
+bool EnergyHistogram::sameBinning(const EnergyHistogram &other) const {
+  return sampleRate_ == other.sampleRate_ && numOfBins_ == other.numOfBins_;
+}
+
+bool EnergyHistogram::operator==(const EnergyHistogram &other) const {
+  if (!sameBinning(other) ||
+      energyOutsideWindow_ != other.energyOutsideWindow_) {
+    return false;
+  }
+  // Bins without energy may be stored in one histogram and not in the other.
+  int first = std::min(firstBin(), other.firstBin());
+  int end = std::max(endBin(), other.endBin());
+  for (int binIndex = first; binIndex < end; ++binIndex) {
+    if (at(binIndex) != other.at(binIndex)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void EnergyHistogram::reserveBins(int firstBin, int lastBin) {
+  if (empty()) {
+    firstBin_ = firstBin;
+    bins_.assign(lastBin - firstBin + 1, 0);
+    return;
+  }
+  if (firstBin >= firstBin_ && lastBin < endBin()) {
+    return;
+  }
+  // Range grows by at least half of its size, so energy arriving in random
+  // order of time causes only few reallocations.
+  const int margin = bins_.size() / 2;
+  int newFirstBin = firstBin_;
+  int newEndBin = endBin();
+  if (firstBin < firstBin_) {
+    newFirstBin = std::max(0, std::min(firstBin, firstBin_ - margin));
+  }
+  if (lastBin >= endBin()) {
+    newEndBin = std::min(numOfBins_, std::max(lastBin + 1, endBin() + margin));
+  }
+  std::vector<float> newBins(newEndBin - newFirstBin, 0);
+  std::copy(bins_.begin(), bins_.end(),
+            newBins.begin() + (firstBin_ - newFirstBin));
+  bins_.swap(newBins);
+  firstBin_ = newFirstBin;
+}
+
+void EnergyHistogram::printItself(std::ostream &os) const noexcept {
+  os << "Energy Histogram. Sample rate: " << sampleRate_
+     << " Hz, time window: " << timeWindow_ << " s, stored bins: ["
+     << firstBin() << ", " << endBin() << ")";
+}
+
+} // namespace objects
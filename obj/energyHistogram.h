@@ -0,0 +1,66 @@
+#ifndef ENERGY_HISTOGRAM_H
+#define ENERGY_HISTOGRAM_H
+
+#include "core/classUtlilities.h"
+
+#include <vector>
+
+namespace objects {
+
+// Sample rate at which collected energy is binned, the same as in the
+// recordings of the ISO 17497-2:2012 measurement.
+const int kDefaultSampleRate = 96000; // [Hz]
+// Energy that reaches collectors after that time is not binned.
+const float kDefaultTimeWindow = 1; // [s]
+
+// Energy collected over time, summed into bins of 1 / |sampleRate| seconds,
+// where bin of time t is floor(t * |sampleRate|). Only bins in the range
+// [0, |sampleRate| * |timeWindow|) are kept. Memory is allocated only for the
+// contiguous range of bins that received energy, so histogram of a collector
+// which is reached only in a short period of time stays small.
+class EnergyHistogram : public Printable {
+public:
+  // |sampleRate| and |timeWindow| must be greater than 0.
+  explicit EnergyHistogram(int sampleRate = kDefaultSampleRate,
+                           float timeWindow = kDefaultTimeWindow);
+
+  // Adds |energy| to the bin of |time|. Energy at the time outside of the
+  // window is not binned, it is only summed in energyOutsideWindow().
+  void add(float time, float energy);
+  // Adds every bin of |other|. Throws std::invalid_argument when histograms
+  // have different binning.
+  void add(const EnergyHistogram &other);
+
+  // Returns energy in bin at |binIndex|, 0 when nothing was collected there.
+  float at(int binIndex) const;
+  // Range [firstBin(), endBin()) contains every bin that received energy.
+  // Empty range means that nothing was collected.
+  int firstBin() const { return firstBin_; }
+  int endBin() const { return firstBin_ + bins_.size(); }
+  bool empty() const { return bins_.empty(); }
+
+  int sampleRate() const { return sampleRate_; }
+  float timeWindow() const { return timeWindow_; }
+  // Number of bins in the time window.
+  int numOfBins() const { return numOfBins_; }
+  float energyOutsideWindow() const { return energyOutsideWindow_; }
+  bool sameBinning(const EnergyHistogram &other) const;
+
+  bool operator==(const EnergyHistogram &other) const;
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  // Makes sure that bins from |firstBin| to |lastBin| are stored.
+  void reserveBins(int firstBin, int lastBin);
+
+  int sampleRate_;
+  float timeWindow_;
+  int numOfBins_;
+  int firstBin_;
+  std::vector<float> bins_;
+  float energyOutsideWindow_;
+};
+
+} // namespace objects
+
+#endif
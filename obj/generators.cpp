@@ -1,7 +1,89 @@
 #include "generators.h"
 
+#include <cmath>
+#include <cstring>
+
 namespace generators {
 
+namespace {
+
+// Comes from the requirements of the ISO 17497-2:2012, which says that point
+// source must be placed at least twice as high as the microphone radius
+// array. Because microphone radius array is equal to:
+// |kSimulationHeight| / 2 * model.height(), we can assume:
+core::Vec3 pointSpeakerOrigin(const ModelInterface &model) {
+  return core::Vec3(0, 0,
+                    std::max(static_cast<float>(constants::kSimulationHeight),
+                             constants::kSimulationHeight * model.height()));
+}
+
+// Direction from |origin| to the corner of the target region, which spans
+// 2 * model.sideSize() along x and y axis.
+core::Vec3 targetReferenceDirection(const ModelInterface &model,
+                                    const core::Vec3 &origin) {
+  float sizeFactor = -model.sideSize();
+  return core::Vec3(sizeFactor, sizeFactor, model.height()) - origin;
+}
+
+uint32_t reverseBits(uint32_t value) {
+  value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+  value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+  value = ((value >> 4) & 0x0f0f0f0fu) | ((value & 0x0f0f0f0fu) << 4);
+  value = ((value >> 8) & 0x00ff00ffu) | ((value & 0x00ff00ffu) << 8);
+  return (value >> 16) | (value << 16);
+}
+
+// Owen scrambling of the bits of |value|, where every bit is flipped
+// depending on hash of the more significant bits:
+// https://jcgt.org/published/0009/04/01/
+uint32_t owenScramble(uint32_t value, uint32_t seed) {
+  // Laine-Karras permutation scrambles each bit depending on the less
+  // significant bits, so it is applied to the reversed value.
+  value = reverseBits(value);
+  value += seed;
+  value ^= value * 0x6c50b47cu;
+  value ^= value * 0xb82f1e52u;
+  value ^= value * 0xc7afe638u;
+  value ^= value * 0x8d22f6e6u;
+  return reverseBits(value);
+}
+
+uint32_t hashSeed(uint32_t seed) {
+  seed ^= seed >> 16;
+  seed *= 0x7feb352du;
+  seed ^= seed >> 15;
+  seed *= 0x846ca68bu;
+  return seed ^ (seed >> 16);
+}
+
+// Maps 32 bits of the sequence into [0, 1) with full float precision.
+float toUnitInterval(uint32_t value) { return (value >> 8) * 0x1.0p-24f; }
+
+// Returns high and low 32 bits of |a| * |b|.
+std::pair<uint32_t, uint32_t> multiplyHighLow(uint32_t a, uint32_t b) {
+  uint64_t product = static_cast<uint64_t>(a) * b;
+  return {static_cast<uint32_t>(product >> 32),
+          static_cast<uint32_t>(product)};
+}
+
+} // namespace
+
+std::pair<float, float> scrambledSobolPoint(uint32_t index, uint32_t seed) {
+  // The first dimension of Sobol sequence is van der Corput sequence.
+  uint32_t first = reverseBits(index);
+  // The second dimension is generated by primitive polynomial x + 1, whose
+  // direction numbers are v[k] = v[k - 1] ^ (v[k - 1] >> 1).
+  uint32_t second = 0;
+  for (uint32_t direction = 1u << 31; index != 0;
+       index >>= 1, direction ^= direction >> 1) {
+    if (index & 1) {
+      second ^= direction;
+    }
+  }
+  return {toUnitInterval(owenScramble(first, hashSeed(seed))),
+          toUnitInterval(owenScramble(second, hashSeed(seed + 1)))};
+}
+
 void RandomRayOffseter::printItself(std::ostream &os) const noexcept {
   os << "Random Ray Offseter Interface Class";
 }
@@ -10,17 +92,82 @@ void FakeOffseter::printItself(std::ostream &os) const noexcept {
   os << "Fake Ray Offseter";
 }
 
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter,
+                                   std::array<uint32_t, 2> key) {
+  const uint32_t kMultiplier0 = 0xD2511F53, kMultiplier1 = 0xCD9E8D57;
+  const uint32_t kWeyl0 = 0x9E3779B9, kWeyl1 = 0xBB67AE85;
+  for (int round = 0; round < 10; ++round) {
+    if (round > 0) {
+      key[0] += kWeyl0;
+      key[1] += kWeyl1;
+    }
+    auto [high0, low0] = multiplyHighLow(kMultiplier0, counter[0]);
+    auto [high1, low1] = multiplyHighLow(kMultiplier1, counter[2]);
+    counter = {high1 ^ counter[1] ^ key[0], low1,
+               high0 ^ counter[3] ^ key[1], low0};
+  }
+  return counter;
+}
+
+StratifiedJitterOffseter::StratifiedJitterOffseter(float cellSize,
+                                                   float targetHeight,
+                                                   uint64_t seed)
+    : cellSize_(cellSize), targetHeight_(targetHeight), seed_(seed) {
+  if (cellSize < 0) {
+    std::stringstream ss;
+    ss << "|cellSize| given to StratifiedJitterOffseter cannot be less than "
+          "zero! \n|cellSize|: "
+       << cellSize;
+    throw std::invalid_argument(ss.str());
+  }
+}
+
+std::pair<float, float>
+StratifiedJitterOffseter::jitter(uint32_t rayIndex, uint32_t frequency) const {
+  std::array<uint32_t, 4> random =
+      philox4x32({rayIndex, frequency, 0, 0},
+                 {static_cast<uint32_t>(seed_),
+                  static_cast<uint32_t>(seed_ >> 32)});
+  return {(toUnitInterval(random[0]) - 0.5f) * cellSize_,
+          (toUnitInterval(random[1]) - 0.5f) * cellSize_};
+}
+
+void StratifiedJitterOffseter::offsetRay(core::Ray *ray, int rayIndex,
+                                         float frequency) const {
+  if (cellSize_ == 0) {
+    return;
+  }
+  // Frequency is keyed by its bits, so every frequency has different jitter.
+  uint32_t frequencyBits;
+  std::memcpy(&frequencyBits, &frequency, sizeof(frequencyBits));
+  auto [xJitter, yJitter] = jitter(rayIndex, frequencyBits);
+
+  const core::Vec3 origin = ray->origin();
+  const core::Vec3 direction = ray->direction();
+  float time = (targetHeight_ - origin.z()) / direction.z();
+  core::Vec3 target = ray->at(time) + core::Vec3(xJitter, yJitter, 0);
+  ray->setDirection(target - origin);
+}
+
+void StratifiedJitterOffseter::printItself(std::ostream &os) const noexcept {
+  os << "Stratified Jitter Offseter, cell size: " << cellSize_
+     << ", target height: " << targetHeight_ << ", seed: " << seed_;
+}
+
 void RayFactory::printItself(std::ostream &os) const noexcept {
   os << "Ray Factory Abstract Class";
 }
 
 PointSpeakerRayFactory::PointSpeakerRayFactory(int numOfRaysAlongEachAxis,
                                                float sourcePower,
-                                               ModelInterface *model)
+                                               ModelInterface *model,
+                                               float xGridOffset,
+                                               float yGridOffset)
     : model_(model), numOfRaysAlongEachAxis_(numOfRaysAlongEachAxis),
       currentRayIndex_(0),
       energyPerRay_(sourcePower /
-                    (numOfRaysAlongEachAxis * numOfRaysAlongEachAxis)) {
+                    (numOfRaysAlongEachAxis * numOfRaysAlongEachAxis)),
+      xGridOffset_(xGridOffset), yGridOffset_(yGridOffset) {
 
   if (numOfRaysAlongEachAxis_ <= 0) {
     std::stringstream ss;
@@ -41,46 +188,57 @@ PointSpeakerRayFactory::PointSpeakerRayFactory(int numOfRaysAlongEachAxis,
     throw std::invalid_argument("Model cannot be Empty!");
   }
 
-  // Comes from the requirements of the ISO 17497-2:2012, which says that point
-  // source must be placed at least twice as high as the microphone radius
-  // array. Because microphone radius array is equal to:
-  // |kSimulationHeight| / 2 * model.height(), we can assume:
-  origin_ =
-      core::Vec3(0, 0,
-                 std::max(static_cast<float>(constants::kSimulationHeight),
-                          constants::kSimulationHeight * model_->height()));
-
-  float sizeFactor = -model_->sideSize();
-  targetReferenceDirection_ =
-      core::Vec3(sizeFactor, sizeFactor, model->height()) - origin_;
+  origin_ = pointSpeakerOrigin(*model_);
+  targetReferenceDirection_ = targetReferenceDirection(*model_, origin_);
 };
 
 bool PointSpeakerRayFactory::genRay(core::Ray *ray) {
   if (!isRayAvailable()) {
     return false;
   }
-  *ray = core::Ray(origin_, getDirection(currentRayIndex_), energyPerRay_);
+  *ray = getRay(currentRayIndex_);
   ++currentRayIndex_;
   return true;
 }
+
+int PointSpeakerRayFactory::numOfRays() const {
+  return numOfRaysAlongEachAxis_ * numOfRaysAlongEachAxis_;
+}
+
+core::Ray PointSpeakerRayFactory::getRay(int rayIndex) const {
+  return core::Ray(origin_, getDirection(rayIndex), energyPerRay_);
+}
+
 core::Vec3 PointSpeakerRayFactory::getDirection(int currentRayIndex) const {
   if (numOfRaysAlongEachAxis_ == 1) {
-    return -core::Vec3::kZ;
+    return core::Vec3(0, 0, model_->height()) - origin_;
   }
 
   int xIndex = currentRayIndex % numOfRaysAlongEachAxis_;
   int yIndex = currentRayIndex / numOfRaysAlongEachAxis_;
 
-  float u = 2 * static_cast<float>(xIndex) / (numOfRaysAlongEachAxis_ - 1) *
-            model_->sideSize();
-  float v = 2 * static_cast<float>(yIndex) / (numOfRaysAlongEachAxis_ - 1) *
-            model_->sideSize();
+  float u = 2 * (static_cast<float>(xIndex) + xGridOffset_) /
+            (numOfRaysAlongEachAxis_ - 1) * model_->sideSize();
+  float v = 2 * (static_cast<float>(yIndex) + yGridOffset_) /
+            (numOfRaysAlongEachAxis_ - 1) * model_->sideSize();
 
   return targetReferenceDirection_ + core::Vec3(u, v, 0);
 }
 
+void PointSpeakerRayFactory::setOrigin(const core::Vec3 &origin) {
+  origin_ = origin;
+  targetReferenceDirection_ = targetReferenceDirection(*model_, origin_);
+}
+
+float PointSpeakerRayFactory::targetSpacing() const {
+  if (numOfRaysAlongEachAxis_ == 1) {
+    return 0;
+  }
+  return 2 * model_->sideSize() / (numOfRaysAlongEachAxis_ - 1);
+}
+
 bool PointSpeakerRayFactory::isRayAvailable() const {
-  return (currentRayIndex_ < numOfRaysAlongEachAxis_ * numOfRaysAlongEachAxis_);
+  return currentRayIndex_ < numOfRays();
 }
 
 void PointSpeakerRayFactory::printItself(std::ostream &os) const noexcept {
@@ -90,6 +248,165 @@ void PointSpeakerRayFactory::printItself(std::ostream &os) const noexcept {
      << "Num Of Rays Along Each Axis: " << numOfRaysAlongEachAxis_ << "\n"
      << "Current Ray Index: " << currentRayIndex_ << "\n"
      << "Energy Per Ray: " << energyPerRay_ << "\n"
+     << "Grid Offset: " << xGridOffset_ << ", " << yGridOffset_ << "\n"
+     << "Target Reference Direction: " << targetReferenceDirection_;
+}
+
+SobolRayFactory::SobolRayFactory(int numOfRays, float sourcePower,
+                                 ModelInterface *model, uint32_t seed,
+                                 uint32_t firstSequenceIndex)
+    : model_(model), numOfRays_(numOfRays), currentRayIndex_(0),
+      energyPerRay_(sourcePower / numOfRays), seed_(seed),
+      firstSequenceIndex_(firstSequenceIndex) {
+  if (numOfRays <= 0) {
+    std::stringstream ss;
+    ss << "|numOfRays| given to SobolRayFactory must be greater than zero! "
+          "\n|numOfRays|: "
+       << numOfRays;
+    throw std::invalid_argument(ss.str());
+  }
+  if (sourcePower < 0) {
+    std::stringstream ss;
+    ss << "|sourcePower| power cannot be less than zero! \n|sourcePower|: "
+       << sourcePower;
+    throw std::invalid_argument(ss.str());
+  }
+  if (model_->empty()) {
+    throw std::invalid_argument("Model cannot be Empty!");
+  }
+  origin_ = pointSpeakerOrigin(*model_);
+  targetReferenceDirection_ = targetReferenceDirection(*model_, origin_);
+}
+
+bool SobolRayFactory::genRay(core::Ray *ray) {
+  if (currentRayIndex_ >= numOfRays_) {
+    return false;
+  }
+  *ray = getRay(currentRayIndex_);
+  ++currentRayIndex_;
+  return true;
+}
+
+core::Ray SobolRayFactory::getRay(int rayIndex) const {
+  auto [u, v] = scrambledSobolPoint(firstSequenceIndex_ + rayIndex, seed_);
+  core::Vec3 target(2 * u * model_->sideSize(), 2 * v * model_->sideSize(),
+                    0);
+  return core::Ray(origin_, targetReferenceDirection_ + target,
+                   energyPerRay_);
+}
+
+PlaneWaveRayFactory::PlaneWaveRayFactory(int numOfRaysAlongEachAxis,
+                                         float sourcePower,
+                                         ModelInterface *model,
+                                         float incidenceAngle,
+                                         float azimuthAngle, float xGridOffset,
+                                         float yGridOffset)
+    : model_(model), numOfRaysAlongEachAxis_(numOfRaysAlongEachAxis),
+      currentRayIndex_(0), incidenceAngle_(incidenceAngle),
+      azimuthAngle_(azimuthAngle), xGridOffset_(xGridOffset),
+      yGridOffset_(yGridOffset) {
+  if (numOfRaysAlongEachAxis <= 0) {
+    std::stringstream ss;
+    ss << "|numOfRaysAlongEachAxis| given to PlaneWaveRayFactory must be "
+          "greater than zero! \n|numOfRaysAlongEachAxis|: "
+       << numOfRaysAlongEachAxis;
+    throw std::invalid_argument(ss.str());
+  }
+  if (sourcePower < 0) {
+    std::stringstream ss;
+    ss << "|sourcePower| power cannot be less than zero! \n|sourcePower|: "
+       << sourcePower;
+    throw std::invalid_argument(ss.str());
+  }
+  if (incidenceAngle < 0 || incidenceAngle >= constants::kPi / 2) {
+    std::stringstream ss;
+    ss << "|incidenceAngle| given to PlaneWaveRayFactory must be in range "
+          "[0, pi / 2)! \n|incidenceAngle|: "
+       << incidenceAngle;
+    throw std::invalid_argument(ss.str());
+  }
+  if (model_->empty()) {
+    throw std::invalid_argument("Model cannot be Empty!");
+  }
+  energyPerRay_ =
+      sourcePower / (numOfRaysAlongEachAxis * numOfRaysAlongEachAxis);
+  direction_ = core::Vec3(std::sin(incidenceAngle) * std::cos(azimuthAngle),
+                          std::sin(incidenceAngle) * std::sin(azimuthAngle),
+                          -std::cos(incidenceAngle));
+  origin_ = pointSpeakerOrigin(*model_);
+
+  // Footprint covers the top of the model and its bottom projected along the
+  // rays at the top plane, so oblique rays hit the sides of the model too.
+  const float shift = model_->height() * std::tan(incidenceAngle);
+  const float xShift = -shift * std::cos(azimuthAngle);
+  const float yShift = -shift * std::sin(azimuthAngle);
+  minX_ = -model_->sideSize() + std::min(0.0f, xShift);
+  minY_ = -model_->sideSize() + std::min(0.0f, yShift);
+  sizeX_ = 2 * model_->sideSize() + std::abs(xShift);
+  sizeY_ = 2 * model_->sideSize() + std::abs(yShift);
+}
+
+bool PlaneWaveRayFactory::genRay(core::Ray *ray) {
+  if (currentRayIndex_ >= numOfRays()) {
+    return false;
+  }
+  *ray = getRay(currentRayIndex_);
+  ++currentRayIndex_;
+  return true;
+}
+
+int PlaneWaveRayFactory::numOfRays() const {
+  return numOfRaysAlongEachAxis_ * numOfRaysAlongEachAxis_;
+}
+
+core::Ray PlaneWaveRayFactory::getRay(int rayIndex) const {
+  const float numOfCells = numOfRaysAlongEachAxis_;
+  // Shifted targets are wrapped around the footprint, so they never miss it.
+  auto cellPosition = [numOfCells](int index, float offset) {
+    return std::fmod(index + 0.5f + offset + numOfCells, numOfCells) /
+           numOfCells;
+  };
+  core::Vec3 target(
+      minX_ + cellPosition(rayIndex % numOfRaysAlongEachAxis_, xGridOffset_) *
+                  sizeX_,
+      minY_ + cellPosition(rayIndex / numOfRaysAlongEachAxis_, yGridOffset_) *
+                  sizeY_,
+      model_->height());
+  // Moves target back along the ray to the wavefront.
+  float distanceToWavefront = (target - origin_).scalarProduct(direction_);
+  return core::Ray(target - distanceToWavefront * direction_, direction_,
+                   energyPerRay_);
+}
+
+void PlaneWaveRayFactory::printItself(std::ostream &os) const noexcept {
+  os << "PLANE WAVE RAY FACTORY\n"
+     << "Model: " << *(model_) << "\n"
+     << "Wavefront Origin: " << origin_ << "\n"
+     << "Direction: " << direction_ << "\n"
+     << "Incidence Angle: " << incidenceAngle_ << " rad\n"
+     << "Azimuth Angle: " << azimuthAngle_ << " rad\n"
+     << "Num Of Rays Along Each Axis: " << numOfRaysAlongEachAxis_ << "\n"
+     << "Current Ray Index: " << currentRayIndex_ << "\n"
+     << "Energy Per Ray: " << energyPerRay_ << "\n"
+     << "Grid Offset: " << xGridOffset_ << ", " << yGridOffset_ << "\n"
+     << "Footprint: " << sizeX_ << " x " << sizeY_ << " from " << minX_
+     << ", " << minY_;
+}
+
+void SobolRayFactory::setOrigin(const core::Vec3 &origin) {
+  origin_ = origin;
+  targetReferenceDirection_ = targetReferenceDirection(*model_, origin_);
+}
+
+void SobolRayFactory::printItself(std::ostream &os) const noexcept {
+  os << "SOBOL RAY FACTORY\n"
+     << "Model: " << *(model_) << "\n"
+     << "Origin: " << origin_ << "\n"
+     << "Num Of Rays: " << numOfRays_ << "\n"
+     << "Current Ray Index: " << currentRayIndex_ << "\n"
+     << "Energy Per Ray: " << energyPerRay_ << "\n"
+     << "Seed: " << seed_ << "\n"
+     << "First Sequence Index: " << firstSequenceIndex_ << "\n"
      << "Target Reference Direction: " << targetReferenceDirection_;
 }
 } // namespace generators
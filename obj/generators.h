@@ -7,9 +7,12 @@
 #include "core/vec3.h"
 #include "main/model.h"
 
+#include <array>
+#include <cstdint>
 #include <exception>
 #include <iostream>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 namespace generators {
@@ -20,6 +23,11 @@ public:
     ray->setDirection(ray->direction() +
                       core::Vec3(getNextAxisOffset(), getNextAxisOffset(), 0));
   }
+  // Offsets ray at |rayIndex| of the source traced at |frequency|. Offset
+  // must depend only on given arguments, so the ray can be offset from any
+  // thread and regenerated independently of other rays. Rays are not offset
+  // by default.
+  virtual void offsetRay(core::Ray *ray, int rayIndex, float frequency) const {}
 
   void printItself(std::ostream &os) const noexcept override;
 
@@ -35,9 +43,54 @@ protected:
   void printItself(std::ostream &os) const noexcept override;
 };
 
+// Philox4x32-10 counter based random number generator:
+// https://www.thesalmons.org/john/random123/papers/random123sc11.pdf
+// Returns 4 random words uniquely determined by |counter| and |key|.
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter,
+                                   std::array<uint32_t, 2> key);
+
+// Stratified jitter: target of every ray at the plane z = |targetHeight| is
+// moved to uniformly random position in the square cell of side |cellSize|
+// centered at the original target. When cell size is equal to the distance
+// between neighbouring targets, e.g. PointSpeakerRayFactory::targetSpacing(),
+// every cell is sampled exactly once.
+// Random numbers are generated by Philox keyed on |seed|, index of the ray
+// and frequency, so results of the simulation do not depend on number of
+// threads or order of tracing and are reproducible for a given seed.
+// |cellSize| cannot be less then 0, rays must not be parallel to the plane.
+class StratifiedJitterOffseter : public RandomRayOffseter {
+public:
+  StratifiedJitterOffseter(float cellSize, float targetHeight,
+                           uint64_t seed = 0);
+
+  using RandomRayOffseter::offsetRay;
+  void offsetRay(core::Ray *ray, int rayIndex, float frequency) const override;
+  void printItself(std::ostream &os) const noexcept override;
+
+protected:
+  // Rays are offset only by the indexed offsetRay(), so the stateful one
+  // leaves them unchanged.
+  float getNextAxisOffset() override { return 0; }
+
+private:
+  // Returns jitter of the ray along x and y axis, in range
+  // [-|cellSize_| / 2, |cellSize_| / 2).
+  std::pair<float, float> jitter(uint32_t rayIndex, uint32_t frequency) const;
+
+  float cellSize_;
+  float targetHeight_;
+  uint64_t seed_;
+};
+
 class RayFactory : public Printable {
 public:
   virtual bool genRay(core::Ray *ray) = 0;
+  // Number of rays produced by the factory.
+  virtual int numOfRays() const = 0;
+  // Returns ray at given |rayIndex| without changing the state of the factory,
+  // so rays can be generated independently from many threads. |rayIndex| must
+  // be in range [0, numOfRays()).
+  virtual core::Ray getRay(int rayIndex) const = 0;
   virtual core::Vec3 origin() const = 0;
   void printItself(std::ostream &os) const noexcept override;
 
@@ -53,12 +106,22 @@ public:
   // |sourcePower| cannot be less then 0,
   //               represents power of the source in [W],
   // |model| must not be empty.
+  // |xGridOffset| and |yGridOffset| shift the grid of ray targets by given
+  // fraction of the distance between neighbouring targets, so shifted
+  // factories trace different rays of the same density.
   PointSpeakerRayFactory(int numOfRaysAlongEachAxis, float sourcePower,
-                         ModelInterface *model);
+                         ModelInterface *model, float xGridOffset = 0,
+                         float yGridOffset = 0);
 
   [[nodiscard]] bool genRay(core::Ray *ray) override;
+  int numOfRays() const override;
+  core::Ray getRay(int rayIndex) const override;
+  // Distance between neighbouring targets of rays, 0 for a single ray.
+  float targetSpacing() const;
 
   core::Vec3 origin() const override { return origin_; }
+  // Moves the source to |origin|, rays are still aimed at the same targets.
+  void setOrigin(const core::Vec3 &origin);
   void printItself(std::ostream &os) const noexcept override;
 
 private:
@@ -70,9 +133,93 @@ private:
   int numOfRaysAlongEachAxis_;
   int currentRayIndex_;
   float energyPerRay_;
+  float xGridOffset_, yGridOffset_;
+  core::Vec3 targetReferenceDirection_;
+};
+
+// Point speaker at the same origin as PointSpeakerRayFactory, which aims
+// rays at the same target region, but at points of 2D Sobol sequence instead
+// of the regular grid. Sequence is scrambled with hash based Owen scrambling
+// driven by |seed|, so it does not alias with periodic structures of the
+// model and different seeds give independent samples.
+// Every prefix of the sequence covers the target region uniformly, so any
+// contiguous range of ray indices is a valid sample on its own, especially
+// ranges of 2^k rays starting at multiple of 2^k. Ray at |rayIndex| is aimed
+// at the point of the sequence at |firstSequenceIndex| + |rayIndex|.
+// |numOfRays| must be greater than 0, |sourcePower| cannot be less then 0
+// and |model| must not be empty.
+class SobolRayFactory : public RayFactory {
+public:
+  SobolRayFactory(int numOfRays, float sourcePower, ModelInterface *model,
+                  uint32_t seed = 0, uint32_t firstSequenceIndex = 0);
+
+  [[nodiscard]] bool genRay(core::Ray *ray) override;
+  int numOfRays() const override { return numOfRays_; }
+  core::Ray getRay(int rayIndex) const override;
+
+  core::Vec3 origin() const override { return origin_; }
+  // Moves the source to |origin|, rays are still aimed at the same targets.
+  void setOrigin(const core::Vec3 &origin);
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  ModelInterface *model_;
+  core::Vec3 origin_;
+  int numOfRays_;
+  int currentRayIndex_;
+  float energyPerRay_;
+  uint32_t seed_;
+  uint32_t firstSequenceIndex_;
   core::Vec3 targetReferenceDirection_;
 };
 
+// Plane wave source, which emits parallel rays at |incidenceAngle| from the
+// vertical, rotated by |azimuthAngle| around z axis, both in radians. Rays are
+// aimed at centers of the |numOfRaysAlongEachAxis|^2 cells of the model
+// footprint projected along the rays at the plane z = model.height(), so
+// every ray hits the model instead of passing by it. Every cell has the same
+// area, so power of the source is divided equally between rays.
+// Rays start at the common wavefront, which passes through the origin of
+// PointSpeakerRayFactory, so arrival times are the same as of the plane wave.
+// |xGridOffset| and |yGridOffset| shift the grid as in PointSpeakerRayFactory,
+// targets shifted out of the footprint wrap around to its other side.
+// |numOfRaysAlongEachAxis| must be greater than 0, |sourcePower| cannot be
+// less then 0, |incidenceAngle| must be in range [0, pi / 2) and |model|
+// must not be empty.
+class PlaneWaveRayFactory : public RayFactory {
+public:
+  PlaneWaveRayFactory(int numOfRaysAlongEachAxis, float sourcePower,
+                      ModelInterface *model, float incidenceAngle = 0,
+                      float azimuthAngle = 0, float xGridOffset = 0,
+                      float yGridOffset = 0);
+
+  [[nodiscard]] bool genRay(core::Ray *ray) override;
+  int numOfRays() const override;
+  core::Ray getRay(int rayIndex) const override;
+  core::Vec3 direction() const { return direction_; }
+
+  // Center of the wavefront the rays start at.
+  core::Vec3 origin() const override { return origin_; }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  ModelInterface *model_;
+  core::Vec3 origin_;
+  core::Vec3 direction_;
+  int numOfRaysAlongEachAxis_;
+  int currentRayIndex_;
+  float energyPerRay_;
+  float incidenceAngle_, azimuthAngle_;
+  float xGridOffset_, yGridOffset_;
+  // Corner and size of the projected footprint of the model.
+  float minX_, minY_;
+  float sizeX_, sizeY_;
+};
+
+// Returns point of the 2D Sobol sequence at |index|, scrambled with |seed|.
+// Both coordinates are in range [0, 1).
+std::pair<float, float> scrambledSobolPoint(uint32_t index, uint32_t seed);
+
 } // namespace generators
 
 #endif
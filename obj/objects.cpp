@@ -110,25 +110,19 @@ void EnergyCollector::collectEnergy(const core::RayHitData &hitdata) {
   addEnergy(time, energy);
 }
 
-void EnergyCollector::setEnergy(const EnergyPerTime &energyPerTime) {
-  collectedEnergy_ = energyPerTime;
+void EnergyCollector::setEnergy(const EnergyHistogram &energy) {
+  collectedEnergy_ = energy;
 }
-const EnergyPerTime &EnergyCollector::getEnergy() const {
+const EnergyHistogram &EnergyCollector::getEnergy() const {
   return collectedEnergy_;
 }
 // TODO: WHATS THE POINT OF THIS IF I HAVE COLLECT ENERGY????
 void EnergyCollector::addEnergy(float acquisitionTime, float energy) {
-  std::unordered_map<float, float>::iterator it =
-      collectedEnergy_.find(acquisitionTime);
-
-  if (it == collectedEnergy_.end()) {
-    auto energyPerTimeSample = std::make_pair<float, float>(
-        std::move(acquisitionTime), std::move(energy));
-    collectedEnergy_.insert(energyPerTimeSample);
+  collectedEnergy_.add(acquisitionTime, energy);
+}
 
-  } else {
-    it->second += energy;
-  }
+void EnergyCollector::addEnergy(const EnergyHistogram &energy) {
+  collectedEnergy_.add(energy);
 }
 
 TriangleObj::TriangleObj(const core::Vec3 &point1, const core::Vec3 &point2,
@@ -138,6 +132,14 @@ TriangleObj::TriangleObj(const core::Vec3 &point1, const core::Vec3 &point2,
   refreshAttributes();
 }
 
+TriangleObj::TriangleObj(const core::Vec3 &point1, const core::Vec3 &point2,
+                         const core::Vec3 &point3, const core::Vec3 &normal,
+                         float area)
+    : normal_(normal), point1_(point1), point2_(point2), point3_(point3),
+      area_(area) {
+  setOrigin((point1_ + point2_ + point3_) / 3);
+}
+
 TriangleObj::TriangleObj(const TriangleObj &other) { *this = other; }
 
 TriangleObj &TriangleObj::operator=(const TriangleObj &other) {
@@ -228,10 +230,15 @@ void TriangleObj::refreshAttributes() {
   this->setOrigin((point1_ + point2_ + point3_) / 3);
 }
 
+float TriangleObj::Area(const core::Vec3 &point1, const core::Vec3 &point2,
+                        const core::Vec3 &point3) {
+  core::Vec3 vecA = point1 - point2;
+  core::Vec3 vecB = point1 - point3;
+  return vecA.crossProduct(vecB).magnitude() / 2;
+}
+
 void TriangleObj::recalculateArea() {
-  core::Vec3 vecA = point1_ - point2_;
-  core::Vec3 vecB = point1_ - point3_;
-  area_ = vecA.crossProduct(vecB).magnitude() / 2;
+  area_ = Area(point1_, point2_, point3_);
 }
 
 void TriangleObj::recalculateNormal() {
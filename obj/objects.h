@@ -5,6 +5,7 @@
 #include "core/constants.h"
 #include "core/ray.h"
 #include "core/vec3.h"
+#include "obj/energyHistogram.h"
 
 #include <algorithm>
 #include <cmath>
@@ -14,9 +15,6 @@
 
 namespace objects {
 
-// TODO: What it represents?
-using EnergyPerTime = std::unordered_map<float, float>;
-
 class Object : public Printable {
 public:
   virtual ~Object(){};
@@ -65,10 +63,14 @@ protected:
   void printItself(std::ostream &os) const noexcept override;
 };
 
+// Collects energy of the rays into the EnergyHistogram with given
+// |sampleRate| and |timeWindow|.
 class EnergyCollector : public Sphere {
 public:
-  explicit EnergyCollector(const core::Vec3 &origin, float radius)
-      : Sphere(origin, radius) {
+  explicit EnergyCollector(const core::Vec3 &origin, float radius,
+                           int sampleRate = kDefaultSampleRate,
+                           float timeWindow = kDefaultTimeWindow)
+      : Sphere(origin, radius), collectedEnergy_(sampleRate, timeWindow) {
     setRadius(radius);
     setOrigin(origin);
   }
@@ -79,13 +81,16 @@ public:
   float distanceAt(const core::Vec3 &positionHit) const;
   void collectEnergy(const core::RayHitData &hitdata);
 
-  void setEnergy(const EnergyPerTime &en);
-  const EnergyPerTime &getEnergy() const;
+  void setEnergy(const EnergyHistogram &energy);
+  const EnergyHistogram &getEnergy() const;
   void addEnergy(float acquisitionTime, float energy);
+  // Adds every bin of |energy| to the collected energy. |energy| must have
+  // the same binning as the collector.
+  void addEnergy(const EnergyHistogram &energy);
   void printItself(std::ostream &os) const noexcept override;
 
 private:
-  EnergyPerTime collectedEnergy_;
+  EnergyHistogram collectedEnergy_;
 };
 
 class TriangleObj : public Object {
@@ -93,6 +98,10 @@ public:
   TriangleObj(const core::Vec3 &point1 = core::Vec3::kX,
               const core::Vec3 &point2 = core::Vec3::kY,
               const core::Vec3 &point3 = core::Vec3::kZ);
+  // Creates triangle with |normal| and |area| computed earlier for the same
+  // points, e.g. read from the scene cache. Points are not validated.
+  TriangleObj(const core::Vec3 &point1, const core::Vec3 &point2,
+              const core::Vec3 &point3, const core::Vec3 &normal, float area);
   TriangleObj(const TriangleObj &other);
 
   TriangleObj &operator=(const TriangleObj &other);
@@ -107,6 +116,11 @@ public:
   float area() const;
   void refreshAttributes();
 
+  // Area of the triangle with given vertices. Triangles with area smaller
+  // than constants::kAccuracy are degenerated and cannot be created.
+  static float Area(const core::Vec3 &point1, const core::Vec3 &point2,
+                    const core::Vec3 &point3);
+
   core::Vec3 point1() const;
   void setPoint1(const core::Vec3 &point);
 
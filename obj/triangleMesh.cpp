@@ -0,0 +1,139 @@
+#include "triangleMesh.h"
+
+namespace objects {
+
+TriangleMesh::TriangleMesh(const std::vector<TriangleObj> &triangles) {
+  for (std::vector<float> *array : mutableArrays()) {
+    array->reserve(triangles.size());
+  }
+
+  for (const TriangleObj &triangle : triangles) {
+    core::Vec3 edge1 = triangle.point2() - triangle.point1();
+    core::Vec3 edge2 = triangle.point3() - triangle.point1();
+    // The same orientation as TriangleObj::normal(), which is equal to
+    // (point1 - point2) x (point1 - point3) = edge1 x edge2.
+    core::Vec3 normal = triangle.normal();
+
+    vertexX_.push_back(triangle.point1().x());
+    vertexY_.push_back(triangle.point1().y());
+    vertexZ_.push_back(triangle.point1().z());
+    edge1X_.push_back(edge1.x());
+    edge1Y_.push_back(edge1.y());
+    edge1Z_.push_back(edge1.z());
+    edge2X_.push_back(edge2.x());
+    edge2Y_.push_back(edge2.y());
+    edge2Z_.push_back(edge2.z());
+    normalX_.push_back(normal.x());
+    normalY_.push_back(normal.y());
+    normalZ_.push_back(normal.z());
+  }
+}
+
+TriangleMesh::TriangleMesh(std::vector<std::vector<float>> arrays) {
+  if (arrays.size() != kNumOfArrays ||
+      std::any_of(arrays.begin(), arrays.end(),
+                  [&arrays](const std::vector<float> &array) {
+                    return array.size() != arrays.front().size();
+                  })) {
+    std::stringstream errorStream;
+    errorStream << "TriangleMesh must be created from " << kNumOfArrays
+                << " arrays of the same size!";
+    throw std::invalid_argument(errorStream.str());
+  }
+  std::vector<std::vector<float> *> meshArrays = mutableArrays();
+  for (int array = 0; array < kNumOfArrays; ++array) {
+    *meshArrays[array] = std::move(arrays[array]);
+  }
+}
+
+std::vector<const std::vector<float> *> TriangleMesh::arrays() const {
+  return {&vertexX_, &vertexY_, &vertexZ_, &edge1X_, &edge1Y_, &edge1Z_,
+          &edge2X_,  &edge2Y_,  &edge2Z_,  &normalX_, &normalY_, &normalZ_};
+}
+
+std::vector<std::vector<float> *> TriangleMesh::mutableArrays() {
+  return {&vertexX_, &vertexY_, &vertexZ_, &edge1X_, &edge1Y_, &edge1Z_,
+          &edge2X_,  &edge2Y_,  &edge2Z_,  &normalX_, &normalY_, &normalZ_};
+}
+
+bool TriangleMesh::intersect(size_t index, const float origin[3],
+                             const float direction[3], float *time) const {
+  // if ray direction is parpedicular to normal, there is no hit.
+  float normalDot = direction[0] * normalX_[index] +
+                    direction[1] * normalY_[index] +
+                    direction[2] * normalZ_[index];
+  if (std::abs(normalDot) <= constants::kAccuracy) {
+    return false;
+  }
+
+  const float edge1[3] = {edge1X_[index], edge1Y_[index], edge1Z_[index]};
+  const float edge2[3] = {edge2X_[index], edge2Y_[index], edge2Z_[index]};
+
+  // pVec = direction x edge2
+  const float pVec[3] = {direction[1] * edge2[2] - direction[2] * edge2[1],
+                         direction[2] * edge2[0] - direction[0] * edge2[2],
+                         direction[0] * edge2[1] - direction[1] * edge2[0]};
+  const float inverseDeterminant =
+      1.0f / (edge1[0] * pVec[0] + edge1[1] * pVec[1] + edge1[2] * pVec[2]);
+
+  const float tVec[3] = {origin[0] - vertexX_[index],
+                         origin[1] - vertexY_[index],
+                         origin[2] - vertexZ_[index]};
+  float u = (tVec[0] * pVec[0] + tVec[1] * pVec[1] + tVec[2] * pVec[2]) *
+            inverseDeterminant;
+  if (u < -kBarycentricAccuracy || u > 1 + kBarycentricAccuracy) {
+    return false;
+  }
+
+  // qVec = tVec x edge1
+  const float qVec[3] = {tVec[1] * edge1[2] - tVec[2] * edge1[1],
+                         tVec[2] * edge1[0] - tVec[0] * edge1[2],
+                         tVec[0] * edge1[1] - tVec[1] * edge1[0]};
+  float v = (direction[0] * qVec[0] + direction[1] * qVec[1] +
+             direction[2] * qVec[2]) *
+            inverseDeterminant;
+  if (v < -kBarycentricAccuracy || u + v > 1 + kBarycentricAccuracy) {
+    return false;
+  }
+
+  float hitTime =
+      (edge2[0] * qVec[0] + edge2[1] * qVec[1] + edge2[2] * qVec[2]) *
+      inverseDeterminant;
+
+  // Following code is making sure that ray doesn't hit the same object.
+  if (hitTime < constants::kAccuracy) {
+    return false;
+  }
+  *time = hitTime;
+  return true;
+}
+
+core::Vec3 TriangleMesh::normal(size_t index) const {
+  return core::Vec3(normalX_[index], normalY_[index], normalZ_[index]);
+}
+
+core::Vec3 TriangleMesh::point1(size_t index) const {
+  return core::Vec3(vertexX_[index], vertexY_[index], vertexZ_[index]);
+}
+
+core::Vec3 TriangleMesh::point2(size_t index) const {
+  return point1(index) +
+         core::Vec3(edge1X_[index], edge1Y_[index], edge1Z_[index]);
+}
+
+core::Vec3 TriangleMesh::point3(size_t index) const {
+  return point1(index) +
+         core::Vec3(edge2X_[index], edge2Y_[index], edge2Z_[index]);
+}
+
+float TriangleMesh::longestEdge(size_t index) const {
+  return std::max({(point2(index) - point1(index)).magnitude(),
+                   (point3(index) - point2(index)).magnitude(),
+                   (point1(index) - point3(index)).magnitude()});
+}
+
+void TriangleMesh::printItself(std::ostream &os) const noexcept {
+  os << "Triangle Mesh with " << size() << " triangles";
+}
+
+} // namespace objects
@@ -0,0 +1,70 @@
+#ifndef TRIANGLE_MESH_H
+#define TRIANGLE_MESH_H
+
+#include "core/classUtlilities.h"
+#include "core/constants.h"
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "obj/objects.h"
+
+#include <vector>
+
+namespace objects {
+
+// Compiled, immutable representation of the model triangles used by the ray
+// tracer. Data is stored as structure of arrays, with first vertex, both
+// edges and unit normal of every triangle precomputed, so a ray-triangle test
+// needs neither square roots nor virtual calls. Triangle at |index| in the
+// mesh is the triangle at |index| in the vector it was compiled from.
+class TriangleMesh : public Printable {
+public:
+  // Number of arrays returned by arrays().
+  static const int kNumOfArrays = 12;
+
+  explicit TriangleMesh(const std::vector<TriangleObj> &triangles);
+  // Creates mesh from |arrays| returned by arrays() of other mesh, e.g. read
+  // from the scene cache. Throws std::invalid_argument if there are not
+  // kNumOfArrays arrays of the same size.
+  explicit TriangleMesh(std::vector<std::vector<float>> arrays);
+
+  // Möller–Trumbore ray-triangle intersection:
+  // https://cadxfem.org/inf/Fast%20MinimumStorage%20RayTriangle%20Intersection.pdf
+  // Returns true if ray with given |origin| and normalized |direction| hits
+  // triangle at |index|. |time| is set to the time of the hit. The same rules
+  // as in TriangleObj::hitObject() apply: rays parallel to the triangle and
+  // hits closer than constants::kAccuracy are rejected.
+  bool intersect(size_t index, const float origin[3], const float direction[3],
+                 float *time) const;
+
+  core::Vec3 normal(size_t index) const;
+  core::Vec3 point1(size_t index) const;
+  core::Vec3 point2(size_t index) const;
+  core::Vec3 point3(size_t index) const;
+  // Length of the longest edge of the triangle at |index|.
+  float longestEdge(size_t index) const;
+
+  // Every array of the mesh data: first vertex, first edge, second edge and
+  // normal, each of them as x, y and z array.
+  std::vector<const std::vector<float> *> arrays() const;
+
+  size_t size() const { return vertexX_.size(); }
+  bool empty() const { return vertexX_.empty(); }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  std::vector<std::vector<float> *> mutableArrays();
+
+  std::vector<float> vertexX_, vertexY_, vertexZ_;
+  std::vector<float> edge1X_, edge1Y_, edge1Z_;
+  std::vector<float> edge2X_, edge2Y_, edge2Z_;
+  std::vector<float> normalX_, normalY_, normalZ_;
+};
+
+// Barycentric coordinates of the hit point may exceed triangle borders by
+// that value, so rays that hit the shared edge of two triangles never leak
+// between them because of the floating point errors.
+const float kBarycentricAccuracy = 1e-6;
+
+} // namespace objects
+
+#endif
@@ -0,0 +1,167 @@
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "main/boundingVolumeHierarchy.h"
+#include "main/model.h"
+#include "main/rayTracer.h"
+#include "obj/objects.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using core::Ray;
+using core::RayHitData;
+using core::Vec3;
+using objects::TriangleObj;
+
+const float kSkipFrequency = 1000;
+
+class BoundingVolumeHierarchyTest : public ::testing::Test {
+protected:
+  // Creates square well diffusor made of |numOfWells|^2 wells at random
+  // depths, where every well is made of bottom square and four walls.
+  std::vector<TriangleObj> createDiffusor(int numOfWells) {
+    std::vector<TriangleObj> triangles;
+    std::uniform_real_distribution<float> depth(0.05, 0.3);
+    const float wellSize = 1.0f / numOfWells;
+    for (int xIndex = 0; xIndex < numOfWells; ++xIndex) {
+      for (int yIndex = 0; yIndex < numOfWells; ++yIndex) {
+        float x0 = -0.5f + xIndex * wellSize, x1 = x0 + wellSize;
+        float y0 = -0.5f + yIndex * wellSize, y1 = y0 + wellSize;
+        float z = depth(generator_);
+        addQuad(Vec3(x0, y0, z), Vec3(x1, y0, z), Vec3(x1, y1, z),
+                Vec3(x0, y1, z), &triangles);
+        addQuad(Vec3(x0, y0, 0), Vec3(x1, y0, 0), Vec3(x1, y0, z),
+                Vec3(x0, y0, z), &triangles);
+        addQuad(Vec3(x0, y0, 0), Vec3(x0, y1, 0), Vec3(x0, y1, z),
+                Vec3(x0, y0, z), &triangles);
+      }
+    }
+    return triangles;
+  }
+
+  std::vector<TriangleObj> createRandomTriangles(int numOfTriangles) {
+    std::vector<TriangleObj> triangles;
+    std::uniform_real_distribution<float> position(-2, 2);
+    std::uniform_real_distribution<float> offset(-0.3, 0.3);
+    while (static_cast<int>(triangles.size()) < numOfTriangles) {
+      Vec3 center(position(generator_), position(generator_),
+                  position(generator_));
+      Vec3 point1 = center + Vec3(offset(generator_), offset(generator_),
+                                  offset(generator_));
+      Vec3 point2 = center + Vec3(offset(generator_), offset(generator_),
+                                  offset(generator_));
+      Vec3 point3 = center + Vec3(offset(generator_), offset(generator_),
+                                  offset(generator_));
+      try {
+        triangles.push_back(TriangleObj(point1, point2, point3));
+      } catch (const std::invalid_argument &e) {
+        // skip degenerated triangle
+      }
+    }
+    return triangles;
+  }
+
+  Ray createRandomRay() {
+    std::uniform_real_distribution<float> position(-4, 4);
+    std::uniform_real_distribution<float> target(-1, 1);
+    Vec3 origin(position(generator_), position(generator_),
+                position(generator_));
+    Vec3 direction =
+        Vec3(target(generator_), target(generator_), target(generator_)) -
+        origin;
+    return Ray(origin, direction, /*energy=*/1);
+  }
+
+  // Traces |numOfRays| random rays with both brute force and BVH tracer and
+  // expects exactly the same results.
+  void expectSameHits(ModelInterface *model, int numOfRays) {
+    RayTracer bruteForce(model, RayTracer::Acceleration::BRUTE_FORCE);
+    RayTracer hierarchy(model,
+                        RayTracer::Acceleration::BOUNDING_VOLUME_HIERARCHY);
+
+    int numOfHits = 0;
+    for (int rayIndex = 0; rayIndex < numOfRays; ++rayIndex) {
+      Ray ray = createRandomRay();
+      RayHitData bruteForceHit, hierarchyHit;
+      RayTracer::TraceResult bruteForceResult =
+          bruteForce.rayTrace(ray, kSkipFrequency, &bruteForceHit);
+      RayTracer::TraceResult hierarchyResult =
+          hierarchy.rayTrace(ray, kSkipFrequency, &hierarchyHit);
+
+      ASSERT_EQ(bruteForceResult, hierarchyResult) << ray;
+      if (bruteForceResult == RayTracer::TraceResult::HIT_TRIANGLE) {
+        ++numOfHits;
+        ASSERT_EQ(bruteForceHit.time, hierarchyHit.time) << ray;
+        ASSERT_EQ(bruteForceHit.normal(), hierarchyHit.normal()) << ray;
+        ASSERT_EQ(bruteForceHit.collisionPoint(),
+                  hierarchyHit.collisionPoint())
+            << ray;
+        ASSERT_EQ(bruteForceHit.accumulatedTime, hierarchyHit.accumulatedTime)
+            << ray;
+      }
+    }
+    ASSERT_GT(numOfHits, 0) << "Test is not meaningful without hits";
+  }
+
+private:
+  void addQuad(const Vec3 &point1, const Vec3 &point2, const Vec3 &point3,
+               const Vec3 &point4, std::vector<TriangleObj> *triangles) {
+    triangles->push_back(TriangleObj(point1, point2, point3));
+    triangles->push_back(TriangleObj(point3, point4, point1));
+  }
+
+  std::mt19937 generator_{/*seed=*/2021};
+};
+
+TEST(AxisAlignedBoxTest, HitBox) {
+  AxisAlignedBox box;
+  ASSERT_TRUE(box.empty());
+  box.grow(Vec3(-1, -1, -1));
+  box.grow(Vec3(1, 1, 1));
+  ASSERT_FALSE(box.empty());
+  ASSERT_FLOAT_EQ(24, box.surfaceArea());
+
+  float origin[3] = {-5, 0, 0};
+  float inverseDirection[3] = {1, 1e30f, 1e30f};
+  float entryTime;
+  ASSERT_TRUE(box.hitBox(origin, inverseDirection, /*maxTime=*/100,
+                         &entryTime));
+  ASSERT_FLOAT_EQ(4, entryTime);
+
+  // Closer hit has been already found.
+  ASSERT_FALSE(box.hitBox(origin, inverseDirection, /*maxTime=*/3,
+                          &entryTime));
+
+  // Box is behind the ray
+  float backwards[3] = {-1, 1e30f, 1e30f};
+  ASSERT_FALSE(box.hitBox(origin, backwards, /*maxTime=*/100, &entryTime));
+}
+
+TEST_F(BoundingVolumeHierarchyTest, ReferenceModelSameHitsAsBruteForce) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1.0);
+  expectSameHits(model.get(), /*numOfRays=*/2000);
+}
+
+TEST_F(BoundingVolumeHierarchyTest, DiffusorSameHitsAsBruteForce) {
+  Model model(createDiffusor(/*numOfWells=*/12));
+  expectSameHits(&model, /*numOfRays=*/2000);
+}
+
+TEST_F(BoundingVolumeHierarchyTest, RandomTrianglesSameHitsAsBruteForce) {
+  Model model(createRandomTriangles(/*numOfTriangles=*/3000));
+  expectSameHits(&model, /*numOfRays=*/2000);
+}
+
+TEST_F(BoundingVolumeHierarchyTest, NoHitLeavesHitDataUntouched) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1.0);
+  RayTracer rayTracer(model.get());
+
+  RayHitData hitData(/*t=*/5, Vec3::kX);
+  Ray awayFromModel(Vec3(0, 0, 1), Vec3::kZ);
+  ASSERT_EQ(RayTracer::TraceResult::WENT_OUTSIDE_OF_SIMULATION_SPACE,
+            rayTracer.rayTrace(awayFromModel, kSkipFrequency, &hitData));
+  ASSERT_EQ(5, hitData.time);
+  ASSERT_EQ(Vec3::kX, hitData.normal());
+}
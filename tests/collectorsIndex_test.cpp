@@ -0,0 +1,97 @@
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "main/collectorsIndex.h"
+#include "main/model.h"
+#include "main/simulator.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using core::Ray;
+using core::RayHitData;
+using core::Vec3;
+
+class CollectorsIndexTest : public ::testing::Test {
+protected:
+  CollectorsIndexTest() { model_ = Model::NewReferenceModel(1.0); }
+
+  // Returns random point on the sphere, at which collectors are built, or
+  // random point inside of it.
+  Vec3 randomPoint(bool onCollectorsSphere) {
+    std::normal_distribution<float> normal;
+    Vec3 direction =
+        Vec3(normal(generator_), normal(generator_), normal(generator_))
+            .normalize();
+    std::uniform_real_distribution<float> distance(0, 1);
+    float radius = getSphereWallRadius(*model_);
+    return direction *
+           (onCollectorsSphere ? radius : radius * distance(generator_));
+  }
+
+  std::unique_ptr<Model> model_;
+  std::mt19937 generator_{/*seed=*/37};
+};
+
+TEST_F(CollectorsIndexTest, ReturnsEveryCollectorContainingPoint) {
+  for (int numOfCollectors : {37, 100, 401}) {
+    Collectors collectors = buildCollectors(model_.get(), numOfCollectors);
+    CollectorsIndex index(collectors);
+    ASSERT_EQ(collectors.size(), index.numOfCollectors());
+
+    size_t numOfCandidates = 0;
+    for (int pointIndex = 0; pointIndex < 2000; ++pointIndex) {
+      Vec3 point = randomPoint(/*onCollectorsSphere=*/pointIndex % 2 == 0);
+      const std::vector<int> &candidates = index.candidates(point);
+      ASSERT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+      numOfCandidates += candidates.size();
+      for (size_t collector = 0; collector < collectors.size(); ++collector) {
+        if (collectors[collector]->isVecInside(point)) {
+          ASSERT_TRUE(std::binary_search(candidates.begin(), candidates.end(),
+                                         collector))
+              << "point: " << point << ", " << *collectors[collector];
+        }
+      }
+    }
+    // Lookup is meaningful only when it skips most of the collectors.
+    ASSERT_LT(numOfCandidates, 2000 * collectors.size() / 4)
+        << "number of collectors: " << numOfCollectors;
+  }
+}
+
+TEST_F(CollectorsIndexTest, PointsOutsideOfCollectorsHaveNoCandidates) {
+  Collectors collectors = buildCollectors(model_.get(), 37);
+  CollectorsIndex index(collectors);
+  float radius = getSphereWallRadius(*model_);
+  ASSERT_TRUE(index.candidates(Vec3(10 * radius, 0, 0)).empty());
+  ASSERT_TRUE(CollectorsIndex(Collectors()).candidates(Vec3::kZero).empty());
+}
+
+TEST_F(CollectorsIndexTest, CollectionRulesCollectTheSameEnergy) {
+  collectionRules::NonLinearEnergyCollection collectionRules;
+  Collectors expected = buildCollectors(model_.get(), 101);
+  Collectors actual = buildCollectors(model_.get(), 101);
+  CollectorsIndex index(actual);
+
+  for (int rayIndex = 0; rayIndex < 5000; ++rayIndex) {
+    Vec3 point = randomPoint(/*onCollectorsSphere=*/rayIndex % 4 != 0);
+    RayHitData hitData(/*t=*/1, Vec3::kZ,
+                       Ray(point - Vec3::kZ, Vec3::kZ, /*energy=*/1),
+                       /*freq=*/1000,
+                       /*accumulatedTime=*/(rayIndex % 7) * 1e-3f);
+    collectionRules.collectEnergy(expected, &hitData);
+    collectionRules.collectEnergy(actual, index, &hitData);
+  }
+
+  float collectedEnergy = 0;
+  for (size_t collector = 0; collector < expected.size(); ++collector) {
+    ASSERT_EQ(expected[collector]->getEnergy(),
+              actual[collector]->getEnergy());
+    const objects::EnergyHistogram &energy = actual[collector]->getEnergy();
+    for (int bin = energy.firstBin(); bin < energy.endBin(); ++bin) {
+      collectedEnergy += energy.at(bin);
+    }
+  }
+  ASSERT_GT(collectedEnergy, 0) << "Test is not meaningful without energy";
+}
@@ -0,0 +1,60 @@
+#include "obj/energyHistogram.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <stdexcept>
+
+using objects::EnergyHistogram;
+
+const int kSampleRate = 1000;
+
+TEST(EnergyHistogramTest, ThrowsWhenBinningInvalid) {
+  ASSERT_THROW(EnergyHistogram(0, 1), std::invalid_argument);
+  ASSERT_THROW(EnergyHistogram(kSampleRate, 0), std::invalid_argument);
+}
+
+TEST(EnergyHistogramTest, SumsEnergyInBins) {
+  EnergyHistogram histogram(kSampleRate, /*timeWindow=*/0.5);
+  ASSERT_EQ(500, histogram.numOfBins());
+  ASSERT_TRUE(histogram.empty());
+
+  histogram.add(0.0101, 1);
+  histogram.add(0.0109, 2);
+  histogram.add(0.002, 4);
+  histogram.add(0.3, 8);
+  ASSERT_FLOAT_EQ(3, histogram.at(10));
+  ASSERT_FLOAT_EQ(4, histogram.at(2));
+  ASSERT_FLOAT_EQ(8, histogram.at(300));
+  ASSERT_FLOAT_EQ(0, histogram.at(11));
+  ASSERT_FLOAT_EQ(0, histogram.at(-1));
+  ASSERT_FLOAT_EQ(0, histogram.at(1000));
+  ASSERT_LE(histogram.firstBin(), 2);
+  ASSERT_GT(histogram.endBin(), 300);
+  ASSERT_LE(histogram.endBin(), histogram.numOfBins());
+
+  // Energy outside of the window is only counted.
+  histogram.add(0.5, 16);
+  histogram.add(-0.1, 32);
+  ASSERT_FLOAT_EQ(48, histogram.energyOutsideWindow());
+  ASSERT_LE(histogram.endBin(), histogram.numOfBins());
+}
+
+TEST(EnergyHistogramTest, AddsHistogramsWithTheSameBinning) {
+  std::mt19937 generator(/*seed=*/96);
+  std::uniform_real_distribution<float> time(0, 0.2);
+  EnergyHistogram all(kSampleRate, 0.2), first(kSampleRate, 0.2),
+      second(kSampleRate, 0.2);
+  for (int sample = 0; sample < 1000; ++sample) {
+    float sampleTime = time(generator);
+    // Energies are integers, so sums do not depend on order.
+    all.add(sampleTime, sample % 3);
+    (sample % 2 == 0 ? first : second).add(sampleTime, sample % 3);
+  }
+  first.add(second);
+  ASSERT_EQ(all, first);
+
+  ASSERT_THROW(first.add(EnergyHistogram(kSampleRate, 0.3)),
+               std::invalid_argument);
+  ASSERT_THROW(first.add(EnergyHistogram(2 * kSampleRate, 0.2)),
+               std::invalid_argument);
+}
@@ -0,0 +1,82 @@
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "main/exitBatch.h"
+#include "obj/objects.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using core::Ray;
+using core::RayHitData;
+using core::Vec3;
+
+const float kSkipFrequency = 1000;
+const float kSphereWallRadius = 4;
+
+TEST(ExitBatchTest, SameHitsAsSphereWall) {
+  std::mt19937 generator(/*seed=*/2137);
+  // Origins both inside and outside of the sphere wall.
+  std::uniform_real_distribution<float> position(-6, 6);
+  std::uniform_real_distribution<float> direction(-1, 1);
+  objects::SphereWall sphereWall(kSphereWallRadius);
+  ExitBatch batch(kSphereWallRadius);
+
+  int numOfHits = 0, numOfMisses = 0;
+  for (int batchIndex = 0; batchIndex < 100; ++batchIndex) {
+    std::vector<Ray> rays;
+    while (!batch.full()) {
+      Ray ray(Vec3(position(generator), position(generator),
+                   position(generator)),
+              Vec3(direction(generator), direction(generator),
+                   direction(generator)));
+      ASSERT_EQ(rays.size(), batch.add(ray));
+      rays.push_back(ray);
+    }
+    batch.computeExits();
+
+    for (size_t slot = 0; slot < rays.size(); ++slot) {
+      RayHitData expected(/*t=*/1, Vec3::kZ, Ray(), kSkipFrequency,
+                          /*accumulatedTime=*/0.5);
+      RayHitData actual = expected;
+      bool expectedHit =
+          sphereWall.hitObject(rays[slot], kSkipFrequency, &expected);
+      ASSERT_EQ(expectedHit, batch.exit(slot, kSkipFrequency, &actual))
+          << rays[slot];
+      expectedHit ? ++numOfHits : ++numOfMisses;
+      // Exits are computed the same way, so they are exactly the same.
+      ASSERT_EQ(expected.time, actual.time) << rays[slot];
+      ASSERT_EQ(expected.accumulatedTime, actual.accumulatedTime);
+      ASSERT_EQ(expected.collisionPoint(), actual.collisionPoint());
+      ASSERT_EQ(expected.normal(), actual.normal());
+    }
+    batch.clear();
+    ASSERT_TRUE(batch.empty());
+  }
+  ASSERT_GT(numOfHits, 0);
+  ASSERT_GT(numOfMisses, 0) << "Rays outside of the wall should miss it";
+}
+
+TEST(ExitBatchTest, PartialBatchComputesBufferedRays) {
+  ExitBatch batch(kSphereWallRadius);
+  batch.add(Ray(Vec3::kZero, Vec3::kZ));
+  batch.add(Ray(Vec3(0, 0, 1), -Vec3::kZ));
+  batch.computeExits();
+
+  RayHitData hitData;
+  ASSERT_TRUE(batch.exit(0, kSkipFrequency, &hitData));
+  ASSERT_FLOAT_EQ(kSphereWallRadius, hitData.time);
+  ASSERT_EQ(Vec3(0, 0, kSphereWallRadius), hitData.collisionPoint());
+  ASSERT_TRUE(batch.exit(1, kSkipFrequency, &hitData));
+  ASSERT_FLOAT_EQ(kSphereWallRadius + 1, hitData.time);
+  ASSERT_EQ(Vec3(0, 0, -kSphereWallRadius), hitData.collisionPoint());
+}
+
+TEST(ExitBatchTest, FullBatchThrows) {
+  ExitBatch batch(kSphereWallRadius);
+  for (int slot = 0; slot < ExitBatch::kCapacity; ++slot) {
+    batch.add(Ray(Vec3::kZero, Vec3::kZ));
+  }
+  ASSERT_THROW(batch.add(Ray(Vec3::kZero, Vec3::kZ)), std::logic_error);
+}
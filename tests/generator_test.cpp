@@ -1,13 +1,22 @@
 #include "main/model.h"
+#include "main/rayTracer.h"
 #include "obj/generators.h"
 #include "obj/objects.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <array>
+#include <set>
+#include <utility>
+
 using constants::kSimulationHeight;
 using core::Ray;
 using core::RayHitData;
 using core::Vec3;
+using generators::PlaneWaveRayFactory;
 using generators::PointSpeakerRayFactory;
+using generators::SobolRayFactory;
+using generators::StratifiedJitterOffseter;
 using objects::TriangleObj;
 
 const float kSkipPower = 0;
@@ -93,4 +102,205 @@ TEST(PointSpeakerRayFactoryTest, RayDistributionAtModelTest) {
   ASSERT_EQ(referenceRightUpperCorner, current);
 
   ASSERT_FALSE(rayFactory.genRay(&current));
-}
\ No newline at end of file
+}
+
+TEST(SobolRayFactoryTest, EveryAlignedRangeIsStratified) {
+  // Every aligned range of 64 points has exactly one point in each of 8x8
+  // cells of the unit square.
+  for (uint32_t firstIndex : {0, 64, 640}) {
+    std::set<std::pair<int, int>> cells;
+    for (uint32_t index = firstIndex; index < firstIndex + 64; ++index) {
+      auto [u, v] = generators::scrambledSobolPoint(index, /*seed=*/3);
+      ASSERT_GE(u, 0);
+      ASSERT_LT(u, 1);
+      ASSERT_GE(v, 0);
+      ASSERT_LT(v, 1);
+      cells.insert({static_cast<int>(u * 8), static_cast<int>(v * 8)});
+    }
+    ASSERT_EQ(64, cells.size()) << "range starting at: " << firstIndex;
+  }
+}
+
+TEST(SobolRayFactoryTest, SeedScramblesSequence) {
+  ASSERT_EQ(generators::scrambledSobolPoint(5, /*seed=*/1),
+            generators::scrambledSobolPoint(5, /*seed=*/1));
+  ASSERT_NE(generators::scrambledSobolPoint(5, /*seed=*/1),
+            generators::scrambledSobolPoint(5, /*seed=*/2));
+}
+
+TEST(SobolRayFactoryTest, RaysAreAimedAtModel) {
+  FakeModel model;
+  const int numOfRays = 100;
+  const float power = 50;
+  SobolRayFactory rayFactory(numOfRays, power, &model, /*seed=*/7);
+  PointSpeakerRayFactory pointSpeaker(/*numOfRaysAlongEachAxis=*/1, power,
+                                      &model);
+  ASSERT_EQ(pointSpeaker.origin(), rayFactory.origin());
+
+  Ray ray;
+  int numOfGeneratedRays = 0;
+  while (rayFactory.genRay(&ray)) {
+    ASSERT_EQ(rayFactory.getRay(numOfGeneratedRays), ray);
+    ++numOfGeneratedRays;
+    ASSERT_FLOAT_EQ(power / numOfRays, ray.energy());
+    // Point where ray crosses the top of the model.
+    float time = (model.height() - ray.origin().z()) / ray.direction().z();
+    Vec3 target = ray.at(time);
+    ASSERT_LE(std::abs(target.x()), model.sideSize() + 1e-4);
+    ASSERT_LE(std::abs(target.y()), model.sideSize() + 1e-4);
+  }
+  ASSERT_EQ(numOfRays, numOfGeneratedRays);
+
+  // Factory that starts further in the sequence continues the first one.
+  SobolRayFactory continuation(numOfRays, power, &model, /*seed=*/7,
+                               /*firstSequenceIndex=*/10);
+  ASSERT_EQ(rayFactory.getRay(15), continuation.getRay(5));
+}
+
+TEST(SobolRayFactoryTest, InvalidArgumentsThrow) {
+  FakeModel model;
+  ASSERT_THROW(SobolRayFactory(0, 1, &model), std::invalid_argument);
+  ASSERT_THROW(SobolRayFactory(10, -1, &model), std::invalid_argument);
+}
+
+TEST(PhiloxTest, KnownAnswers) {
+  // Known answer tests of the Random123 library.
+  using Words = std::array<uint32_t, 4>;
+  ASSERT_EQ((Words{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}),
+            generators::philox4x32({0, 0, 0, 0}, {0, 0}));
+  ASSERT_EQ((Words{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}),
+            generators::philox4x32(
+                {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                {0xffffffff, 0xffffffff}));
+  ASSERT_EQ((Words{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}),
+            generators::philox4x32(
+                {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                {0xa4093822, 0x299f31d0}));
+}
+
+TEST(StratifiedJitterOffseterTest, TargetsStayInsideTheirCells) {
+  FakeModel model;
+  PointSpeakerRayFactory rayFactory(/*numOfRaysAlongEachAxis=*/5, kSkipPower,
+                                    &model);
+  const float cellSize = rayFactory.targetSpacing();
+  ASSERT_FLOAT_EQ(0.5, cellSize);
+  StratifiedJitterOffseter offseter(cellSize, model.height(), /*seed=*/11);
+
+  auto target = [&model](const Ray &ray) {
+    float time = (model.height() - ray.origin().z()) / ray.direction().z();
+    return ray.at(time);
+  };
+  float maxJitter = 0;
+  for (int rayIndex = 0; rayIndex < rayFactory.numOfRays(); ++rayIndex) {
+    Ray ray = rayFactory.getRay(rayIndex);
+    Ray jittered = ray;
+    offseter.offsetRay(&jittered, rayIndex, /*frequency=*/1000);
+    ASSERT_EQ(ray.origin(), jittered.origin());
+    ASSERT_EQ(ray.energy(), jittered.energy());
+    Vec3 jitter = target(jittered) - target(ray);
+    ASSERT_LE(std::abs(jitter.x()), cellSize / 2 + 1e-5);
+    ASSERT_LE(std::abs(jitter.y()), cellSize / 2 + 1e-5);
+    ASSERT_NEAR(0, jitter.z(), 1e-5);
+    maxJitter = std::max({maxJitter, std::abs(jitter.x()),
+                          std::abs(jitter.y())});
+  }
+  ASSERT_GT(maxJitter, cellSize / 4);
+}
+
+TEST(StratifiedJitterOffseterTest, JitterDependsOnlyOnSeedIndexAndFrequency) {
+  FakeModel model;
+  PointSpeakerRayFactory rayFactory(/*numOfRaysAlongEachAxis=*/4, kSkipPower,
+                                    &model);
+  StratifiedJitterOffseter offseter(rayFactory.targetSpacing(),
+                                    model.height(), /*seed=*/3);
+  StratifiedJitterOffseter sameSeed(rayFactory.targetSpacing(),
+                                    model.height(), /*seed=*/3);
+  StratifiedJitterOffseter otherSeed(rayFactory.targetSpacing(),
+                                     model.height(), /*seed=*/4);
+
+  auto offset = [&rayFactory](const StratifiedJitterOffseter &offseter,
+                              int rayIndex, float frequency) {
+    Ray ray = rayFactory.getRay(rayIndex);
+    offseter.offsetRay(&ray, rayIndex, frequency);
+    return ray;
+  };
+  // Rays are offset in reversed order, so offsets do not depend on order.
+  for (int rayIndex = rayFactory.numOfRays() - 1; rayIndex >= 0; --rayIndex) {
+    Ray ray = offset(offseter, rayIndex, 500);
+    ASSERT_EQ(ray, offset(offseter, rayIndex, 500));
+    ASSERT_EQ(ray, offset(sameSeed, rayIndex, 500));
+    ASSERT_FALSE(ray == offset(otherSeed, rayIndex, 500));
+    ASSERT_FALSE(ray == offset(offseter, rayIndex, 1000));
+  }
+}
+
+TEST(StratifiedJitterOffseterTest, ZeroCellSizeDoesNotOffset) {
+  FakeModel model;
+  PointSpeakerRayFactory rayFactory(/*numOfRaysAlongEachAxis=*/1, kSkipPower,
+                                    &model);
+  ASSERT_EQ(0, rayFactory.targetSpacing());
+  StratifiedJitterOffseter offseter(rayFactory.targetSpacing(),
+                                    model.height());
+  Ray ray = rayFactory.getRay(0);
+  offseter.offsetRay(&ray, 0, /*frequency=*/1000);
+  ASSERT_EQ(rayFactory.getRay(0), ray);
+
+  ASSERT_THROW(StratifiedJitterOffseter(-1, model.height()),
+               std::invalid_argument);
+}
+
+TEST(PlaneWaveRayFactoryTest, RaysStartAtTheWavefront) {
+  FakeModel model;
+  const float power = 60;
+  const float incidenceAngle = constants::kPi / 6;
+  PlaneWaveRayFactory rayFactory(/*numOfRaysAlongEachAxis=*/6, power, &model,
+                                 incidenceAngle, /*azimuthAngle=*/1);
+  ASSERT_NEAR(std::cos(incidenceAngle), -rayFactory.direction().z(), 1e-6);
+
+  Ray ray;
+  int numOfGeneratedRays = 0;
+  float energy = 0;
+  while (rayFactory.genRay(&ray)) {
+    ASSERT_EQ(rayFactory.getRay(numOfGeneratedRays), ray);
+    ++numOfGeneratedRays;
+    energy += ray.energy();
+    ASSERT_EQ(rayFactory.direction(), ray.direction());
+    ASSERT_NEAR(0,
+                (ray.origin() - rayFactory.origin())
+                    .scalarProduct(rayFactory.direction()),
+                1e-4);
+  }
+  ASSERT_EQ(36, numOfGeneratedRays);
+  ASSERT_FLOAT_EQ(power, energy);
+}
+
+TEST(PlaneWaveRayFactoryTest, EveryRayHitsTheModel) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(/*size=*/1);
+  RayTracer rayTracer(model.get());
+  for (float incidenceAngle : {0.0f, 0.3f, 1.2f}) {
+    for (float gridOffset : {0.0f, 0.45f, -0.45f}) {
+      PlaneWaveRayFactory rayFactory(/*numOfRaysAlongEachAxis=*/10,
+                                     kSkipPower, model.get(), incidenceAngle,
+                                     /*azimuthAngle=*/2, gridOffset,
+                                     gridOffset);
+      for (int rayIndex = 0; rayIndex < rayFactory.numOfRays(); ++rayIndex) {
+        RayHitData hitData;
+        ASSERT_EQ(RayTracer::TraceResult::HIT_TRIANGLE,
+                  rayTracer.rayTrace(rayFactory.getRay(rayIndex),
+                                     /*frequency=*/1000, &hitData))
+            << "incidence angle: " << incidenceAngle
+            << ", ray index: " << rayIndex;
+      }
+    }
+  }
+}
+
+TEST(PlaneWaveRayFactoryTest, InvalidArgumentsThrow) {
+  FakeModel model;
+  ASSERT_THROW(PlaneWaveRayFactory(0, 1, &model), std::invalid_argument);
+  ASSERT_THROW(PlaneWaveRayFactory(10, -1, &model), std::invalid_argument);
+  ASSERT_THROW(PlaneWaveRayFactory(10, 1, &model, constants::kPi / 2),
+               std::invalid_argument);
+  ASSERT_THROW(PlaneWaveRayFactory(10, 1, &model, -0.1),
+               std::invalid_argument);
+}
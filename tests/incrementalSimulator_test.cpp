@@ -0,0 +1,149 @@
+#include "core/vec3.h"
+#include "main/incrementalSimulator.h"
+#include "main/model.h"
+#include "main/rayTracer.h"
+#include "main/resultsCalculation.h"
+#include "main/simulator.h"
+#include "main/trackers.h"
+#include "obj/generators.h"
+#include "obj/objects.h"
+#include "gtest/gtest.h"
+
+#include <unordered_map>
+#include <vector>
+
+using core::Vec3;
+using objects::TriangleObj;
+
+const int kNumOfSquaresAlongEachAxis = 4;
+const float kSquareSize = 0.25;
+const int kMaxTracking = 10;
+
+class IncrementalSimulatorTest : public ::testing::Test {
+protected:
+  // Returns model of squares with side of kSquareSize, each made of two
+  // triangles, at given |heights| of every square. The first square is
+  // raised, so it determines height of every model.
+  std::unique_ptr<Model> createModel(const std::vector<float> &heights) {
+    std::vector<TriangleObj> triangles;
+    const float start = -kNumOfSquaresAlongEachAxis * kSquareSize / 2;
+    for (int y = 0; y < kNumOfSquaresAlongEachAxis; ++y) {
+      for (int x = 0; x < kNumOfSquaresAlongEachAxis; ++x) {
+        const float z = heights[y * kNumOfSquaresAlongEachAxis + x];
+        const float left = start + x * kSquareSize;
+        const float bottom = start + y * kSquareSize;
+        Vec3 corner(left, bottom, z);
+        Vec3 right = corner + Vec3(kSquareSize, 0, 0);
+        Vec3 top = corner + Vec3(0, kSquareSize, 0);
+        Vec3 opposite = corner + Vec3(kSquareSize, kSquareSize, 0);
+        triangles.push_back(TriangleObj(corner, right, opposite));
+        triangles.push_back(TriangleObj(corner, opposite, top));
+      }
+    }
+    return std::make_unique<Model>(triangles);
+  }
+
+  std::vector<float> initialHeights() {
+    std::vector<float> heights(
+        kNumOfSquaresAlongEachAxis * kNumOfSquaresAlongEachAxis, 0);
+    heights.front() = 0.2;
+    return heights;
+  }
+
+  // Runs the simulation of |model| on the single thread.
+  EnergyTensor simulate(Model *model) {
+    generators::PointSpeakerRayFactory source(kNumOfRays, /*sourcePower=*/500,
+                                              model);
+    RayTracer tracer(model);
+    trackers::FakePositionTracker positionTracker;
+    Simulator simulator(&tracer, model, &source, &offseter_, &positionTracker,
+                        &rules_);
+    std::unordered_map<float, Collectors> collectors;
+    std::vector<Collectors *> frequencyCollectors;
+    for (float frequency : kFrequencies) {
+      frequencyCollectors.push_back(
+          &collectors.emplace(frequency, buildCollectors(model, 37))
+               .first->second);
+    }
+    simulator.run(kFrequencies, frequencyCollectors, kMaxTracking);
+    return EnergyTensor::FromCollectors(collectors);
+  }
+
+  void assertSameEnergy(const EnergyTensor &expected,
+                        const EnergyTensor &actual) {
+    ASSERT_EQ(expected.frequencies(), actual.frequencies());
+    ASSERT_EQ(expected.numOfCollectors(), actual.numOfCollectors());
+    ASSERT_EQ(expected.numOfBins(), actual.numOfBins());
+    for (size_t frequency = 0; frequency < expected.numOfFrequencies();
+         ++frequency) {
+      for (size_t collector = 0; collector < expected.numOfCollectors();
+           ++collector) {
+        for (size_t bin = 0; bin < expected.numOfBins(); ++bin) {
+          ASSERT_EQ(expected.at(frequency, collector, bin),
+                    actual.at(frequency, collector, bin))
+              << "frequency: " << frequency << ", collector: " << collector
+              << ", bin: " << bin;
+        }
+      }
+    }
+  }
+
+  const int kNumOfRays = 40;
+  const std::vector<float> kFrequencies = {250, 1000, 4000};
+  generators::FakeOffseter offseter_;
+  collectionRules::LinearEnergyCollection rules_;
+};
+
+TEST_F(IncrementalSimulatorTest, CollectsTheSameEnergyAsSimulator) {
+  std::unique_ptr<Model> model = createModel(initialHeights());
+  generators::PointSpeakerRayFactory source(kNumOfRays, /*sourcePower=*/500,
+                                            model.get());
+  IncrementalSimulator simulator(model.get(), &source, &offseter_, &rules_,
+                                 kFrequencies, buildCollectors(model.get(), 37),
+                                 kMaxTracking);
+
+  ASSERT_EQ(kNumOfRays * kNumOfRays, simulator.numOfRays());
+  assertSameEnergy(simulate(model.get()), simulator.energies());
+}
+
+TEST_F(IncrementalSimulatorTest, UpdateTracesOnlyRaysCrossingEditedSquare) {
+  std::unique_ptr<Model> model = createModel(initialHeights());
+  generators::PointSpeakerRayFactory source(kNumOfRays, /*sourcePower=*/500,
+                                            model.get());
+  IncrementalSimulator simulator(model.get(), &source, &offseter_, &rules_,
+                                 kFrequencies, buildCollectors(model.get(), 37),
+                                 kMaxTracking);
+
+  std::vector<float> heights = initialHeights();
+  heights[5] = 0.1;
+  std::unique_ptr<Model> editedModel = createModel(heights);
+  int numOfRetracedRays = simulator.update(editedModel.get());
+
+  ASSERT_GT(numOfRetracedRays, 0);
+  ASSERT_LT(numOfRetracedRays, simulator.numOfRays() / 2);
+  assertSameEnergy(simulate(editedModel.get()), simulator.energies());
+}
+
+TEST_F(IncrementalSimulatorTest, UnchangedModelIsNotTracedAgain) {
+  std::unique_ptr<Model> model = createModel(initialHeights());
+  generators::PointSpeakerRayFactory source(kNumOfRays, /*sourcePower=*/500,
+                                            model.get());
+  IncrementalSimulator simulator(model.get(), &source, &offseter_, &rules_,
+                                 kFrequencies, buildCollectors(model.get(), 37),
+                                 kMaxTracking);
+  EnergyTensor energies = simulator.energies();
+
+  std::unique_ptr<Model> sameModel = createModel(initialHeights());
+  ASSERT_EQ(0, simulator.update(sameModel.get()));
+  assertSameEnergy(energies, simulator.energies());
+}
+
+TEST_F(IncrementalSimulatorTest, EmptyFrequenciesThrow) {
+  std::unique_ptr<Model> model = createModel(initialHeights());
+  generators::PointSpeakerRayFactory source(kNumOfRays, /*sourcePower=*/500,
+                                            model.get());
+  ASSERT_THROW(IncrementalSimulator(model.get(), &source, &offseter_, &rules_,
+                                    {}, buildCollectors(model.get(), 37),
+                                    kMaxTracking),
+               std::invalid_argument);
+}
@@ -0,0 +1,73 @@
+#include "main/instrumentation.h"
+#include "main/trackers.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+using instrumentation::Counter;
+using instrumentation::Stage;
+using instrumentation::Statistics;
+
+class InstrumentationTest : public ::testing::Test {
+protected:
+  InstrumentationTest() { instrumentation::resetStatistics(); }
+  ~InstrumentationTest() { instrumentation::resetStatistics(); }
+};
+
+TEST_F(InstrumentationTest, StatisticsOfEveryThreadAreSummed) {
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; ++thread) {
+    threads.emplace_back([] {
+      for (int ray = 0; ray < 100; ++ray) {
+        INSTRUMENT_COUNT(RAYS, 1);
+        INSTRUMENT_COUNT(TRIANGLE_TESTS, 3);
+        INSTRUMENT_BOUNCE_DEPTH(ray % 3);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  INSTRUMENT_COUNT(RAYS, 1);
+  INSTRUMENT_BOUNCE_DEPTH(1000);
+
+  Statistics statistics = instrumentation::collectStatistics();
+  ASSERT_EQ(401, statistics.counter(Counter::RAYS));
+  ASSERT_EQ(1200, statistics.counter(Counter::TRIANGLE_TESTS));
+  ASSERT_EQ(0, statistics.counter(Counter::TRUNCATED_RAYS));
+  ASSERT_EQ(136, statistics.bounceDepths()[0]);
+  ASSERT_EQ(132, statistics.bounceDepths()[2]);
+  ASSERT_EQ(1, statistics.bounceDepths().back());
+
+  instrumentation::resetStatistics();
+  ASSERT_TRUE(instrumentation::collectStatistics().empty());
+}
+
+TEST_F(InstrumentationTest, StageTimerAddsTimeOfScope) {
+  {
+    INSTRUMENT_STAGE(COLLECTION);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  Statistics statistics = instrumentation::collectStatistics();
+  ASSERT_GE(statistics.stageTime(Stage::COLLECTION),
+            std::chrono::milliseconds(2));
+  ASSERT_EQ(std::chrono::nanoseconds::zero(),
+            statistics.stageTime(Stage::RAY_TRACING));
+}
+
+TEST_F(InstrumentationTest, StatisticsAreAttachedToRaport) {
+  trackers::ResultTracker resultTracker;
+  resultTracker.registerResult("parameter", {{500, 0.5}});
+  ASSERT_EQ(1, resultTracker.generateRaport().size());
+
+  INSTRUMENT_COUNT(RAYS, 10);
+  INSTRUMENT_BOUNCE_DEPTH(2);
+  trackers::Json raport = resultTracker.generateRaport();
+  ASSERT_EQ(2, raport.size());
+  ASSERT_EQ(trackers::kStatisticsRaportName, raport[1]["name"]);
+  trackers::Json statistics = raport[1]["statistics"];
+  ASSERT_EQ(10, statistics["counters"]["rays"]);
+  ASSERT_EQ(trackers::Json({0, 0, 1}), statistics["bounceDepths"]);
+  ASSERT_EQ(0, statistics["stageSeconds"]["simulation"]);
+}
@@ -1,9 +1,14 @@
 #include "main/model.h"
 #include "main/rayTracer.h"
+#include "main/resultsCalculation.h"
 #include "main/simulator.h"
+#include "main/terminationPolicies.h"
 #include "obj/generators.h"
 #include "gtest/gtest.h"
 
+#include <unordered_map>
+#include <vector>
+
 using core::Ray;
 using core::RayHitData;
 using core::Vec3;
@@ -49,3 +54,212 @@ TEST_F(MainTest, buildingSimulation) {
   // positionTracker.saveAsJson();
   // FAIL();
 }
+
+TEST_F(MainTest, SeveralCollectionRulesFromOneTrace) {
+  const std::vector<float> frequencies = {250, 1000, 4000};
+  collectionRules::LinearEnergyCollection linear;
+  collectionRules::LinearEnergyCollectionWithPhaseImpact phaseImpact;
+  collectionRules::NonLinearEnergyCollection nonLinear;
+  const std::vector<collectionRules::CollectEnergyInterface *> rules = {
+      &linear, &phaseImpact, &nonLinear};
+
+  RayTracer rayTracer(model_.get());
+  PointSpeakerRayFactory pointSpeaker(/*numOfRaysAlongEachAxis=*/30,
+                                      sourcePower_, model_.get());
+  FakeOffseter rayOffseter;
+  trackers::FakePositionTracker positionTracker;
+  const int maxTracking = 12;
+
+  // Shards of parallel runs are summed in different order than rays of the
+  // serial run, so the same number of threads is used by every simulation.
+  for (int numOfThreads : {1, 3}) {
+    ThreadPool threadPool(numOfThreads);
+    // Energies collected by |rules|[rule] with a separate simulation.
+    std::vector<EnergyTensor> expected;
+    for (collectionRules::CollectEnergyInterface *rule : rules) {
+      Simulator simulator(&rayTracer, model_.get(), &pointSpeaker,
+                          &rayOffseter, &positionTracker, rule, &threadPool);
+      std::unordered_map<float, Collectors> collectors;
+      std::vector<Collectors *> frequencyCollectors;
+      for (float frequency : frequencies) {
+        frequencyCollectors.push_back(
+            &collectors
+                 .emplace(frequency,
+                          buildCollectors(model_.get(), numOfCollectors_))
+                 .first->second);
+      }
+      simulator.run(frequencies, frequencyCollectors, maxTracking);
+      expected.push_back(EnergyTensor::FromCollectors(collectors));
+    }
+    auto totalEnergy = [](const EnergyTensor &energies) {
+      float total = 0;
+      for (size_t collector = 0; collector < energies.numOfCollectors();
+           ++collector) {
+        for (size_t bin = 0; bin < energies.numOfBins(); ++bin) {
+          total += energies.at(/*frequencyIndex=*/0, collector, bin);
+        }
+      }
+      return total;
+    };
+    ASSERT_GT(totalEnergy(expected[0]), 0);
+    ASSERT_NE(totalEnergy(expected[0]), totalEnergy(expected[2]))
+        << "Rules are expected to collect different energy";
+
+    Simulator simulator(&rayTracer, model_.get(), &pointSpeaker, &rayOffseter,
+                        &positionTracker, &linear, &threadPool);
+    // |collectors|[rule][frequency]
+    std::vector<std::unordered_map<float, Collectors>> collectors(
+        rules.size());
+    std::vector<std::vector<Collectors *>> ruleCollectors(rules.size());
+    for (size_t rule = 0; rule < rules.size(); ++rule) {
+      for (float frequency : frequencies) {
+        ruleCollectors[rule].push_back(
+            &collectors[rule]
+                 .emplace(frequency,
+                          buildCollectors(model_.get(), numOfCollectors_))
+                 .first->second);
+      }
+    }
+    simulator.run(frequencies, rules, ruleCollectors, maxTracking);
+
+    for (size_t rule = 0; rule < rules.size(); ++rule) {
+      EnergyTensor energies = EnergyTensor::FromCollectors(collectors[rule]);
+      ASSERT_EQ(expected[rule].numOfBins(), energies.numOfBins());
+      for (size_t frequency = 0; frequency < frequencies.size(); ++frequency) {
+        for (int collector = 0; collector < numOfCollectors_; ++collector) {
+          for (size_t bin = 0; bin < energies.numOfBins(); ++bin) {
+            ASSERT_EQ(expected[rule].at(frequency, collector, bin),
+                      energies.at(frequency, collector, bin))
+                << "threads: " << numOfThreads << ", rule: " << *rules[rule];
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(MainTest, CollectorsForEveryRuleAreRequired) {
+  RayTracer rayTracer(model_.get());
+  PointSpeakerRayFactory pointSpeaker(numOfRayAlongEachAxis_, sourcePower_,
+                                      model_.get());
+  FakeOffseter rayOffseter;
+  trackers::FakePositionTracker positionTracker;
+  collectionRules::LinearEnergyCollection linear;
+  collectionRules::NonLinearEnergyCollection nonLinear;
+  Simulator simulator(&rayTracer, model_.get(), &pointSpeaker, &rayOffseter,
+                      &positionTracker, &linear);
+  Collectors collectors = buildCollectors(model_.get(), numOfCollectors_);
+
+  ASSERT_THROW(simulator.run({frequency_}, {&linear, &nonLinear},
+                             {{&collectors}}, /*maxTracking=*/4),
+               std::invalid_argument);
+  ASSERT_THROW(simulator.run({frequency_}, {&linear, &nonLinear},
+                             {{&collectors}, {}}, /*maxTracking=*/4),
+               std::invalid_argument);
+}
+
+// Records positions of every tracking in order.
+class RecordingPositionTracker : public trackers::PositionTrackerInterface {
+public:
+  void initializeNewFrequency(float frequency) override{};
+  void initializeNewTracking() override { trackings.emplace_back(); };
+  void
+  addNewPositionToCurrentTracking(const core::RayHitData &hitData) override {
+    trackings.back().push_back(hitData.collisionPoint());
+  };
+  void endCurrentFrequency() override{};
+  void endCurrentTracking() override{};
+  void save() override{};
+  void switchToReferenceModel() override{};
+
+  std::vector<std::vector<Vec3>> trackings;
+
+private:
+  void printItself(std::ostream &os) const noexcept override {
+    os << "Recording Position Tracker";
+  }
+};
+
+TEST_F(MainTest, WavefrontExecutionIsTheSameAsDepthFirst) {
+  // Deep valley closed at both ends, so rays reflect many times between its
+  // slopes before they leave it, or are truncated or terminated.
+  const float depth = 1.5;
+  const Vec3 bottom[2] = {Vec3(0, -0.5, 0), Vec3(0, 0.5, 0)};
+  const Vec3 left[2] = {Vec3(-0.5, -0.5, depth), Vec3(-0.5, 0.5, depth)};
+  const Vec3 right[2] = {Vec3(0.5, -0.5, depth), Vec3(0.5, 0.5, depth)};
+  std::vector<objects::TriangleObj> triangles = {
+      objects::TriangleObj(bottom[0], bottom[1], left[1]),
+      objects::TriangleObj(bottom[0], left[1], left[0]),
+      objects::TriangleObj(bottom[0], right[0], right[1]),
+      objects::TriangleObj(bottom[0], right[1], bottom[1]),
+      objects::TriangleObj(bottom[0], left[0], right[0]),
+      objects::TriangleObj(bottom[1], right[1], left[1])};
+  Model model(triangles);
+
+  RayTracer rayTracer(&model);
+  // More rays than kWavefrontSize, so rays are traced in several batches.
+  PointSpeakerRayFactory pointSpeaker(/*numOfRaysAlongEachAxis=*/70,
+                                      sourcePower_, &model);
+  ASSERT_GT(pointSpeaker.numOfRays(), Simulator::kWavefrontSize);
+  FakeOffseter rayOffseter;
+  collectionRules::NonLinearEnergyCollection energyCollectionRules;
+  terminationPolicies::RussianRouletteTermination roulette(
+      /*minReflections=*/3, /*survivalProbability=*/0.7);
+  const std::vector<float> frequencies = {500, 2000};
+  const int maxTracking = 4;
+
+  for (int numOfThreads : {1, 3}) {
+    ThreadPool threadPool(numOfThreads);
+    std::vector<std::vector<Collectors>> collectors(2);
+    std::vector<RecordingPositionTracker> positionTrackers(2);
+    std::vector<terminationPolicies::TerminationSavings> savings;
+    int execution = 0;
+    for (Simulator::Execution simulatorExecution :
+         {Simulator::Execution::DEPTH_FIRST, Simulator::Execution::WAVEFRONT}) {
+      Simulator simulator(&rayTracer, &model, &pointSpeaker, &rayOffseter,
+                          &positionTrackers[execution],
+                          &energyCollectionRules, &threadPool, {&roulette},
+                          simulatorExecution);
+      std::vector<Collectors *> frequencyCollectors;
+      collectors[execution].reserve(frequencies.size());
+      for (size_t frequency = 0; frequency < frequencies.size(); ++frequency) {
+        frequencyCollectors.push_back(&collectors[execution].emplace_back(
+            buildCollectors(&model, numOfCollectors_)));
+      }
+      simulator.run(frequencies, frequencyCollectors, maxTracking);
+      savings.push_back(simulator.terminationSavings());
+      ++execution;
+    }
+
+    ASSERT_GT(savings[0].numOfTerminatedRays(0), 0);
+    ASSERT_EQ(savings[0].numOfTerminatedRays(0),
+              savings[1].numOfTerminatedRays(0));
+    ASSERT_EQ(savings[0].numOfTracedReflections(),
+              savings[1].numOfTracedReflections());
+    if (numOfThreads == 1) {
+      // Trackings of parallel runs are passed in order of finished shards.
+      ASSERT_EQ(positionTrackers[0].trackings, positionTrackers[1].trackings);
+    }
+    ASSERT_EQ(positionTrackers[0].trackings.size(),
+              positionTrackers[1].trackings.size());
+
+    float collectedEnergy = 0;
+    for (size_t frequency = 0; frequency < frequencies.size(); ++frequency) {
+      for (int collector = 0; collector < numOfCollectors_; ++collector) {
+        const objects::EnergyHistogram &depthFirst =
+            collectors[0][frequency][collector]->getEnergy();
+        const objects::EnergyHistogram &wavefront =
+            collectors[1][frequency][collector]->getEnergy();
+        ASSERT_EQ(depthFirst.firstBin(), wavefront.firstBin());
+        ASSERT_EQ(depthFirst.endBin(), wavefront.endBin());
+        for (int bin = depthFirst.firstBin(); bin < depthFirst.endBin();
+             ++bin) {
+          ASSERT_EQ(depthFirst.at(bin), wavefront.at(bin))
+              << "threads: " << numOfThreads << ", collector: " << collector;
+          collectedEnergy += depthFirst.at(bin);
+        }
+      }
+    }
+    ASSERT_GT(collectedEnergy, 0) << "Test is not meaningful without energy";
+  }
+}
@@ -0,0 +1,100 @@
+#include "core/vec3.h"
+#include "main/model.h"
+#include "main/objParser.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using core::Vec3;
+using objects::TriangleObj;
+
+TEST(ObjParserTest, SwapsAxesAndSplitsPolygons) {
+  std::string content = "# comment\r\n"
+                        "o square\r\n"
+                        "v 0 0 0\r\n"
+                        "v 1.5 0 0\r\n"
+                        "v +1.5 2 -1e0\r\n"
+                        "v 0 2 -1\r\n"
+                        "vn 0 0 1\r\n"
+                        "\r\n"
+                        "f 1//1 2//1 3//1 4//1\r\n"
+                        "f -4/1 -2/1 -1/1";
+  ObjFileContent result = parseObjFile(content, /*numOfThreads=*/1);
+
+  ASSERT_TRUE(result.degeneratedTriangleLines.empty());
+  ASSERT_EQ(3, result.triangles.size());
+  const TriangleObj &triangle = result.triangles[1];
+  ASSERT_EQ(Vec3(0, 0, 0), triangle.point1());
+  ASSERT_EQ(Vec3(1.5, -1, 2), triangle.point2());
+  ASSERT_EQ(Vec3(0, -1, 2), triangle.point3());
+  ASSERT_EQ(result.triangles[1], result.triangles[2]);
+}
+
+TEST(ObjParserTest, ReportsDegeneratedTriangles) {
+  std::string content = "v 0 0 0\n"
+                        "v 1 0 0\n"
+                        "v 2 0 0\n"
+                        "v 0 1 0\n"
+                        "f 1 2 3\n"
+                        "f 1 2 4\n";
+  ObjFileContent result = parseObjFile(content, /*numOfThreads=*/1);
+  ASSERT_EQ(1, result.triangles.size());
+  ASSERT_EQ(std::vector<int>{5}, result.degeneratedTriangleLines);
+}
+
+TEST(ObjParserTest, ThrowsOnMalformedDeclarations) {
+  for (std::string content :
+       {"v 0 0\n", "v 0 0 x\n", "v 0 0 0\nf 1 2 a\n", "v 0 0 0\nf 1 2 3\n",
+        "v 0 0 0\nf 0 1 1\n"}) {
+    ASSERT_THROW(parseObjFile(content, /*numOfThreads=*/1),
+                 std::invalid_argument)
+        << content;
+  }
+}
+
+TEST(ObjParserTest, SameResultForAnyNumberOfThreads) {
+  // Big enough grid to be split into many chunks.
+  const int kGridSize = 300;
+  std::stringstream content;
+  for (int row = 0; row <= kGridSize; ++row) {
+    for (int column = 0; column <= kGridSize; ++column) {
+      content << "v " << column * 0.01 << " " << (row + column) % 7 * 0.001
+              << " " << row * 0.01 << "\n";
+    }
+  }
+  for (int row = 0; row < kGridSize; ++row) {
+    for (int column = 0; column < kGridSize; ++column) {
+      int corner = row * (kGridSize + 1) + column + 1;
+      content << "f " << corner << " " << corner + 1 << " "
+              << corner + kGridSize + 2 << " " << corner + kGridSize + 1
+              << "\n";
+    }
+  }
+  // Degenerated triangle at the very end of the file.
+  content << "f -1 -2 -1";
+
+  ObjFileContent expected = parseObjFile(content.str(), /*numOfThreads=*/1);
+  ASSERT_EQ(2 * kGridSize * kGridSize, expected.triangles.size());
+  ASSERT_EQ(1, expected.degeneratedTriangleLines.size());
+  for (int numOfThreads : {2, 3, 8}) {
+    ObjFileContent result = parseObjFile(content.str(), numOfThreads);
+    ASSERT_EQ(expected.degeneratedTriangleLines,
+              result.degeneratedTriangleLines);
+    ASSERT_EQ(expected.triangles.size(), result.triangles.size());
+    for (size_t index = 0; index < expected.triangles.size(); ++index) {
+      ASSERT_EQ(expected.triangles[index].point1(),
+                result.triangles[index].point1());
+      ASSERT_EQ(expected.triangles[index].point2(),
+                result.triangles[index].point2());
+      ASSERT_EQ(expected.triangles[index].point3(),
+                result.triangles[index].point3());
+    }
+  }
+}
+
+TEST(ObjParserTest, ModelFromMissingFileThrows) {
+  ASSERT_THROW(Model::NewLoadFromObjectFile("/nonexistent/model.obj"),
+               std::invalid_argument);
+}
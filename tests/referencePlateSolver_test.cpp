@@ -0,0 +1,142 @@
+#include "main/model.h"
+#include "main/rayTracer.h"
+#include "main/referencePlateSolver.h"
+#include "main/simulator.h"
+#include "main/trackers.h"
+#include "obj/generators.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+using core::Vec3;
+
+const float kSkipFrequency = 1000;
+const float kSourcePower = 100;
+
+// Puts whole energy of every hit into the collector, regardless of distance.
+struct TotalEnergyCollection : public collectionRules::CollectEnergyInterface {
+  void printItself(std::ostream &os) const noexcept override {
+    os << "Total Energy Collection";
+  }
+
+protected:
+  void collectEnergyInside(objects::EnergyCollector *collector,
+                           const Vec3 &reachedPosition,
+                           core::RayHitData *hitData) override {
+    collector->addEnergy(hitData->accumulatedTime, hitData->energy());
+  }
+};
+
+float totalEnergy(const objects::EnergyCollector &collector) {
+  const objects::EnergyHistogram &histogram = collector.getEnergy();
+  float energy = histogram.energyOutsideWindow();
+  for (int bin = histogram.firstBin(); bin < histogram.endBin(); ++bin) {
+    energy += histogram.at(bin);
+  }
+  return energy;
+}
+
+class ReferencePlateSolverTest : public ::testing::Test {
+protected:
+  ReferencePlateSolverTest()
+      : model_(Model::NewReferenceModel(/*sideSize=*/1)),
+        sphereWallRadius_(getSphereWallRadius(*model_)) {}
+
+  // Traces the reference model with |numOfRaysSquared|^2 rays.
+  Collectors traceReference(int numOfRaysSquared) {
+    Collectors collectors = buildCollectors(model_.get(), 37);
+    RayTracer rayTracer(model_.get());
+    generators::PointSpeakerRayFactory source(numOfRaysSquared, kSourcePower,
+                                              model_.get());
+    generators::FakeOffseter offseter;
+    trackers::FakePositionTracker positionTracker;
+    Simulator simulator(&rayTracer, model_.get(), &source, &offseter,
+                        &positionTracker, &energyCollectionRules_);
+    simulator.run(kSkipFrequency, &collectors, /*maxTracking=*/12);
+    return collectors;
+  }
+
+  Collectors solveReference(int numOfSamplesAlongEachAxis) {
+    Collectors collectors = buildCollectors(model_.get(), 37);
+    ReferencePlateSolver solver(model_->sideSize(), sphereWallRadius_,
+                                numOfSamplesAlongEachAxis);
+    generators::PointSpeakerRayFactory source(1, kSourcePower, model_.get());
+    solver.collectEnergy(source.origin(), kSourcePower, model_->sideSize(),
+                         model_->height(), {kSkipFrequency}, {&collectors},
+                         &energyCollectionRules_);
+    return collectors;
+  }
+
+  std::unique_ptr<Model> model_;
+  float sphereWallRadius_;
+  collectionRules::LinearEnergyCollection energyCollectionRules_;
+};
+
+TEST_F(ReferencePlateSolverTest, ReflectsWholeSourcePower) {
+  // Single collector contains the whole sphere wall.
+  Collectors collectors;
+  collectors.push_back(std::make_unique<objects::EnergyCollector>(
+      Vec3::kZero, 2 * sphereWallRadius_));
+  TotalEnergyCollection rules;
+  ReferencePlateSolver solver(model_->sideSize(), sphereWallRadius_,
+                              /*numOfSamplesAlongEachAxis=*/100);
+  solver.collectEnergy(Vec3(0, 0, 8), kSourcePower, model_->sideSize(),
+                       /*targetHeight=*/0, {kSkipFrequency}, {&collectors},
+                       &rules);
+  ASSERT_NEAR(kSourcePower, totalEnergy(*collectors.front()),
+              1e-4 * kSourcePower);
+
+  // Source aimed at the target square twice as large as the plate puts a
+  // quarter of its power on the plate.
+  collectors.front()->setEnergy(
+      objects::EnergyHistogram(collectors.front()->getEnergy().sampleRate(),
+                               collectors.front()->getEnergy().timeWindow()));
+  solver.collectEnergy(Vec3(0, 0, 8), kSourcePower, 2 * model_->sideSize(),
+                       /*targetHeight=*/0, {kSkipFrequency}, {&collectors},
+                       &rules);
+  ASSERT_NEAR(kSourcePower / 4, totalEnergy(*collectors.front()),
+              1e-4 * kSourcePower);
+}
+
+TEST_F(ReferencePlateSolverTest, MatchesTracedReferencePlate) {
+  Collectors traced = traceReference(/*numOfRaysSquared=*/200);
+  Collectors solved = solveReference(/*numOfSamplesAlongEachAxis=*/400);
+  float maxEnergy = 0;
+  for (const auto &collector : traced) {
+    maxEnergy = std::max(maxEnergy, totalEnergy(*collector));
+  }
+  ASSERT_GT(maxEnergy, 0) << "Test is not meaningful without energy";
+  for (size_t collector = 0; collector < traced.size(); ++collector) {
+    ASSERT_NEAR(totalEnergy(*traced[collector]),
+                totalEnergy(*solved[collector]), 0.02 * maxEnergy)
+        << "collector: " << collector;
+  }
+}
+
+TEST_F(ReferencePlateSolverTest, ConvergesWithNumOfSamples) {
+  Collectors coarse = solveReference(/*numOfSamplesAlongEachAxis=*/256);
+  Collectors fine = solveReference(/*numOfSamplesAlongEachAxis=*/512);
+  for (size_t collector = 0; collector < coarse.size(); ++collector) {
+    ASSERT_NEAR(totalEnergy(*fine[collector]),
+                totalEnergy(*coarse[collector]),
+                0.01 * totalEnergy(*fine[collector]) + 1e-6);
+  }
+}
+
+TEST_F(ReferencePlateSolverTest, InvalidArgumentsThrow) {
+  ASSERT_THROW(ReferencePlateSolver(0, 4), std::invalid_argument);
+  ASSERT_THROW(ReferencePlateSolver(1, 0), std::invalid_argument);
+  ASSERT_THROW(ReferencePlateSolver(1, 4, 0), std::invalid_argument);
+
+  ReferencePlateSolver solver(1, 4);
+  Collectors collectors = buildCollectors(model_.get(), 37);
+  ASSERT_THROW(solver.collectEnergy(Vec3(0, 0, -1), kSourcePower, 1, 0,
+                                    {kSkipFrequency}, {&collectors},
+                                    &energyCollectionRules_),
+               std::invalid_argument);
+  ASSERT_THROW(solver.collectEnergy(Vec3(0, 0, 8), kSourcePower, 1, 0,
+                                    {kSkipFrequency, 2 * kSkipFrequency},
+                                    {&collectors}, &energyCollectionRules_),
+               std::invalid_argument);
+}
@@ -7,6 +7,7 @@
 
 #include <cmath>
 #include <iostream>
+#include <random>
 #include <vector>
 
 // Checks if every element in the array is near equal to expected array.
@@ -146,3 +147,151 @@ TEST_F(WaveObjectPressureTest, GetTotalPressureTest) {
   ASSERT_NEAR(wave.getTotalPressure(),
               convertPressureToDecibels(referencePressureFromCustom), 0.6f);
 }
+
+TEST(EnergyTensorTest, CreatedFromCollectors) {
+  std::unordered_map<float, Collectors> collectors;
+  for (float frequency : {2000.0f, 500.0f}) {
+    for (int index = 0; index < 3; ++index) {
+      collectors[frequency].push_back(
+          std::make_unique<objects::EnergyCollector>(core::Vec3::kZero, 1,
+                                                     kSampleRate));
+    }
+  }
+  collectors[500][1]->addEnergy(10.5f / kSampleRate, 1);
+  collectors[2000][2]->addEnergy(20.5f / kSampleRate, 2);
+  collectors[2000][2]->addEnergy(20.5f / kSampleRate, 2);
+
+  EnergyTensor tensor = EnergyTensor::FromCollectors(collectors);
+  ASSERT_EQ(std::vector<float>({500, 2000}), tensor.frequencies());
+  ASSERT_EQ(3, tensor.numOfCollectors());
+  ASSERT_EQ(21, tensor.numOfBins());
+  ASSERT_EQ(kSampleRate, tensor.sampleRate());
+  ASSERT_EQ(1, tensor.frequencyIndex(2000));
+  ASSERT_THROW(tensor.frequencyIndex(1000), std::out_of_range);
+
+  ASSERT_FLOAT_EQ(1, tensor.at(0, 1, 10));
+  ASSERT_FLOAT_EQ(4, tensor.at(1, 2, 20));
+  ASSERT_FLOAT_EQ(0, tensor.at(1, 1, 10));
+
+  // Waves end at the last collected sample.
+  WaveObjectFactory waveFactory(kSampleRate);
+  std::vector<WaveObject> waves = waveFactory.createWaveObjects(tensor, 1);
+  ASSERT_EQ(3, waves.size());
+  ASSERT_EQ(0, waves[0].length());
+  ASSERT_EQ(21, waves[2].length());
+  ASSERT_FLOAT_EQ(4, waves[2].getData()[20]);
+  ASSERT_THROW(WaveObjectFactory(kSampleRate / 2).createWaveObjects(tensor, 1),
+               std::invalid_argument);
+
+  collectors[500].pop_back();
+  ASSERT_THROW(EnergyTensor::FromCollectors(collectors), std::invalid_argument);
+}
+
+TEST(JackknifeTest, StandardErrorOfMean) {
+  // For the mean, jackknife gives the usual standard error of the mean.
+  const std::vector<float> samples = {1, 2, 4, 7, 11};
+  std::vector<float> leaveOneOutMeans;
+  float sum = 0;
+  for (float sample : samples) {
+    sum += sample;
+  }
+  for (float sample : samples) {
+    leaveOneOutMeans.push_back((sum - sample) / (samples.size() - 1));
+  }
+  float mean = sum / samples.size();
+  float variance = 0;
+  for (float sample : samples) {
+    variance += std::pow(sample - mean, 2) / (samples.size() - 1);
+  }
+  ASSERT_NEAR(std::sqrt(variance / samples.size()),
+              jackknifeStandardError(leaveOneOutMeans), 1e-5);
+
+  ASSERT_FLOAT_EQ(0, jackknifeStandardError({3, 3, 3}));
+  ASSERT_THROW(jackknifeStandardError({1}), std::invalid_argument);
+}
+
+TEST(WaveObject, IntegratedEnergyIsTotalPressure) {
+  WaveObject wave(kSampleRate, {1, 6, 4, 1, 3});
+  ASSERT_FLOAT_EQ(13.0f / kSampleRate, wave.getIntegratedEnergy());
+  ASSERT_FLOAT_EQ(convertPressureToDecibels(wave.getIntegratedEnergy()),
+                  wave.getTotalPressure());
+}
+
+TEST(NormalizedDiffusionCoefficientTest, NormalizesByReference) {
+  std::map<float, float> normalized = normalizedDiffusionCoefficients(
+      {{500, 0.6}, {1000, 0.2}}, {{500, 0.2}, {1000, 0.2}});
+  ASSERT_EQ(2, normalized.size());
+  ASSERT_FLOAT_EQ(0.5, normalized.at(500));
+  ASSERT_FLOAT_EQ(0, normalized.at(1000));
+
+  ASSERT_THROW(normalizedDiffusionCoefficients({{500, 0.6}}, {{1000, 0.2}}),
+               std::invalid_argument);
+  ASSERT_THROW(
+      normalizedDiffusionCoefficients({{500, 0.6}}, {{500, 0.2}, {800, 0.1}}),
+      std::invalid_argument);
+}
+
+TEST(WaveObject, IntegratedEnergyMatchesTrapezoidRule) {
+  std::mt19937 generator(/*seed=*/2137);
+  std::exponential_distribution<float> energy;
+  for (size_t numOfSamples : {0, 1, 2, 7, 8, 9, 1000}) {
+    std::vector<float> data(numOfSamples);
+    std::generate(data.begin(), data.end(), [&] { return energy(generator); });
+    double expected = 0;
+    for (size_t sample = 1; sample < numOfSamples; ++sample) {
+      expected += (data[sample - 1] + data[sample]) / 2.0 / kSampleRate;
+    }
+    WaveObject wave(kSampleRate, data);
+    ASSERT_NEAR(expected, wave.getIntegratedEnergy(), 1e-5 * expected)
+        << "samples: " << numOfSamples;
+  }
+}
+
+TEST(WaveObject, PreallocatedWaveDoesNotReallocate) {
+  const float maxTime = 0.5;
+  WaveObject wave = WaveObject::Preallocated(kSampleRate, maxTime);
+  ASSERT_EQ(0, wave.length());
+  wave.addEnergyAtTime(0, 1);
+  const float *data = wave.getData().data();
+  wave.addEnergyAtTime(maxTime, 2);
+  wave.addEnergyAtTime(maxTime / 2, 3);
+  ASSERT_EQ(data, wave.getData().data());
+  ASSERT_EQ(static_cast<size_t>(maxTime * kSampleRate) + 1, wave.length());
+  ASSERT_FLOAT_EQ(2, wave.getEnergyAtTime(maxTime));
+
+  // Later samples are still accepted.
+  wave.addEnergyAtTime(2 * maxTime, 4);
+  ASSERT_FLOAT_EQ(4, wave.getEnergyAtTime(2 * maxTime));
+  ASSERT_THROW(WaveObject::Preallocated(kSampleRate, -1),
+               std::invalid_argument);
+}
+
+TEST(SoundPressureLevelsTest, BatchMatchesWaveObjects) {
+  std::mt19937 generator(/*seed=*/2137);
+  std::exponential_distribution<float> energy;
+  const std::vector<float> frequencies = {500, 1000, 2000};
+  const size_t numOfCollectors = 5, numOfBins = 300;
+  EnergyTensor tensor(frequencies, numOfCollectors, numOfBins, kSampleRate);
+  for (size_t frequency = 0; frequency < frequencies.size(); ++frequency) {
+    for (size_t collector = 0; collector < numOfCollectors; ++collector) {
+      // Collectors have different number of trailing bins without energy,
+      // the last one does not collect any energy.
+      const size_t numOfFilledBins =
+          collector + 1 < numOfCollectors ? numOfBins / (collector + 1) : 0;
+      for (size_t bin = 0; bin < numOfFilledBins; ++bin) {
+        tensor.at(frequency, collector, bin) = energy(generator);
+      }
+    }
+  }
+
+  std::vector<std::vector<float>> levels =
+      calculateSoundPressureLevels(tensor);
+  WaveObjectFactory waveFactory(kSampleRate);
+  ASSERT_EQ(frequencies.size(), levels.size());
+  for (size_t frequency = 0; frequency < frequencies.size(); ++frequency) {
+    std::vector<float> expected = calculateSoundPressureLevels(
+        waveFactory.createWaveObjects(tensor, frequency));
+    ASSERT_EQ(expected, levels[frequency]) << "frequency: " << frequency;
+  }
+  ASSERT_FLOAT_EQ(0, levels[0][numOfCollectors - 1]);
+}
@@ -0,0 +1,123 @@
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "main/model.h"
+#include "main/rayTracer.h"
+#include "main/sceneCache.h"
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using core::Ray;
+using core::RayHitData;
+using core::Vec3;
+
+const float kSkipFrequency = 1000;
+
+class SceneCacheTest : public ::testing::Test {
+protected:
+  SceneCacheTest()
+      : folder_(std::filesystem::temp_directory_path() / "sceneCacheTest") {
+    std::filesystem::remove_all(folder_);
+    std::filesystem::create_directories(folder_);
+    objPath_ = (folder_ / "model.obj").string();
+  }
+  ~SceneCacheTest() { std::filesystem::remove_all(folder_); }
+
+  // Writes wavy surface made of |gridSize| x |gridSize| quads.
+  void writeObjFile(int gridSize, float waveHeight) {
+    std::ofstream file(objPath_);
+    for (int row = 0; row <= gridSize; ++row) {
+      for (int column = 0; column <= gridSize; ++column) {
+        file << "v " << column * 0.1 << " "
+             << waveHeight * ((row * 7 + column * 3) % 5) << " " << row * 0.1
+             << "\n";
+      }
+    }
+    for (int row = 0; row < gridSize; ++row) {
+      for (int column = 0; column < gridSize; ++column) {
+        int corner = row * (gridSize + 1) + column + 1;
+        file << "f " << corner << " " << corner + 1 << " "
+             << corner + gridSize + 2 << " " << corner + gridSize + 1 << "\n";
+      }
+    }
+  }
+
+  std::string cacheFolder() const { return (folder_ / "cache").string(); }
+
+  std::filesystem::path folder_;
+  std::string objPath_;
+};
+
+TEST_F(SceneCacheTest, CachedModelMatchesParsedModel) {
+  writeObjFile(/*gridSize=*/20, /*waveHeight=*/0.02);
+  SceneCache cache(cacheFolder());
+  std::unique_ptr<Model> parsed = cache.loadModel(objPath_);
+  std::unique_ptr<Model> cached = cache.loadModel(objPath_);
+  ASSERT_EQ(1, cache.numOfMisses());
+  ASSERT_EQ(1, cache.numOfHits());
+
+  ASSERT_EQ(parsed->triangles().size(), cached->triangles().size());
+  for (size_t index = 0; index < parsed->triangles().size(); ++index) {
+    const objects::TriangleObj &expected = parsed->triangles()[index];
+    const objects::TriangleObj &actual = cached->triangles()[index];
+    ASSERT_EQ(expected.point1(), actual.point1());
+    ASSERT_EQ(expected.point2(), actual.point2());
+    ASSERT_EQ(expected.point3(), actual.point3());
+    ASSERT_EQ(expected.normal(), actual.normal());
+    ASSERT_EQ(expected.area(), actual.area());
+  }
+  ASSERT_EQ(parsed->sideSize(), cached->sideSize());
+  ASSERT_EQ(parsed->boundingVolumeHierarchy()->triangleIndices(),
+            cached->boundingVolumeHierarchy()->triangleIndices());
+
+  RayTracer parsedTracer(parsed.get()), cachedTracer(cached.get());
+  std::mt19937 generator(/*seed=*/7);
+  std::uniform_real_distribution<float> position(-1, 3);
+  int numOfHits = 0;
+  for (int rayIndex = 0; rayIndex < 200; ++rayIndex) {
+    Ray ray(Vec3(position(generator), position(generator), 1),
+            Vec3(position(generator), position(generator), -1));
+    RayHitData parsedHit, cachedHit;
+    RayTracer::TraceResult result =
+        parsedTracer.rayTrace(ray, kSkipFrequency, &parsedHit);
+    ASSERT_EQ(result, cachedTracer.rayTrace(ray, kSkipFrequency, &cachedHit));
+    if (result == RayTracer::TraceResult::HIT_TRIANGLE) {
+      ++numOfHits;
+      ASSERT_EQ(parsedHit.time, cachedHit.time);
+      ASSERT_EQ(parsedHit.normal(), cachedHit.normal());
+    }
+  }
+  ASSERT_GT(numOfHits, 0) << "Test is not meaningful without hits";
+}
+
+TEST_F(SceneCacheTest, ModifiedObjFileIsParsedAgain) {
+  SceneCache cache(cacheFolder());
+  writeObjFile(/*gridSize=*/4, /*waveHeight=*/0.02);
+  ASSERT_EQ(32, cache.loadModel(objPath_)->triangles().size());
+  writeObjFile(/*gridSize=*/5, /*waveHeight=*/0.02);
+  ASSERT_EQ(50, cache.loadModel(objPath_)->triangles().size());
+  ASSERT_EQ(2, cache.numOfMisses());
+  ASSERT_EQ(0, cache.numOfHits());
+}
+
+TEST_F(SceneCacheTest, BrokenCacheFileIsWrittenAgain) {
+  writeObjFile(/*gridSize=*/4, /*waveHeight=*/0.02);
+  std::stringstream objContent;
+  objContent << std::ifstream(objPath_).rdbuf();
+
+  SceneCache cache(cacheFolder());
+  cache.loadModel(objPath_);
+  std::string cachePath = cache.cachePath(objContent.str());
+  size_t cacheSize = std::filesystem::file_size(cachePath);
+  std::filesystem::resize_file(cachePath, cacheSize / 2);
+
+  ASSERT_EQ(32, cache.loadModel(objPath_)->triangles().size());
+  ASSERT_EQ(2, cache.numOfMisses());
+  ASSERT_EQ(cacheSize, std::filesystem::file_size(cachePath));
+  cache.loadModel(objPath_);
+  ASSERT_EQ(1, cache.numOfHits());
+}
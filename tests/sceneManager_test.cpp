@@ -1,4 +1,5 @@
 #include "main/model.h"
+#include "main/resultsCalculation.h"
 #include "main/sceneManager.h"
 #include "main/trackers.h"
 #include "gmock/gmock.h"
@@ -58,3 +59,450 @@ protected:
   FakeCollectorsTracker collectorsTracker;
   LinearEnergyCollection energyCollectionRules;
 };
+
+// Counts trackings and positions passed to the tracker.
+class CountingPositionTracker : public FakePositionTracker {
+public:
+  void initializeNewTracking() override { ++numOfTrackings; };
+  void
+  addNewPositionToCurrentTracking(const core::RayHitData &hitData) override {
+    ++numOfPositions;
+  };
+
+  int numOfTrackings = 0;
+  int numOfPositions = 0;
+};
+
+TEST_F(SceneManagerSimpleTest, ParallelSimulationCollectsTheSameEnergy) {
+  const int numOfRaysSquared = 40;
+  BasicSimulationProperties serialProperties(
+      {kSkipFreq}, /*sourcePower=*/100, /*numOfCollectors=*/37,
+      numOfRaysSquared, /*maxTracking=*/12, /*numOfThreads=*/1);
+  BasicSimulationProperties parallelProperties(
+      {kSkipFreq}, /*sourcePower=*/100, /*numOfCollectors=*/37,
+      numOfRaysSquared, /*maxTracking=*/12, /*numOfThreads=*/4);
+
+  CountingPositionTracker serialTracker, parallelTracker;
+  SceneManager serialManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, serialProperties),
+      &serialTracker, &collectorsTracker);
+  SceneManager parallelManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, parallelProperties),
+      &parallelTracker, &collectorsTracker);
+
+  EnergyTensor serialResults = serialManager.run();
+  EnergyTensor parallelResults = parallelManager.run();
+
+  ASSERT_EQ(numOfRaysSquared * numOfRaysSquared, serialTracker.numOfTrackings);
+  ASSERT_EQ(serialTracker.numOfTrackings, parallelTracker.numOfTrackings);
+  ASSERT_EQ(serialTracker.numOfPositions, parallelTracker.numOfPositions);
+
+  ASSERT_EQ(serialResults.frequencies(), parallelResults.frequencies());
+  ASSERT_EQ(serialResults.numOfCollectors(), parallelResults.numOfCollectors());
+  ASSERT_EQ(serialResults.numOfBins(), parallelResults.numOfBins());
+  float collectedEnergy = 0;
+  for (size_t collector = 0; collector < serialResults.numOfCollectors();
+       ++collector) {
+    for (size_t bin = 0; bin < serialResults.numOfBins(); ++bin) {
+      float energy = serialResults.at(0, collector, bin);
+      // Energies are summed in different order, so they may differ within
+      // floating point errors.
+      ASSERT_NEAR(energy, parallelResults.at(0, collector, bin),
+                  1e-5 * std::abs(energy));
+      collectedEnergy += energy;
+    }
+  }
+  ASSERT_GT(collectedEnergy, 0) << "Test is not meaningful without energy";
+}
+
+TEST_F(SceneManagerSimpleTest, MultiFrequencyTracingCollectsTheSameEnergy) {
+  // Collected energy depends on the frequency through the phase of the wave.
+  collectionRules::LinearEnergyCollectionWithPhaseImpact phaseCollectionRules;
+  const std::vector<float> frequencies = {500, 1000, 2000};
+  BasicSimulationProperties perFrequencyProperties(
+      frequencies, /*sourcePower=*/100, /*numOfCollectors=*/37,
+      /*numOfRaysSquared=*/30);
+  BasicSimulationProperties multiFrequencyProperties(
+      frequencies, /*sourcePower=*/100, /*numOfCollectors=*/37,
+      /*numOfRaysSquared=*/30, /*maxTracking=*/12, /*numOfThreads=*/1,
+      /*multiFrequencyTracing=*/true);
+
+  SceneManager perFrequencyManager(
+      model.get(),
+      SimulationProperties(&phaseCollectionRules, perFrequencyProperties),
+      &positionTracker, &collectorsTracker);
+  SceneManager multiFrequencyManager(
+      model.get(),
+      SimulationProperties(&phaseCollectionRules, multiFrequencyProperties),
+      &positionTracker, &collectorsTracker);
+
+  EnergyTensor perFrequencyResults = perFrequencyManager.run();
+  EnergyTensor multiFrequencyResults = multiFrequencyManager.run();
+
+  ASSERT_EQ(frequencies, multiFrequencyResults.frequencies());
+  ASSERT_EQ(perFrequencyResults.frequencies(),
+            multiFrequencyResults.frequencies());
+  ASSERT_EQ(perFrequencyResults.numOfCollectors(),
+            multiFrequencyResults.numOfCollectors());
+  ASSERT_EQ(perFrequencyResults.numOfBins(), multiFrequencyResults.numOfBins());
+  bool energyDependsOnFrequency = false;
+  for (size_t frequency = 0; frequency < frequencies.size(); ++frequency) {
+    for (size_t collector = 0; collector < 37; ++collector) {
+      for (size_t bin = 0; bin < perFrequencyResults.numOfBins(); ++bin) {
+        ASSERT_EQ(perFrequencyResults.at(frequency, collector, bin),
+                  multiFrequencyResults.at(frequency, collector, bin))
+            << "frequency: " << frequencies[frequency]
+            << ", collector: " << collector << ", bin: " << bin;
+        energyDependsOnFrequency |=
+            multiFrequencyResults.at(frequency, collector, bin) !=
+            multiFrequencyResults.at(0, collector, bin);
+      }
+    }
+  }
+  ASSERT_TRUE(energyDependsOnFrequency);
+}
+
+TEST_F(SceneManagerSimpleTest, ProgressiveSimulationStopsAtTolerance) {
+  const std::vector<float> frequencies = {500, 1000};
+  BasicSimulationProperties properties(frequencies, /*sourcePower=*/100,
+                                       /*numOfCollectors=*/37,
+                                       /*numOfRaysSquared=*/10);
+  SceneManager manager(
+      model.get(), SimulationProperties(&energyCollectionRules, properties),
+      &positionTracker, &collectorsTracker);
+
+  ProgressiveResults converged = manager.runProgressive(
+      ProgressiveSimulationProperties(/*tolerance=*/10, /*maxNumOfBatches=*/8,
+                                      /*minNumOfBatches=*/3));
+  ASSERT_EQ(frequencies, converged.energies.frequencies());
+  ASSERT_EQ(2, converged.convergence.size());
+  for (const FrequencyConvergence &frequency : converged.convergence) {
+    ASSERT_TRUE(frequency.converged) << frequency;
+    ASSERT_EQ(3, frequency.numOfBatches);
+    ASSERT_EQ(300, frequency.numOfRays);
+    ASSERT_LE(frequency.confidenceHalfWidth, 10);
+  }
+  ASSERT_EQ(300, converged.numOfRays().at(1000));
+
+  ProgressiveResults notConverged = manager.runProgressive(
+      ProgressiveSimulationProperties(/*tolerance=*/1e-12,
+                                      /*maxNumOfBatches=*/5));
+  for (const FrequencyConvergence &frequency : notConverged.convergence) {
+    ASSERT_FALSE(frequency.converged) << frequency;
+    ASSERT_EQ(5, frequency.numOfBatches);
+    ASSERT_GT(frequency.confidenceHalfWidth, 0)
+        << "Batches must trace different rays";
+  }
+}
+
+TEST_F(SceneManagerSimpleTest, ProgressiveSimulationAveragesBatches) {
+  BasicSimulationProperties properties({kSkipFreq}, /*sourcePower=*/100,
+                                       /*numOfCollectors=*/37,
+                                       /*numOfRaysSquared=*/20);
+  SceneManager manager(
+      model.get(), SimulationProperties(&energyCollectionRules, properties),
+      &positionTracker, &collectorsTracker);
+
+  EnergyTensor energies = manager.run();
+  ProgressiveResults progressive = manager.runProgressive(
+      ProgressiveSimulationProperties(/*tolerance=*/1e-12,
+                                      /*maxNumOfBatches=*/4));
+
+  // Every batch emits the whole source power, so the average of batches
+  // collects about the same energy as a single run.
+  float energy = 0, progressiveEnergy = 0;
+  for (size_t collector = 0; collector < energies.numOfCollectors();
+       ++collector) {
+    for (size_t bin = 0; bin < energies.numOfBins(); ++bin) {
+      energy += energies.at(0, collector, bin);
+    }
+    for (size_t bin = 0; bin < progressive.energies.numOfBins(); ++bin) {
+      progressiveEnergy += progressive.energies.at(0, collector, bin);
+    }
+  }
+  ASSERT_GT(energy, 0) << "Test is not meaningful without energy";
+  ASSERT_NEAR(energy, progressiveEnergy, 0.1 * energy);
+
+  WaveObjectFactory waveFactory(objects::kDefaultSampleRate);
+  DiffusionCoefficient diffusion(&waveFactory);
+  ASSERT_NEAR(diffusion.getResults(progressive.energies).at(kSkipFreq),
+              progressive.diffusionCoefficients().at(kSkipFreq), 1e-3);
+}
+
+TEST_F(SceneManagerSimpleTest, InvalidProgressivePropertiesThrow) {
+  ASSERT_THROW(ProgressiveSimulationProperties(0, 10), std::invalid_argument);
+  ASSERT_THROW(ProgressiveSimulationProperties(0.1, 10, 1),
+               std::invalid_argument);
+  ASSERT_THROW(ProgressiveSimulationProperties(0.1, 3, 4),
+               std::invalid_argument);
+}
+
+TEST_F(SceneManagerSimpleTest, SobolDistributionCollectsTheSameEnergy) {
+  BasicSimulationProperties gridProperties({kSkipFreq}, /*sourcePower=*/100,
+                                           /*numOfCollectors=*/37,
+                                           /*numOfRaysSquared=*/32);
+  BasicSimulationProperties sobolProperties(
+      {kSkipFreq}, /*sourcePower=*/100, /*numOfCollectors=*/37,
+      /*numOfRaysSquared=*/32, /*maxTracking=*/12, /*numOfThreads=*/1,
+      /*multiFrequencyTracing=*/false, objects::kDefaultSampleRate,
+      objects::kDefaultTimeWindow, RayDistribution::SOBOL);
+  SceneManager gridManager(
+      model.get(), SimulationProperties(&energyCollectionRules, gridProperties),
+      &positionTracker, &collectorsTracker);
+  SceneManager sobolManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, sobolProperties),
+      &positionTracker, &collectorsTracker);
+
+  EnergyTensor gridEnergies = gridManager.run();
+  EnergyTensor sobolEnergies = sobolManager.run();
+  float gridEnergy = 0, sobolEnergy = 0;
+  for (size_t collector = 0; collector < gridEnergies.numOfCollectors();
+       ++collector) {
+    for (size_t bin = 0; bin < gridEnergies.numOfBins(); ++bin) {
+      gridEnergy += gridEnergies.at(0, collector, bin);
+    }
+    for (size_t bin = 0; bin < sobolEnergies.numOfBins(); ++bin) {
+      sobolEnergy += sobolEnergies.at(0, collector, bin);
+    }
+  }
+  ASSERT_GT(gridEnergy, 0) << "Test is not meaningful without energy";
+  ASSERT_NEAR(gridEnergy, sobolEnergy, 0.05 * gridEnergy);
+
+  ProgressiveResults progressive = sobolManager.runProgressive(
+      ProgressiveSimulationProperties(/*tolerance=*/1e-12,
+                                      /*maxNumOfBatches=*/4));
+  ASSERT_EQ(4 * 32 * 32, progressive.convergence.front().numOfRays);
+  ASSERT_GT(progressive.convergence.front().confidenceHalfWidth, 0);
+}
+
+TEST_F(SceneManagerSimpleTest, JitteredGridIsReproducibleInParallel) {
+  const int numOfRaysSquared = 32;
+  auto jitteredProperties = [](int numOfThreads) {
+    return BasicSimulationProperties(
+        {kSkipFreq}, /*sourcePower=*/100, /*numOfCollectors=*/37,
+        numOfRaysSquared, /*maxTracking=*/12, numOfThreads,
+        /*multiFrequencyTracing=*/false, objects::kDefaultSampleRate,
+        objects::kDefaultTimeWindow, RayDistribution::JITTERED_GRID);
+  };
+  BasicSimulationProperties gridProperties({kSkipFreq}, /*sourcePower=*/100,
+                                           /*numOfCollectors=*/37,
+                                           numOfRaysSquared);
+  SceneManager serialManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, jitteredProperties(1)),
+      &positionTracker, &collectorsTracker);
+  SceneManager parallelManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, jitteredProperties(4)),
+      &positionTracker, &collectorsTracker);
+  SceneManager otherParallelManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, jitteredProperties(4)),
+      &positionTracker, &collectorsTracker);
+  SceneManager gridManager(
+      model.get(), SimulationProperties(&energyCollectionRules, gridProperties),
+      &positionTracker, &collectorsTracker);
+
+  EnergyTensor serialEnergies = serialManager.run();
+  EnergyTensor parallelEnergies = parallelManager.run();
+  EnergyTensor otherParallelEnergies = otherParallelManager.run();
+  EnergyTensor gridEnergies = gridManager.run();
+
+  // Runs with the same number of threads are identical bit by bit, serial
+  // run differs only by the order of summation.
+  ASSERT_EQ(serialEnergies.numOfBins(), parallelEnergies.numOfBins());
+  ASSERT_EQ(parallelEnergies.numOfBins(), otherParallelEnergies.numOfBins());
+  bool differsFromGrid = false;
+  for (size_t collector = 0; collector < serialEnergies.numOfCollectors();
+       ++collector) {
+    for (size_t bin = 0; bin < serialEnergies.numOfBins(); ++bin) {
+      float energy = serialEnergies.at(0, collector, bin);
+      ASSERT_NEAR(energy, parallelEnergies.at(0, collector, bin),
+                  1e-5 * std::abs(energy));
+      ASSERT_EQ(parallelEnergies.at(0, collector, bin),
+                otherParallelEnergies.at(0, collector, bin));
+      differsFromGrid |= bin >= gridEnergies.numOfBins() ||
+                         energy != gridEnergies.at(0, collector, bin);
+    }
+  }
+  ASSERT_TRUE(differsFromGrid);
+}
+
+TEST_F(SceneManagerSimpleTest, PlaneWaveRaysReflectOnce) {
+  BasicSimulationProperties planeWaveProperties(
+      {kSkipFreq}, /*sourcePower=*/100, /*numOfCollectors=*/37,
+      /*numOfRaysSquared=*/16, /*maxTracking=*/12, /*numOfThreads=*/1,
+      /*multiFrequencyTracing=*/false, objects::kDefaultSampleRate,
+      objects::kDefaultTimeWindow, RayDistribution::PLANE_WAVE);
+  CountingPositionTracker tracker;
+  SceneManager manager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, planeWaveProperties),
+      &tracker, &collectorsTracker);
+  EnergyTensor energies = manager.run();
+
+  // Every ray is reflected by the flat model straight up, so its tracking
+  // holds the reflection and the hit of the sphere wall.
+  ASSERT_EQ(16 * 16, tracker.numOfTrackings);
+  ASSERT_EQ(2 * tracker.numOfTrackings, tracker.numOfPositions);
+  float collectedEnergy = 0;
+  for (size_t collector = 0; collector < energies.numOfCollectors();
+       ++collector) {
+    for (size_t bin = 0; bin < energies.numOfBins(); ++bin) {
+      collectedEnergy += energies.at(0, collector, bin);
+    }
+  }
+  ASSERT_GT(collectedEnergy, 0);
+}
+
+TEST_F(SceneManagerSimpleTest, SweepMatchesRunAndDoesNotDependOnThreads) {
+  auto sweepProperties = [](int numOfThreads) {
+    return BasicSimulationProperties({kSkipFreq, 2 * kSkipFreq},
+                                     /*sourcePower=*/100,
+                                     /*numOfCollectors=*/37,
+                                     /*numOfRaysSquared=*/16,
+                                     /*maxTracking=*/12, numOfThreads);
+  };
+  SceneManager serialManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, sweepProperties(1)),
+      &positionTracker, &collectorsTracker);
+  SceneManager parallelManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, sweepProperties(4)),
+      &positionTracker, &collectorsTracker);
+
+  const std::vector<SourcePosition> sources = {
+      SourcePosition(), SourcePosition(/*incidenceAngle=*/0.5),
+      SourcePosition(/*incidenceAngle=*/0.5, /*azimuthAngle=*/2)};
+  SweepResults serialResults = serialManager.runSweep(sources);
+  SweepResults parallelResults = parallelManager.runSweep(sources);
+  ASSERT_EQ(sources.size(), serialResults.energies.size());
+  ASSERT_EQ(sources.size(), parallelResults.energies.size());
+  for (size_t source = 0; source < sources.size(); ++source) {
+    ASSERT_EQ(serialResults.diffusionCoefficients[source],
+              parallelResults.diffusionCoefficients[source]);
+  }
+
+  // Source above the model traces the same rays as run().
+  EnergyTensor runEnergies = serialManager.run();
+  const EnergyTensor &sweepEnergies = serialResults.energies.front();
+  ASSERT_EQ(runEnergies.numOfBins(), sweepEnergies.numOfBins());
+  for (size_t frequency = 0; frequency < runEnergies.numOfFrequencies();
+       ++frequency) {
+    for (size_t collector = 0; collector < runEnergies.numOfCollectors();
+         ++collector) {
+      for (size_t bin = 0; bin < runEnergies.numOfBins(); ++bin) {
+        ASSERT_EQ(runEnergies.at(frequency, collector, bin),
+                  sweepEnergies.at(frequency, collector, bin));
+      }
+    }
+  }
+
+  // Oblique source reflects energy away from the top of the model.
+  ASSERT_NE(serialResults.diffusionCoefficients[0],
+            serialResults.diffusionCoefficients[1]);
+  std::map<float, float> average = serialResults.averageDiffusionCoefficients();
+  for (float frequency : {kSkipFreq, 2 * kSkipFreq}) {
+    float sum = 0;
+    for (const std::map<float, float> &coefficients :
+         serialResults.diffusionCoefficients) {
+      sum += coefficients.at(frequency);
+    }
+    ASSERT_NEAR(sum / sources.size(), average.at(frequency), 1e-6);
+  }
+}
+
+TEST_F(SceneManagerSimpleTest, InvalidSweepThrows) {
+  SceneManager manager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules,
+                           BasicSimulationProperties({kSkipFreq},
+                                                     /*sourcePower=*/100,
+                                                     /*numOfCollectors=*/37,
+                                                     /*numOfRaysSquared=*/4)),
+      &positionTracker, &collectorsTracker);
+  ASSERT_THROW(manager.runSweep({}), std::invalid_argument);
+  ASSERT_THROW(SourcePosition(/*incidenceAngle=*/-0.1), std::invalid_argument);
+  ASSERT_THROW(SourcePosition(/*incidenceAngle=*/constants::kPi / 2),
+               std::invalid_argument);
+}
+
+TEST_F(SceneManagerSimpleTest, RunWithReferenceTracesBothModels) {
+  auto pairedProperties = [](int numOfThreads) {
+    return BasicSimulationProperties({kSkipFreq, 2 * kSkipFreq},
+                                     /*sourcePower=*/100,
+                                     /*numOfCollectors=*/37,
+                                     /*numOfRaysSquared=*/16,
+                                     /*maxTracking=*/12, numOfThreads);
+  };
+  // Model of the fixture is the reference model itself.
+  SceneManager serialManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, pairedProperties(1)),
+      &positionTracker, &collectorsTracker);
+  SceneManager parallelManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, pairedProperties(4)),
+      &positionTracker, &collectorsTracker);
+
+  PairedResults serialResults =
+      serialManager.runWithReference(ReferenceSolver::TRACED);
+  PairedResults parallelResults =
+      parallelManager.runWithReference(ReferenceSolver::TRACED);
+  EnergyTensor runEnergies = serialManager.run();
+
+  ASSERT_EQ(serialResults.diffusionCoefficients,
+            serialResults.referenceDiffusionCoefficients);
+  ASSERT_EQ(serialResults.diffusionCoefficients,
+            parallelResults.diffusionCoefficients);
+  ASSERT_EQ(serialResults.referenceDiffusionCoefficients,
+            parallelResults.referenceDiffusionCoefficients);
+  for (float frequency : {kSkipFreq, 2 * kSkipFreq}) {
+    ASSERT_FLOAT_EQ(
+        0, serialResults.normalizedDiffusionCoefficients.at(frequency));
+  }
+  ASSERT_EQ(runEnergies.numOfBins(), serialResults.energies.numOfBins());
+  for (size_t frequency = 0; frequency < runEnergies.numOfFrequencies();
+       ++frequency) {
+    for (size_t collector = 0; collector < runEnergies.numOfCollectors();
+         ++collector) {
+      for (size_t bin = 0; bin < runEnergies.numOfBins(); ++bin) {
+        ASSERT_EQ(runEnergies.at(frequency, collector, bin),
+                  serialResults.energies.at(frequency, collector, bin));
+        ASSERT_EQ(runEnergies.at(frequency, collector, bin),
+                  serialResults.referenceEnergies.at(frequency, collector,
+                                                     bin));
+      }
+    }
+  }
+}
+
+TEST_F(SceneManagerSimpleTest, AnalyticReferenceMatchesTracedReference) {
+  BasicSimulationProperties properties({kSkipFreq}, /*sourcePower=*/100,
+                                       /*numOfCollectors=*/37,
+                                       /*numOfRaysSquared=*/100);
+  SceneManager manager(model.get(),
+                       SimulationProperties(&energyCollectionRules, properties),
+                       &positionTracker, &collectorsTracker);
+  PairedResults traced = manager.runWithReference(ReferenceSolver::TRACED);
+  PairedResults analytic = manager.runWithReference(ReferenceSolver::ANALYTIC);
+  ASSERT_EQ(traced.diffusionCoefficients, analytic.diffusionCoefficients);
+  ASSERT_NEAR(traced.referenceDiffusionCoefficients.at(kSkipFreq),
+              analytic.referenceDiffusionCoefficients.at(kSkipFreq), 0.02);
+
+  BasicSimulationProperties planeWaveProperties(
+      {kSkipFreq}, /*sourcePower=*/100, /*numOfCollectors=*/37,
+      /*numOfRaysSquared=*/4, /*maxTracking=*/12, /*numOfThreads=*/1,
+      /*multiFrequencyTracing=*/false, objects::kDefaultSampleRate,
+      objects::kDefaultTimeWindow, RayDistribution::PLANE_WAVE);
+  SceneManager planeWaveManager(
+      model.get(),
+      SimulationProperties(&energyCollectionRules, planeWaveProperties),
+      &positionTracker, &collectorsTracker);
+  ASSERT_THROW(planeWaveManager.runWithReference(ReferenceSolver::ANALYTIC),
+               std::invalid_argument);
+}
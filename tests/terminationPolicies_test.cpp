@@ -0,0 +1,186 @@
+#include "core/constants.h"
+#include "main/model.h"
+#include "main/sceneManager.h"
+#include "main/terminationPolicies.h"
+#include "main/trackers.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using core::Ray;
+using core::Vec3;
+using terminationPolicies::EnergyThresholdTermination;
+using terminationPolicies::RussianRouletteTermination;
+using terminationPolicies::TerminationPolicy;
+using terminationPolicies::TerminationSavings;
+using terminationPolicies::TimeGateTermination;
+
+const float kSkipFreq = 1000;
+const int kNumOfCollectors = 37;
+
+class TerminationPoliciesTest : public ::testing::Test {
+public:
+  TerminationPoliciesTest() { model = Model::NewReferenceModel(1.0); }
+
+protected:
+  // Runs simulation of the reference model and returns energy collected by
+  // every collector in every bin.
+  std::vector<float>
+  simulate(const std::vector<const TerminationPolicy *> &policies,
+           int numOfThreads = 1, float timeWindow = 1,
+           TerminationSavings *savings = nullptr) {
+    BasicSimulationProperties properties(
+        {kSkipFreq}, /*sourcePower=*/100, kNumOfCollectors,
+        /*numOfRaysSquared=*/40, /*maxTracking=*/12, numOfThreads,
+        /*multiFrequencyTracing=*/false, objects::kDefaultSampleRate,
+        timeWindow);
+    SceneManager manager(
+        model.get(),
+        SimulationProperties(&energyCollectionRules, properties, policies),
+        &positionTracker, &collectorsTracker);
+    EnergyTensor energies = manager.run();
+    if (savings != nullptr) {
+      *savings = manager.terminationSavings();
+    }
+    std::vector<float> bins;
+    for (size_t collector = 0; collector < energies.numOfCollectors();
+         ++collector) {
+      bins.insert(bins.end(), energies.bins(0, collector),
+                  energies.bins(0, collector) + energies.numOfBins());
+    }
+    return bins;
+  }
+
+  float sum(const std::vector<float> &bins) {
+    float total = 0;
+    for (float energy : bins) {
+      total += energy;
+    }
+    return total;
+  }
+
+  std::unique_ptr<Model> model;
+  trackers::FakePositionTracker positionTracker;
+  trackers::FakeCollectorsTracker collectorsTracker;
+  collectionRules::LinearEnergyCollection energyCollectionRules;
+};
+
+TEST_F(TerminationPoliciesTest, RussianRouletteKeepsExpectedEnergy) {
+  RussianRouletteTermination roulette(/*minReflections=*/1,
+                                      /*survivalProbability=*/0.25,
+                                      /*seed=*/7);
+  Ray ray(Vec3::kZero, Vec3::kZ, /*energy=*/1);
+  ASSERT_FALSE(roulette.terminate(/*rayIndex=*/0, /*numOfReflections=*/1,
+                                  /*accumulatedTime=*/0, &ray));
+  ASSERT_EQ(1, ray.energy());
+
+  const int numOfRays = 100000;
+  int numOfSurvivors = 0;
+  double survivedEnergy = 0;
+  for (int rayIndex = 0; rayIndex < numOfRays; ++rayIndex) {
+    Ray rayCopy(Vec3::kZero, Vec3::kZ, /*energy=*/1);
+    bool terminated = roulette.terminate(rayIndex, /*numOfReflections=*/2,
+                                         /*accumulatedTime=*/0, &rayCopy);
+    Ray sameRay(Vec3::kZero, Vec3::kZ, /*energy=*/1);
+    ASSERT_EQ(terminated, roulette.terminate(rayIndex, 2, 0, &sameRay));
+    if (!terminated) {
+      ++numOfSurvivors;
+      survivedEnergy += rayCopy.energy();
+    }
+  }
+  ASSERT_NEAR(0.25, static_cast<float>(numOfSurvivors) / numOfRays, 0.01);
+  ASSERT_NEAR(numOfRays, survivedEnergy, 0.02 * numOfRays);
+}
+
+TEST_F(TerminationPoliciesTest, InvalidPoliciesThrow) {
+  ASSERT_THROW(RussianRouletteTermination(1, 0), std::invalid_argument);
+  ASSERT_THROW(RussianRouletteTermination(1, 1.5), std::invalid_argument);
+  ASSERT_THROW(RussianRouletteTermination(-1, 0.5), std::invalid_argument);
+  ASSERT_THROW(TimeGateTermination(0, 1, 1), std::invalid_argument);
+  ASSERT_THROW(TimeGateTermination(1000, 0, 1), std::invalid_argument);
+}
+
+TEST_F(TerminationPoliciesTest, TimeGateDropsOnlyRaysThatArriveTooLate) {
+  TimeGateTermination timeGate(/*sampleRate=*/1000, /*timeWindow=*/1,
+                               /*sphereWallRadius=*/constants::kSoundSpeed);
+  Ray ray(Vec3::kZero, Vec3::kZ, /*energy=*/1);
+  // Ray at the origin needs 1 s to reach the wall.
+  ASSERT_FALSE(timeGate.terminate(0, 1, /*accumulatedTime=*/0, &ray));
+  ASSERT_TRUE(timeGate.terminate(0, 1, /*accumulatedTime=*/0.01, &ray));
+  ray.setOrigin(Vec3(0, 0, constants::kSoundSpeed / 2));
+  ASSERT_FALSE(timeGate.terminate(0, 1, /*accumulatedTime=*/0.4, &ray));
+  ASSERT_TRUE(timeGate.terminate(0, 1, /*accumulatedTime=*/0.6, &ray));
+}
+
+TEST_F(TerminationPoliciesTest, TimeGateDoesNotChangeCollectedEnergy) {
+  // Rays arrive between 0.034 and 0.035 s, so only some of them arrive in
+  // the window.
+  const float timeWindow = 0.0346;
+  TimeGateTermination timeGate(objects::kDefaultSampleRate, timeWindow,
+                               getSphereWallRadius(*model));
+  TerminationSavings savings;
+  std::vector<float> gatedEnergy =
+      simulate({&timeGate}, /*numOfThreads=*/1, timeWindow, &savings);
+  std::vector<float> energy = simulate({}, /*numOfThreads=*/1, timeWindow);
+
+  ASSERT_GT(savings.numOfTerminatedRays(0), 0)
+      << "Test is not meaningful without terminated rays";
+  ASSERT_GT(sum(energy), 0) << "Test is not meaningful without energy";
+  ASSERT_EQ(energy, gatedEnergy);
+}
+
+TEST_F(TerminationPoliciesTest, EnergyThresholdDropsReflectedRays) {
+  // Every ray has the energy below threshold.
+  EnergyThresholdTermination threshold(/*minEnergy=*/100);
+  TerminationSavings savings;
+  std::vector<float> thresholdEnergy =
+      simulate({&threshold}, /*numOfThreads=*/1, /*timeWindow=*/1, &savings);
+  std::vector<float> energy = simulate({});
+
+  ASSERT_GT(savings.numOfTerminatedRays(0), 0);
+  ASSERT_EQ(0, savings.numOfTracedReflections() -
+                   savings.numOfTerminatedRays(0))
+      << "Every ray must be dropped after the first reflection";
+  ASSERT_EQ(12 * savings.numOfTerminatedRays(0),
+            savings.numOfSkippedReflections(0));
+  ASSERT_LT(sum(thresholdEnergy), sum(energy));
+}
+
+TEST_F(TerminationPoliciesTest, SavingsDoNotDependOnNumberOfThreads) {
+  RussianRouletteTermination roulette(/*minReflections=*/0,
+                                      /*survivalProbability=*/0.5);
+  TerminationSavings serialSavings, parallelSavings;
+  std::vector<float> serialEnergy =
+      simulate({&roulette}, /*numOfThreads=*/1, /*timeWindow=*/1,
+               &serialSavings);
+  std::vector<float> parallelEnergy =
+      simulate({&roulette}, /*numOfThreads=*/4, /*timeWindow=*/1,
+               &parallelSavings);
+
+  ASSERT_GT(serialSavings.numOfTerminatedRays(0), 0);
+  ASSERT_EQ(serialSavings.toJson(), parallelSavings.toJson());
+  ASSERT_EQ(serialEnergy.size(), parallelEnergy.size());
+  for (size_t bin = 0; bin < serialEnergy.size(); ++bin) {
+    // Energies are summed in different order, so they may differ within
+    // floating point errors.
+    ASSERT_NEAR(serialEnergy[bin], parallelEnergy[bin],
+                1e-5 * std::abs(serialEnergy[bin]));
+  }
+}
+
+TEST_F(TerminationPoliciesTest, SavingsAreReportedInRaport) {
+  EnergyThresholdTermination threshold(/*minEnergy=*/100);
+  TerminationSavings savings;
+  simulate({&threshold}, /*numOfThreads=*/1, /*timeWindow=*/1, &savings);
+
+  trackers::ResultTracker resultTracker;
+  resultTracker.registerTerminationSavings(savings);
+  trackers::Json raport = resultTracker.generateRaport();
+  ASSERT_EQ(1, raport.size());
+  ASSERT_EQ(trackers::kTerminationRaportName, raport[0]["name"]);
+  ASSERT_EQ("energyThreshold", raport[0]["savings"]["policies"][0]["name"]);
+  ASSERT_EQ(savings.numOfTerminatedRays(0),
+            raport[0]["savings"]["policies"][0]["terminatedRays"]);
+}
@@ -0,0 +1,42 @@
+#include "main/threadPool.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST(ThreadPoolTest, ThrowsWhenNoThreads) {
+  ASSERT_THROW(ThreadPool(0), std::invalid_argument);
+}
+
+TEST(ThreadPoolTest, RunsAllScheduledTasks) {
+  ThreadPool threadPool(4);
+  ASSERT_EQ(4, threadPool.size());
+
+  std::vector<int> results(1000, 0);
+  for (size_t index = 0; index < results.size(); ++index) {
+    threadPool.schedule([&results, index] { results[index] = index * 2; });
+  }
+  threadPool.wait();
+  for (size_t index = 0; index < results.size(); ++index) {
+    ASSERT_EQ(static_cast<int>(index * 2), results[index]);
+  }
+
+  // Pool can be reused after waiting.
+  std::atomic<int> counter = 0;
+  for (int task = 0; task < 100; ++task) {
+    threadPool.schedule([&counter] { ++counter; });
+  }
+  threadPool.wait();
+  ASSERT_EQ(100, counter);
+}
+
+TEST(ThreadPoolTest, RethrowsExceptionFromTask) {
+  ThreadPool threadPool(2);
+  threadPool.schedule([] { throw std::runtime_error("task failed"); });
+  ASSERT_THROW(threadPool.wait(), std::runtime_error);
+
+  // Exception is reported only once.
+  threadPool.schedule([] {});
+  ASSERT_NO_THROW(threadPool.wait());
+}
@@ -0,0 +1,85 @@
+#include "main/traceRecorder.h"
+#include "gtest/gtest.h"
+
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using timeline::ScopedSpan;
+using timeline::TraceRecorder;
+
+namespace {
+
+std::vector<nlohmann::json> spansNamed(const nlohmann::json &trace,
+                                       const std::string &name) {
+  std::vector<nlohmann::json> spans;
+  for (const nlohmann::json &event : trace["traceEvents"]) {
+    if (event["name"] == name) {
+      spans.push_back(event);
+    }
+  }
+  return spans;
+}
+
+} // namespace
+
+TEST(TraceRecorderTest, SpansAreRecordedOnlyWithRecorder) {
+  { ScopedSpan span("beforeRecording"); }
+  TraceRecorder recorder;
+  {
+    ScopedSpan span("outer", {{"frequency", 1000}});
+    ScopedSpan innerSpan("inner");
+  }
+
+  nlohmann::json trace = recorder.toJson();
+  ASSERT_TRUE(spansNamed(trace, "beforeRecording").empty());
+  std::vector<nlohmann::json> outer = spansNamed(trace, "outer");
+  std::vector<nlohmann::json> inner = spansNamed(trace, "inner");
+  ASSERT_EQ(1, outer.size());
+  ASSERT_EQ(1, inner.size());
+  ASSERT_EQ("X", outer.front()["ph"]);
+  ASSERT_EQ(1000, outer.front()["args"]["frequency"]);
+  ASSERT_EQ(outer.front()["tid"], inner.front()["tid"]);
+  ASSERT_LE(outer.front()["ts"], inner.front()["ts"]);
+  ASSERT_GE(outer.front()["dur"], inner.front()["dur"]);
+}
+
+TEST(TraceRecorderTest, EveryThreadHasItsOwnTimeline) {
+  TraceRecorder recorder;
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; ++thread) {
+    threads.emplace_back([thread] {
+      for (int span = 0; span < 10; ++span) {
+        ScopedSpan scopedSpan("work", {{"thread", thread}});
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  // Spans of finished threads must be kept.
+  std::vector<nlohmann::json> spans = spansNamed(recorder.toJson(), "work");
+  ASSERT_EQ(40, spans.size());
+  std::set<int> threadIds;
+  for (const nlohmann::json &span : spans) {
+    threadIds.insert(span["tid"].get<int>());
+  }
+  ASSERT_EQ(4, threadIds.size());
+}
+
+TEST(TraceRecorderTest, NewRecorderStartsEmptyTimeline) {
+  {
+    TraceRecorder recorder;
+    ScopedSpan span("firstRecording");
+  }
+  TraceRecorder recorder;
+  ASSERT_TRUE(recorder.toJson()["traceEvents"].empty());
+}
+
+TEST(TraceRecorderTest, OnlyOneRecorderAtTime) {
+  TraceRecorder recorder;
+  ASSERT_THROW(TraceRecorder(), std::logic_error);
+}
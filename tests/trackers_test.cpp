@@ -1,12 +1,16 @@
 #include "main/trackers.h"
 #include "gtest/gtest.h"
 
+#include <filesystem>
 #include <iostream>
 
 using Json = nlohmann::json;
 using trackers::File;
 using trackers::FileBuffer;
 using trackers::FileInterface;
+using trackers::BinaryPositionTracker;
+using trackers::JsonPositionTracker;
+using trackers::PositionTrackerInterface;
 
 const float kSkipValue = 1000;
 class FakeFile : public FileInterface {
@@ -32,3 +36,73 @@ TEST(TrackersTest, AcquiringJsonFileToBuffer) {
   FakeFile file;
   file.write(buffer);
 }
+
+namespace {
+
+void trackSampleSimulation(PositionTrackerInterface *tracker) {
+  for (float frequency : {500.0f, 1000.0f}) {
+    tracker->initializeNewFrequency(frequency);
+    for (int tracking = 0; tracking < 3; ++tracking) {
+      tracker->initializeNewTracking();
+      // Single hit tracking is skipped by both trackers.
+      for (int hit = 0; hit <= tracking; ++hit) {
+        core::RayHitData hitData(
+            /*time=*/1 + hit, core::Vec3(0, 0, 1),
+            core::Ray(core::Vec3(hit, tracking, 0.5f), core::Vec3(1, 1, 0),
+                      /*energy=*/1.0f / (hit + 1)),
+            frequency);
+        tracker->addNewPositionToCurrentTracking(hitData);
+      }
+      tracker->endCurrentTracking();
+    }
+    tracker->endCurrentFrequency();
+  }
+  tracker->switchToReferenceModel();
+  tracker->save();
+}
+
+std::string readFile(const std::filesystem::path &path) {
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+} // namespace
+
+TEST(TrackersTest, ConvertedBinaryTrackingMatchesJsonTracking) {
+  std::filesystem::path root =
+      std::filesystem::temp_directory_path() / "binaryTrackingTest";
+  std::filesystem::path jsonFolder = root / "json";
+  std::filesystem::path binaryFolder = root / "binary";
+  std::filesystem::create_directories(jsonFolder);
+  std::filesystem::create_directories(binaryFolder);
+
+  {
+    JsonPositionTracker jsonTracker(jsonFolder.string());
+    trackSampleSimulation(&jsonTracker);
+  }
+  {
+    BinaryPositionTracker binaryTracker(binaryFolder.string());
+    trackSampleSimulation(&binaryTracker);
+  }
+  trackers::convertBinaryTrackingToJs(
+      (binaryFolder / "trackingData.bin").string(), binaryFolder.string());
+
+  std::string expected = readFile(jsonFolder / "trackingData.js");
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(expected, readFile(binaryFolder / "trackingData.js"));
+  std::filesystem::remove_all(root);
+}
+
+TEST(TrackersTest, ConvertingInvalidBinaryTrackingThrows) {
+  std::filesystem::path root =
+      std::filesystem::temp_directory_path() / "invalidTrackingTest";
+  std::filesystem::create_directories(root);
+  std::filesystem::path file = root / "trackingData.bin";
+  std::ofstream(file) << "not a tracking file";
+  ASSERT_THROW(
+      trackers::convertBinaryTrackingToJs(file.string(), root.string()),
+      std::invalid_argument);
+  std::filesystem::remove_all(root);
+}
@@ -0,0 +1,189 @@
+#include "core/constants.h"
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "main/model.h"
+#include "main/rayTracer.h"
+#include "obj/objects.h"
+#include "obj/triangleMesh.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+using core::Ray;
+using core::RayHitData;
+using core::Vec3;
+using objects::TriangleMesh;
+using objects::TriangleObj;
+
+const float kSkipFrequency = 1000;
+// Hits are computed in different way than in TriangleObj::hitObject(), so
+// they are expected to be equal only within floating point errors.
+const float kTimeTolerance = 1e-4;
+
+class TriangleMeshTest : public ::testing::Test {
+protected:
+  std::vector<TriangleObj> createRandomTriangles(int numOfTriangles) {
+    std::vector<TriangleObj> triangles;
+    std::uniform_real_distribution<float> position(-2, 2);
+    std::uniform_real_distribution<float> offset(-0.5, 0.5);
+    while (static_cast<int>(triangles.size()) < numOfTriangles) {
+      Vec3 center(position(generator_), position(generator_),
+                  position(generator_));
+      try {
+        triangles.push_back(TriangleObj(center + randomVec(offset),
+                                        center + randomVec(offset),
+                                        center + randomVec(offset)));
+      } catch (const std::invalid_argument &e) {
+        // skip degenerated triangle
+      }
+    }
+    return triangles;
+  }
+
+  Ray createRandomRay() {
+    std::uniform_real_distribution<float> position(-4, 4);
+    std::uniform_real_distribution<float> target(-2, 2);
+    Vec3 origin = randomVec(position);
+    return Ray(origin, randomVec(target) - origin, /*energy=*/1);
+  }
+
+  // Returns distance from |point| to the closest edge of the |triangle|.
+  float distanceToEdge(const TriangleObj &triangle, const Vec3 &point) {
+    std::vector<Vec3> points = triangle.getPoints();
+    float distance = std::numeric_limits<float>::max();
+    for (int index = 0; index < 3; ++index) {
+      Vec3 start = points[index];
+      Vec3 edge = points[(index + 1) % 3] - start;
+      float along = std::clamp(
+          (point - start).scalarProduct(edge) / edge.magnitudeSquared(), 0.0f,
+          1.0f);
+      distance = std::min(distance, (start + along * edge - point).magnitude());
+    }
+    return distance;
+  }
+
+private:
+  Vec3 randomVec(std::uniform_real_distribution<float> &distribution) {
+    return Vec3(distribution(generator_), distribution(generator_),
+                distribution(generator_));
+  }
+
+  std::mt19937 generator_{/*seed=*/17497};
+};
+
+TEST_F(TriangleMeshTest, CompiledTrianglesKeepGeometry) {
+  std::vector<TriangleObj> triangles = createRandomTriangles(100);
+  TriangleMesh mesh(triangles);
+  ASSERT_EQ(triangles.size(), mesh.size());
+  for (size_t index = 0; index < triangles.size(); ++index) {
+    ASSERT_EQ(triangles[index].point1(), mesh.point1(index));
+    ASSERT_EQ(triangles[index].point2(), mesh.point2(index));
+    ASSERT_EQ(triangles[index].point3(), mesh.point3(index));
+    ASSERT_EQ(triangles[index].normal(), mesh.normal(index));
+  }
+}
+
+TEST_F(TriangleMeshTest, SameHitsAsTriangleObj) {
+  std::vector<TriangleObj> triangles = createRandomTriangles(200);
+  TriangleMesh mesh(triangles);
+
+  int numOfHits = 0;
+  for (int rayIndex = 0; rayIndex < 500; ++rayIndex) {
+    Ray ray = createRandomRay();
+    const float origin[3] = {ray.origin().x(), ray.origin().y(),
+                             ray.origin().z()};
+    const float direction[3] = {ray.direction().x(), ray.direction().y(),
+                                ray.direction().z()};
+
+    for (size_t index = 0; index < triangles.size(); ++index) {
+      RayHitData hitData;
+      bool objectHit =
+          triangles[index].hitObject(ray, kSkipFrequency, &hitData);
+      float time;
+      bool meshHit = mesh.intersect(index, origin, direction, &time);
+
+      if (objectHit != meshHit) {
+        // Area based test in TriangleObj accepts points slightly outside of
+        // the triangle, so results may differ only next to the edges.
+        Vec3 hitPoint = objectHit ? hitData.collisionPoint() : ray.at(time);
+        ASSERT_LT(distanceToEdge(triangles[index], hitPoint), 1e-3)
+            << ray << "\n"
+            << triangles[index];
+        continue;
+      }
+      if (meshHit) {
+        ++numOfHits;
+        ASSERT_NEAR(hitData.time, time, kTimeTolerance) << ray;
+        ASSERT_EQ(hitData.normal(), mesh.normal(index));
+      }
+    }
+  }
+  ASSERT_GT(numOfHits, 0) << "Test is not meaningful without hits";
+}
+
+TEST_F(TriangleMeshTest, ParallelAndBackwardRaysMiss) {
+  TriangleMesh mesh({TriangleObj(Vec3::kZero, Vec3::kX, Vec3::kY)});
+  float time;
+
+  const float above[3] = {0.2, 0.2, 1};
+  const float down[3] = {0, 0, -1};
+  ASSERT_TRUE(mesh.intersect(0, above, down, &time));
+  ASSERT_FLOAT_EQ(1, time);
+
+  const float up[3] = {0, 0, 1};
+  ASSERT_FALSE(mesh.intersect(0, above, up, &time));
+
+  const float alongX[3] = {1, 0, 0};
+  const float onSurface[3] = {-1, 0.2, 0};
+  ASSERT_FALSE(mesh.intersect(0, onSurface, alongX, &time));
+
+  // Ray that starts at the surface must not hit it again.
+  const float atSurface[3] = {0.2, 0.2, 0};
+  ASSERT_FALSE(mesh.intersect(0, atSurface, down, &time));
+}
+
+TEST_F(TriangleMeshTest, RayTracerMatchesTriangleObjHits) {
+  Model model(createRandomTriangles(500));
+  RayTracer rayTracer(&model);
+
+  // Closest hits may differ only when ray passes next to the edge of the
+  // triangle, which is rare for random rays.
+  int numOfHits = 0, numOfMismatches = 0;
+  for (int rayIndex = 0; rayIndex < 1000; ++rayIndex) {
+    Ray ray = createRandomRay();
+    RayHitData closestObjectHit;
+    bool objectHit = false;
+    for (TriangleObj triangle : model.triangles()) {
+      RayHitData hitData;
+      if (triangle.hitObject(ray, kSkipFrequency, &hitData) &&
+          hitData.time < closestObjectHit.time) {
+        closestObjectHit = hitData;
+        objectHit = true;
+      }
+    }
+
+    RayHitData tracerHit;
+    bool tracerHitTriangle =
+        rayTracer.rayTrace(ray, kSkipFrequency, &tracerHit) ==
+        RayTracer::TraceResult::HIT_TRIANGLE;
+    if (objectHit != tracerHitTriangle) {
+      ++numOfMismatches;
+      continue;
+    }
+    if (!objectHit) {
+      continue;
+    }
+    ++numOfHits;
+    if (std::abs(closestObjectHit.time - tracerHit.time) > kTimeTolerance) {
+      ++numOfMismatches;
+      continue;
+    }
+    ASSERT_EQ(closestObjectHit.collisionPoint(), tracerHit.collisionPoint());
+    ASSERT_EQ(closestObjectHit.normal(), tracerHit.normal());
+    ASSERT_NEAR(closestObjectHit.time / constants::kSoundSpeed,
+                tracerHit.accumulatedTime, kTimeTolerance);
+  }
+  ASSERT_GT(numOfHits, 0) << "Test is not meaningful without hits";
+  ASSERT_LE(numOfMismatches, numOfHits / 100);
+}
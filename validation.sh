@@ -4,6 +4,8 @@ echo "Validation Start at:" $(date) >> ./validationRaport.log
 bazel build --config=_gcc validation
 source ./venv/bin/activate
 
+mkdir -p ./validationCache
+
 shopt -s nullglob
 DIFFUSORS_ARRAY_PATH=( "validationDiffusors/*" )
 
@@ -16,7 +18,7 @@ do
    rm $RAPORT_FILE
    touch $RAPORT_FILE
 
-   bazel-bin/validation $RAPORT_FILE ./$DIFFUSOR_PATH
+   bazel-bin/validation $RAPORT_FILE ./$DIFFUSOR_PATH ./validationCache
    python3 ./validationTools/compareResutlsToReference.py $REFERENCE_FILE $RAPORT_FILE
 done
 
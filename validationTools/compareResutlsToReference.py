@@ -23,6 +23,9 @@ def ElementsAreArray(array1, array2):
 def prepareParamterMap(parameterMap):
     outputMap = {}
     for parameterIndex in range(len(parameterMap)):
+        # Simulation statistics are not acoustic parameters.
+        if "values" not in parameterMap[parameterIndex]:
+            continue
         parameterName = parameterMap[parameterIndex]["name"]
         outputMap[parameterName] = {
             "values": parameterMap[parameterIndex]["values"],